@@ -0,0 +1,71 @@
+/// Copyright (c) Vito Domenico Tagliente
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "font.h"
+#include "image.h"
+#include "texture.h"
+
+namespace graphics
+{
+	// Decodes images and rasterizes fonts on a pool of workers. The textures of
+	// the decoded assets are created by update, on the context thread, a few per call
+	// so that a frame is never held up by a level worth of uploads
+	class AssetLoader
+	{
+	public:
+		// 0 threads use one less than the cores, leaving one to the context thread
+		AssetLoader(size_t numOfThreads = 0);
+		~AssetLoader();
+
+		AssetLoader(const AssetLoader&) = delete;
+		AssetLoader& operator= (const AssetLoader&) = delete;
+
+		// the requests can be made by any thread
+		std::shared_future<Image> loadImage(const std::filesystem::path& filename, bool flipVertically = Image::flip_vertically);
+		// nullptr if the image can't be decoded. Texture files are mapped as they are, not flipped
+		std::shared_future<TexturePtr> loadTexture(const std::filesystem::path& filename, const Texture::Options& options = Texture::Options{},
+			bool flipVertically = Image::flip_vertically);
+		// an invalid font if it can't be rasterized
+		std::shared_future<Font> loadFont(const std::filesystem::path& filename);
+
+		// create the textures of at most maxUploads decoded assets, on the context thread.
+		// Returns the num of uploads done
+		size_t update(size_t maxUploads = default_uploads_per_update);
+		// wait for the workers and upload everything, on the context thread
+		void finish();
+
+		// requests not completed yet, decoding or waiting for their upload
+		inline size_t getNumOfPendingLoads() const { return m_numOfPendingLoads; }
+		inline bool isIdle() const { return m_numOfPendingLoads == 0; }
+		inline size_t getNumOfThreads() const { return m_threads.size(); }
+
+		static constexpr size_t default_uploads_per_update = 8;
+
+	private:
+		void work();
+		// queue a decode for the workers, or an upload for update
+		void schedule(std::function<void()>&& task);
+		void scheduleUpload(std::function<void()>&& upload);
+
+		std::vector<std::thread> m_threads;
+		std::deque<std::function<void()>> m_tasks;
+		std::mutex m_tasksMutex;
+		std::condition_variable m_tasksCondition;
+		bool m_stopping;
+		// run on the context thread
+		std::deque<std::function<void()>> m_uploads;
+		std::mutex m_uploadsMutex;
+		std::condition_variable m_uploadsCondition;
+		std::atomic<size_t> m_numOfPendingLoads;
+	};
+}
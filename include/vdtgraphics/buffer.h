@@ -7,7 +7,9 @@ namespace graphics
 	{
 		Static,
 		Dynamic,
-		Stream
+		Stream,
+		// streamed through a ring allocator, persistently mapped when supported
+		Ring
 	};
 
 	class Buffer
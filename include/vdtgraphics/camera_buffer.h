@@ -0,0 +1,70 @@
+/// Copyright (c) Vito Domenico Tagliente
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <vdtmath/matrix4.h>
+
+#include "uniform_buffer.h"
+
+namespace graphics
+{
+	// The cameras of the frame, stored in a uniform buffer shared by the
+	// built-in shaders through the std140 block of block_source.
+	// Every camera is uploaded once, batches refer to it by index
+	class CameraBuffer
+	{
+	public:
+		// as laid out by std140
+		struct Block
+		{
+			math::mat4 view;
+			math::mat4 projection;
+			math::mat4 viewProjection;
+			float viewport[2];
+			float time;
+			float padding;
+		};
+
+		static constexpr unsigned int binding_point = 0;
+		static constexpr const char* const block_name = "Camera";
+		// the GLSL declaration of the block, added to the vertex shaders of the library
+		static constexpr const char* const block_source =
+			"layout(std140) uniform Camera\n"
+			"{\n"
+			"	mat4 u_view;\n"
+			"	mat4 u_projection;\n"
+			"	mat4 u_viewProjection;\n"
+			"	vec2 u_viewport;\n"
+			"	float u_time;\n"
+			"};\n";
+		static constexpr uint32_t invalid_index = ~0u;
+
+		CameraBuffer(size_t capacity = 16);
+
+		inline size_t size() const { return m_numOfCameras; }
+		inline size_t capacity() const { return m_capacity; }
+
+		// the index of the camera, valid until clear
+		uint32_t push(const Block& block);
+		// upload the cameras pushed since the last upload
+		void upload();
+		// bind the camera to the block binding point
+		void bind(uint32_t index);
+		// the frame is over, the next cameras start from 0
+		void clear();
+
+	private:
+		size_t m_capacity;
+		// size of a camera in the buffer, aligned for the range binding
+		size_t m_stride;
+		std::unique_ptr<UniformBuffer> m_buffer;
+		std::vector<unsigned char> m_data;
+		size_t m_numOfCameras;
+		size_t m_numOfUploadedCameras;
+		// the storage was recreated or cleared, orphan it before writing
+		bool m_orphan;
+	};
+}
@@ -0,0 +1,109 @@
+/// Copyright (c) Vito Domenico Tagliente
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "common.h"
+#include "draw_submitter.h"
+#include "render_queue.h"
+
+namespace graphics
+{
+	class Font;
+	class Texture;
+
+	// Record draws without touching the graphics context,
+	// so that every thread can fill its own list.
+	// Lists are merged by the Renderer at flush, by order
+	// and then by creation when the order is the same, never
+	// by submission. Create the lists of the workers up front.
+	class CommandList final : public DrawSubmitter
+	{
+	public:
+		// pipelines ids, used to build the sort keys
+		enum class Pipeline : uint8_t
+		{
+			ShapeFill,
+			ShapeStroke,
+			Text,
+			Texture,
+			ShapeInstance,
+			ShapeStrip
+		};
+
+		struct Shape
+		{
+			ShapeRenderStyle style;
+			// range of the vertices
+			size_t offset;
+			size_t count;
+		};
+
+		struct ShapeStrip
+		{
+			// range of the vertices
+			size_t offset;
+			size_t count;
+			// range of the indices, relative to the first vertex
+			size_t indexOffset;
+			size_t indexCount;
+		};
+
+		struct TextInstance
+		{
+			SpriteVertex vertex;
+			Font* font;
+		};
+
+		struct SpriteInstance
+		{
+			SpriteVertex vertex;
+			Texture* texture;
+		};
+
+		CommandList(int order = 0);
+
+		inline int getOrder() const { return m_order; }
+		inline void setOrder(const int order) { m_order = order; }
+		// increasing with the creation of the lists, breaks the ties of the order
+		inline uint64_t getCreationIndex() const { return m_creationIndex; }
+
+		inline bool empty() const { return m_queue.empty(); }
+		inline size_t size() const { return m_queue.size(); }
+
+		// the recorded draws, in submission order
+		inline const RenderQueue& getQueue() const { return m_queue; }
+		inline const std::vector<Shape>& getShapes() const { return m_shapes; }
+		inline const std::vector<Vertex>& getVertices() const { return m_vertices; }
+		inline const std::vector<ShapeInstance>& getShapeInstances() const { return m_shapeInstances; }
+		inline const std::vector<ShapeStrip>& getShapeStrips() const { return m_shapeStrips; }
+		inline const std::vector<uint32_t>& getIndices() const { return m_indices; }
+		inline const std::vector<TextInstance>& getTexts() const { return m_texts; }
+		inline const std::vector<SpriteInstance>& getSprites() const { return m_sprites; }
+
+		void clear();
+
+	protected:
+		virtual void pushShape(ShapeRenderStyle style, const Vertex* const vertices, size_t numOfVertices) override;
+		virtual void pushShapeInstance(const ShapeInstance& shape) override;
+		virtual void pushShapeStrip(const Vertex* const vertices, size_t numOfVertices, const uint32_t* const indices, size_t numOfIndices) override;
+		virtual void pushGlyph(const SpriteVertex& vertex, Font* const font) override;
+		virtual void pushSprite(const SpriteVertex& vertex, Texture* const texture) override;
+
+	private:
+		// the renderer records its own draws in a list when sorting
+		friend class Renderer;
+
+		int m_order;
+		uint64_t m_creationIndex;
+		RenderQueue m_queue;
+		std::vector<Shape> m_shapes;
+		std::vector<Vertex> m_vertices;
+		std::vector<ShapeInstance> m_shapeInstances;
+		std::vector<ShapeStrip> m_shapeStrips;
+		std::vector<uint32_t> m_indices;
+		std::vector<TextInstance> m_texts;
+		std::vector<SpriteInstance> m_sprites;
+	};
+}
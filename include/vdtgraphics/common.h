@@ -53,4 +53,62 @@ namespace graphics
 		fill,
 		stroke
 	};
+
+	// the depth and blend state a batch is drawn with
+	enum class RenderPass
+	{
+		// blending and depth writes, in submission order
+		Default,
+		// no blending, drawn front to back so that hidden pixels are rejected early
+		Opaque,
+		// blending without depth writes, drawn back to front after the opaque draws
+		Translucent
+	};
+
+	// how the segments of a polyline are connected
+	enum class LineJoin
+	{
+		Miter,
+		Bevel,
+		Round
+	};
+
+	// how the ends of an open polyline are drawn
+	enum class LineCap
+	{
+		Butt,
+		Square,
+		Round
+	};
+
+	enum class ShapeType
+	{
+		Circle,
+		Ellipse,
+		Rect,
+		RoundedRect
+	};
+
+	// a shape drawn by its distance function, anti-aliased at any zoom level
+	struct ShapeInstance
+	{
+		ShapeType type;
+		// center of the shape
+		math::vec3 position;
+		// width and height
+		math::vec2 extent;
+		// around the center, in radians
+		float rotation;
+		// corner radius of the rounded rects
+		float radius;
+		// the stroke is drawn inside the edge, nothing if 0
+		float strokeWidth;
+		// if the stroke width is in pixels instead of world units
+		bool strokeInPixels;
+		Color fillColor;
+		Color strokeColor;
+
+		// position, extent, rotation, radius, stroke width, colors as RGBA8 and type
+		static constexpr size_t size = 3 + 2 + 1 + 1 + 1 + 1 + 1 + 1;
+	};
 }
\ No newline at end of file
@@ -0,0 +1,64 @@
+/// Copyright (c) Vito Domenico Tagliente
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+namespace graphics
+{
+	// Pixels compressed in blocks of 4x4 that the GPU samples as they are,
+	// with the whole mip chain in a single buffer
+	struct CompressedImage final
+	{
+		enum class Format
+		{
+			// RGB, 8 bytes per block
+			BC1,
+			// RGBA with interpolated alpha, 16 bytes per block
+			BC3,
+			// RGBA, 16 bytes per block
+			BC7,
+			// RGB, 8 bytes per block
+			ETC2_RGB,
+			// RGBA with EAC alpha, 16 bytes per block
+			ETC2_RGBA
+		};
+
+		struct Level
+		{
+			int width;
+			int height;
+			// bytes of the level in data
+			size_t offset;
+			size_t size;
+		};
+
+		CompressedImage();
+		CompressedImage(Format format, int width, int height, const std::vector<Level>& levels, const std::shared_ptr<unsigned char>& data);
+
+		// KTX files, can be called by any thread. Invalid if the file can't be read
+		static CompressedImage load(const std::filesystem::path& filename);
+		bool save(const std::filesystem::path& filename) const;
+
+		inline bool isValid() const { return data != nullptr && !levels.empty(); }
+		inline const unsigned char* getLevelData(const size_t level) const { return data.get() + levels[level].offset; }
+
+		static size_t getBlockSize(Format format);
+		// bytes of a level, the blocks cover the borders
+		static size_t getLevelSize(Format format, int width, int height);
+		static bool hasAlpha(Format format);
+		// GL internal format
+		static unsigned int getGLFormat(Format format);
+		// true if the context samples the format, on the context thread
+		static bool isSupported(Format format);
+
+		Format format;
+		int width;
+		int height;
+		// from the largest
+		std::vector<Level> levels;
+		std::shared_ptr<unsigned char> data;
+	};
+}
@@ -1,6 +1,8 @@
 /// Copyright (c) Vito Domenico Tagliente
 #pragma once
 
+#include "gl_state_cache.h"
+
 namespace graphics
 {
 	class Context
@@ -13,10 +15,22 @@ namespace graphics
 			Initialized
 		};
 
+		Context() = default;
+		~Context();
+
 		State initialize();
 		State getState() const { return m_state; }
 
+		// the state bound by the library, see GLStateCache::get
+		GLStateCache& getStateCache() { return m_stateCache; }
+		const GLStateCache& getStateCache() const { return m_stateCache; }
+
+		// if the driver exposes the extension, e.g. GL_ARB_texture_compression_bptc.
+		// The extensions are enumerated by the first call, with a context current
+		static bool hasExtension(const char* name);
+
 	private:
 		State m_state{ State::Default };
+		GLStateCache m_stateCache;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,85 @@
+/// Copyright (c) Vito Domenico Tagliente
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <vdtmath/matrix4.h>
+#include <vdtmath/vector2.h>
+#include <vdtmath/vector3.h>
+
+#include "color.h"
+#include "common.h"
+#include "polygon_triangulator.h"
+#include "polyline_tessellator.h"
+#include "texture_rect.h"
+
+namespace graphics
+{
+	class Font;
+	class Texture;
+
+	// The draw API shared by the Renderer and the CommandList.
+	// Shapes, text and sprites are turned into vertices and instances
+	// and handed over to the implementation.
+	class DrawSubmitter
+	{
+	public:
+		DrawSubmitter() = default;
+		virtual ~DrawSubmitter() = default;
+
+		// the layer of the next draws, lower layers are rendered first when sorting
+		void setLayer(int layer) { m_layer = layer; }
+		int getLayer() const { return m_layer; }
+
+		PolygonTriangulator& getPolygonTriangulator() { return m_polygonTriangulator; }
+		const PolygonTriangulator& getPolygonTriangulator() const { return m_polygonTriangulator; }
+
+		// strokes are 1 pixel wide
+		void submitDrawCircle(ShapeRenderStyle style, const math::vec3& position, float radius, const Color& color);
+		void submitDrawCircle(const math::vec3& position, float radius, const Color& fillColor, float strokeWidth = 0.f, const Color& strokeColor = Color::Transparent);
+		void submitDrawEllipse(const math::vec3& position, const math::vec2& radii, const Color& fillColor, float strokeWidth = 0.f, const Color& strokeColor = Color::Transparent);
+		void submitDrawLine(const math::vec3& point1, const Color& color1, const math::vec3& point2, const Color& color2);
+		// connected segments of any width, in world units
+		void submitDrawPolyline(const std::vector<math::vec3>& points, float width, const Color& color, LineJoin join = LineJoin::Miter, LineCap cap = LineCap::Butt, bool closed = false);
+		void submitDrawPolyline(const math::vec3* const points, size_t numOfPoints, float width, const Color& color, LineJoin join = LineJoin::Miter, LineCap cap = LineCap::Butt, bool closed = false);
+		// simple polygons, concave or with holes, filled with a color.
+		// The triangles of recent outlines are cached
+		void submitDrawPolygon(const std::vector<math::vec3>& outline, const Color& color);
+		void submitDrawPolygon(const math::vec3* const points, size_t numOfPoints, const Color& color);
+		void submitDrawPolygon(const std::vector<math::vec3>& outline, const std::vector<std::vector<math::vec3>>& holes, const Color& color);
+		void submitDrawShape(ShapeRenderStyle style, const std::vector<Vertex>& vertices);
+		void submitDrawShape(ShapeRenderStyle style, const Vertex* const vertices, size_t numOfVertices);
+		// strokes are 1 pixel wide
+		void submitDrawRect(ShapeRenderStyle style, const math::vec3& position, float width, float height, const Color& color);
+		void submitDrawRoundedRect(const math::vec3& position, const math::vec2& size, float radius, const Color& fillColor, float strokeWidth = 0.f, const Color& strokeColor = Color::Transparent);
+		void submitDrawShape(const ShapeInstance& shape);
+		void submitDrawText(Font* const font, const std::string& text, const math::vec3& position, float scale = 1.0f, const Color& color = Color::White);
+		void submitDrawTexture(Texture* const texture, const math::mat4& matrix, const TextureRect& rect = {}, const Color& color = Color::White);
+		void submitDrawTexture(Texture* const texture, const math::vec3& position, const TextureRect& rect = {}, const Color& color = Color::White);
+		void submitDrawTexture(Texture* const texture, const math::vec3& position, float rotation, const TextureRect& rect = {}, const Color& color = Color::White);
+		void submitDrawTexture(Texture* const texture, const math::vec3& position, const math::vec3& scale, const TextureRect& rect = {}, const Color& color = Color::White);
+		void submitDrawTexture(Texture* const texture, const math::vec3& position, float rotation, const math::vec3& scale, const TextureRect& rect = {}, const Color& color = Color::White);
+
+	protected:
+		virtual void pushShape(ShapeRenderStyle style, const Vertex* const vertices, size_t numOfVertices) = 0;
+		virtual void pushShapeInstance(const ShapeInstance& shape) = 0;
+		// an indexed triangle strip, the indices refer to the given vertices
+		virtual void pushShapeStrip(const Vertex* const vertices, size_t numOfVertices, const uint32_t* const indices, size_t numOfIndices) = 0;
+		virtual void pushGlyph(const SpriteVertex& vertex, Font* const font) = 0;
+		virtual void pushSprite(const SpriteVertex& vertex, Texture* const texture) = 0;
+
+		int m_layer{ 0 };
+
+	private:
+		void fillPolygon(const math::vec3* const points, const size_t* const ringEnds, size_t numOfRings, const Color& color);
+
+		PolygonTriangulator m_polygonTriangulator;
+		PolylineTessellator m_polylineTessellator;
+		// scratch data of the polygons
+		std::vector<math::vec3> m_polygonPoints;
+		std::vector<size_t> m_polygonRingEnds;
+		std::vector<Vertex> m_polygonVertices;
+	};
+}
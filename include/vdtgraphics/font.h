@@ -7,6 +7,7 @@
 
 #include <vdtmath/vector2.h>
 
+#include "image.h"
 #include "texture.h"
 #include "texture_rect.h"
 
@@ -37,6 +38,10 @@ namespace graphics
 		~Font();
 
 		static Font load(const std::filesystem::path& filename);
+		// render the glyphs in an atlas of one channel, without GL. Can be called by any thread
+		static bool rasterize(const std::filesystem::path& filename, Image& atlas, std::map<char, Glyph>& data);
+		// create the texture of a rasterized atlas, on the context thread
+		static Font create(const Image& atlas, const std::map<char, Glyph>& data, const std::filesystem::path& path);
 
 		inline bool isValid() const { return !data.empty(); }
 
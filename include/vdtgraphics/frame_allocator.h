@@ -0,0 +1,82 @@
+/// Copyright (c) Vito Domenico Tagliente
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace graphics
+{
+	// Linear allocator for the data living one frame.
+	// Allocations are a pointer bump, nothing is released until reset,
+	// when the objects are destroyed and the memory is recycled.
+	// If a frame overflows the capacity, the blocks are merged on reset
+	// so that the next frames run without any heap allocation.
+	class FrameAllocator
+	{
+	public:
+		FrameAllocator(size_t capacity = default_capacity);
+		~FrameAllocator();
+
+		FrameAllocator(const FrameAllocator&) = delete;
+		FrameAllocator& operator= (const FrameAllocator&) = delete;
+
+		void* allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+		template <typename T>
+		T* allocate(const size_t count)
+		{
+			return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+		}
+
+		// construct an object, destroyed on reset
+		template <typename T, typename... Args>
+		T* create(Args&&... args)
+		{
+			T* const object = new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+			if constexpr (!std::is_trivially_destructible_v<T>)
+			{
+				Destructor* const destructor = new (allocate(sizeof(Destructor), alignof(Destructor))) Destructor{
+					[](void* const pointer) { static_cast<T*>(pointer)->~T(); },
+					object,
+					m_destructors
+				};
+				m_destructors = destructor;
+			}
+			return object;
+		}
+
+		void reset();
+
+		// the bytes available without allocating a new block
+		size_t capacity() const;
+		// the bytes allocated since the last reset
+		size_t size() const { return m_size; }
+
+	private:
+		struct Block
+		{
+			std::unique_ptr<unsigned char[]> data;
+			size_t capacity;
+			size_t offset;
+		};
+
+		struct Destructor
+		{
+			void (*function)(void* const);
+			void* object;
+			Destructor* next;
+		};
+
+		void addBlock(size_t capacity);
+
+		std::vector<Block> m_blocks;
+		Destructor* m_destructors;
+		size_t m_size;
+
+		static constexpr size_t default_capacity = 4 * 1024 * 1024;
+	};
+}
@@ -0,0 +1,102 @@
+/// Copyright (c) Vito Domenico Tagliente
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+namespace graphics
+{
+	// Shadows the state of the context bound by the library, so that
+	// binds and switches matching the current state are not sent to the driver.
+	// Objects must be reported when deleted, since GL unbinds them and their
+	// ids can be given to new objects. State changed outside of the library
+	// must be followed by invalidate
+	class GLStateCache
+	{
+	public:
+		struct Stats
+		{
+			// state changes sent to the driver
+			size_t issued{ 0 };
+			// state changes already in place, not sent
+			size_t skipped{ 0 };
+		};
+
+		static constexpr size_t max_texture_units = 32;
+		static constexpr size_t max_uniform_buffer_bindings = 16;
+
+		GLStateCache();
+
+		// the cache of the initialized context
+		static GLStateCache& get();
+
+		void useProgram(unsigned int id);
+		void bindVertexArray(unsigned int id);
+		void bindBuffer(unsigned int target, unsigned int id);
+		// bind a range of a uniform buffer to an indexed binding point
+		void bindUniformBufferRange(unsigned int index, unsigned int id, size_t offset, size_t size);
+		void setActiveTextureUnit(unsigned int unit);
+		// bind to the active unit
+		void bindTexture(unsigned int target, unsigned int id);
+		void bindTexture(unsigned int unit, unsigned int target, unsigned int id);
+		void bindFramebuffer(unsigned int id);
+		void setViewport(int x, int y, int width, int height);
+		void setBlendEnabled(bool enabled);
+		void setBlendFunction(unsigned int source, unsigned int destination);
+		void setDepthTestEnabled(bool enabled);
+		void setDepthMask(bool enabled);
+
+		void onProgramDeleted(unsigned int id);
+		void onVertexArrayDeleted(unsigned int id);
+		void onBufferDeleted(unsigned int id);
+		void onTextureDeleted(unsigned int id);
+		void onFramebufferDeleted(unsigned int id);
+
+		// forget the shadowed state, everything is sent again
+		void invalidate();
+
+		inline const Stats& getStats() const { return m_stats; }
+		inline void resetStats() { m_stats = Stats(); }
+
+	private:
+		friend class Context;
+
+		static void makeCurrent(GLStateCache* const cache);
+
+		// the slot of the tracked targets, or the num of slots
+		static size_t getBufferSlot(unsigned int target);
+		static size_t getTextureSlot(unsigned int target);
+
+		// true if the value changed and the call must be issued
+		template <typename T>
+		bool update(T& current, const T& value);
+
+		static constexpr size_t num_buffer_slots = 4;
+		static constexpr size_t num_texture_slots = 2;
+
+		// range bound to an indexed binding point
+		struct BufferRange
+		{
+			unsigned int id;
+			size_t offset;
+			size_t size;
+
+			bool operator== (const BufferRange& other) const { return id == other.id && offset == other.offset && size == other.size; }
+		};
+
+		// unknown ids and flags never match, the first call is always issued
+		unsigned int m_program;
+		unsigned int m_vertexArray;
+		std::array<unsigned int, num_buffer_slots> m_buffers;
+		std::array<BufferRange, max_uniform_buffer_bindings> m_uniformBufferRanges;
+		unsigned int m_activeTextureUnit;
+		std::array<std::array<unsigned int, num_texture_slots>, max_texture_units> m_textures;
+		unsigned int m_framebuffer;
+		std::array<int, 4> m_viewport;
+		int m_blend;
+		std::array<unsigned int, 2> m_blendFunction;
+		int m_depthTest;
+		int m_depthMask;
+		Stats m_stats;
+	};
+}
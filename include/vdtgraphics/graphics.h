@@ -1,21 +1,41 @@
 /// Copyright (c) Vito Domenico Tagliente
 #pragma once
 
+#include "asset_loader.h"
 #include "blend_state.h"
 #include "buffer.h"
+#include "camera_buffer.h"
 #include "camera.h"
 #include "color.h"
+#include "command_list.h"
+#include "compressed_image.h"
 #include "context.h"
+#include "draw_submitter.h"
 #include "font.h"
+#include "gl_state_cache.h"
 #include "image.h"
 #include "index_buffer.h"
+#include "polygon_triangulator.h"
+#include "polyline_tessellator.h"
+#include "program_cache.h"
 #include "render_target.h"
 #include "renderable.h"
 #include "renderer.h"
 #include "shader.h"
 #include "shader_library.h"
 #include "shader_program.h"
+#include "spatial_sprite_index.h"
+#include "sprite_instance.h"
+#include "sprite_layer.h"
 #include "texture.h"
+#include "texture_array.h"
+#include "texture_atlas.h"
+#include "texture_codec.h"
 #include "texture_coords.h"
+#include "texture_file.h"
+#include "texture_pool.h"
 #include "texture_rect.h"
-#include "vertex_buffer.h"
\ No newline at end of file
+#include "texture_uploader.h"
+#include "uniform_buffer.h"
+#include "vertex_buffer.h"
+#include "visibility_culler.h"
\ No newline at end of file
@@ -13,7 +13,18 @@ namespace graphics
 		Image(const Image& other);
 		~Image();
 
+		// flipped as told by flip_vertically
 		static Image load(const std::filesystem::path& filename);
+		// can be called by any thread
+		static Image load(const std::filesystem::path& filename, bool flipVertically);
+
+		// true if no pixel is blended by the sprite shaders, which
+		// discard the ones with alpha < 0.5 and draw the others as they are
+		bool isOpaque() const;
+		static bool isOpaque(const unsigned char* const data, int width, int height, int channels);
+
+		// box filtered to half the size, the last row or column of odd sizes is repeated
+		Image createMipmap() const;
 
 		Image& operator= (const Image& other);
 		bool operator== (const Image& other) const;
@@ -24,6 +35,7 @@ namespace graphics
 		int height;
 		int channels;
 
+		// default of the loads, read by the renderer to orient its quads
 		static bool flip_vertically;
 	};
 }
\ No newline at end of file
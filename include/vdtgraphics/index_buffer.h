@@ -24,7 +24,12 @@ namespace graphics
 		virtual void fillData(void* const data, size_t size) override;
 		virtual void fillSubData(void* const data, size_t size, int offset) override;
 
+		// copy the data after the last written range, orphaning the buffer when full
+		bool stream(const void* const data, size_t size, size_t& offset);
+
 	private:
 		unsigned int m_id;
+		// end of the last streamed range
+		size_t m_head;
 	};
 }
\ No newline at end of file
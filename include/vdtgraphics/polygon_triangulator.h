@@ -0,0 +1,65 @@
+/// Copyright (c) Vito Domenico Tagliente
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+#include <vdtmath/vector3.h>
+
+namespace graphics
+{
+	// Triangulates simple polygons, concave or with holes, by ear clipping.
+	// Holes are bridged to the outline so that a single ring is clipped.
+	// The triangles of the last outlines are kept in a LRU cache keyed
+	// by the hash of their points, so that static outlines are
+	// triangulated once and not every frame.
+	class PolygonTriangulator
+	{
+	public:
+		PolygonTriangulator(size_t cacheCapacity = default_cache_capacity);
+
+		// the points of the outline followed by the points of each hole,
+		// ringEnds holds the end of every ring, the first ring is the outline.
+		// Only x and y are considered, returns the indices of the triangles,
+		// valid until the next call, empty if the polygon is degenerate
+		const std::vector<uint32_t>& triangulate(const math::vec3* const points, const size_t* const ringEnds, size_t numOfRings);
+
+		// num of triangulated outlines kept, 0 disables the cache
+		void setCacheCapacity(size_t capacity);
+		inline size_t getCacheCapacity() const { return m_cacheCapacity; }
+		inline size_t getCacheSize() const { return m_entries.size(); }
+		void clearCache();
+
+		// lookups since the last reset
+		inline size_t getHits() const { return m_hits; }
+		inline size_t getMisses() const { return m_misses; }
+		inline void resetStats() { m_hits = m_misses = 0; }
+
+		static constexpr size_t default_cache_capacity = 256;
+
+	private:
+		struct Entry
+		{
+			uint64_t hash;
+			// the x and y of the points and the rings, against hash collisions
+			std::vector<float> coordinates;
+			std::vector<size_t> ringEnds;
+			std::vector<uint32_t> indices;
+		};
+
+		static uint64_t hash(const math::vec3* const points, const size_t* const ringEnds, size_t numOfRings);
+		// if the entry holds the outline, not just its hash
+		static bool matches(const Entry& entry, const math::vec3* const points, const size_t* const ringEnds, size_t numOfRings);
+
+		size_t m_cacheCapacity;
+		// most recently used first
+		std::list<Entry> m_entries;
+		std::unordered_map<uint64_t, std::list<Entry>::iterator> m_lookup;
+		size_t m_hits{ 0 };
+		size_t m_misses{ 0 };
+		// the result when the cache is disabled
+		std::vector<uint32_t> m_indices;
+	};
+}
@@ -0,0 +1,90 @@
+/// Copyright (c) Vito Domenico Tagliente
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <vdtmath/vector3.h>
+
+#include "color.h"
+#include "common.h"
+
+namespace graphics
+{
+	// Turns a polyline into indexed triangle strips.
+	// Every point emits its two side vertices once, shared by the segments
+	// before and after it, bevel and round joins only add their outer vertices.
+	// Long polylines are split in strips of at most max_points_per_strip points,
+	// so that each of them fits in a batch.
+	class PolylineTessellator
+	{
+	public:
+		struct Style
+		{
+			float width{ 1.f };
+			LineJoin join{ LineJoin::Miter };
+			LineCap cap{ LineCap::Butt };
+			// miter joins longer than miterLimit * width / 2 are beveled
+			float miterLimit{ 4.f };
+			// connect the last point to the first one, no caps are drawn
+			bool closed{ false };
+		};
+
+		static constexpr size_t max_points_per_strip = 256;
+		// num of segments of a half circle, the arcs of round joins and caps use up to this
+		static constexpr size_t round_segments = 16;
+		// bounds of a single strip
+		static constexpr size_t max_strip_vertices = (max_points_per_strip + 1) * (round_segments + 2) + 2 * (round_segments + 1);
+		static constexpr size_t max_strip_indices = (max_points_per_strip + 1) * 2 * (round_segments + 1) + 2 * (round_segments + 1);
+
+		PolylineTessellator() = default;
+
+		// prepare the points, returns false if there is nothing to draw
+		bool begin(const math::vec3* const points, size_t numOfPoints, const Style& style, const Color& color);
+		// tessellate the next strip, returns false when the polyline is complete
+		bool next();
+
+		// the strip produced by the last call to next
+		inline const std::vector<Vertex>& getVertices() const { return m_vertices; }
+		inline const std::vector<uint32_t>& getIndices() const { return m_indices; }
+
+	private:
+		// the vertices of a joint written in the strip
+		enum class JointPart
+		{
+			// the whole joint
+			Full,
+			// only the side vertices ending the incoming segment
+			In,
+			// only the side vertices starting the outgoing segment
+			Out
+		};
+
+		// compute the direction and the normal of every segment
+		void computeSegments();
+		void emitJoint(size_t joint, JointPart part);
+		void emitStartCap();
+		void emitEndCap();
+		uint32_t addVertex(float x, float y, float z);
+		inline void addIndex(const uint32_t index) { m_indices.push_back(index); }
+
+		Style m_style;
+		Color m_color;
+		float m_halfWidth{ 0.f };
+		// the points without consecutive duplicates, one array per component
+		std::vector<float> m_x;
+		std::vector<float> m_y;
+		std::vector<float> m_z;
+		// per segment, from the point i to the next one
+		std::vector<float> m_directionX;
+		std::vector<float> m_directionY;
+		std::vector<float> m_length;
+		size_t m_numOfPoints{ 0 };
+		size_t m_numOfSegments{ 0 };
+		// the first joint of the next strip
+		size_t m_nextJoint{ 0 };
+		bool m_completed{ true };
+		std::vector<Vertex> m_vertices;
+		std::vector<uint32_t> m_indices;
+	};
+}
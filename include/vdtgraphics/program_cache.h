@@ -0,0 +1,63 @@
+/// Copyright (c) Vito Domenico Tagliente
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+
+#include "shader.h"
+
+namespace graphics
+{
+	class ShaderProgram;
+
+	// Keeps the binaries of the linked programs on disk, so that the next launches
+	// skip the driver compiler. A binary is used only if it was made from the same
+	// sources by the same driver, otherwise the program is compiled and stored again
+	class ProgramCache
+	{
+	public:
+		struct Stats
+		{
+			// programs loaded from their binary
+			int hits{ 0 };
+			// programs compiled from the sources, missing or stale binaries
+			int misses{ 0 };
+			// binaries matching the key but refused by the driver
+			int rejected{ 0 };
+		};
+
+		// the binaries are stored in the directory, which must exist
+		ProgramCache(const std::string& directory);
+
+		// true if the context can save and load program binaries
+		static bool isSupported();
+
+		// the program of the sources from its binary, or compiled and stored.
+		// Without support, the program is always compiled
+		std::unique_ptr<ShaderProgram> load(const std::string& name, const std::map<Shader::Type, std::string>& sources);
+		// the program of the sources from its binary, nullptr if there is no valid binary
+		std::unique_ptr<ShaderProgram> find(const std::string& name, const std::map<Shader::Type, std::string>& sources);
+		// store the binary of the linked program, compiled as retrievable from the sources
+		bool store(const std::string& name, const std::map<Shader::Type, std::string>& sources, const ShaderProgram& program);
+		// delete the stored binary of the program
+		void remove(const std::string& name);
+
+		// compile and link the sources, without cache. See ShaderProgram for the flags
+		static std::unique_ptr<ShaderProgram> compile(const std::map<Shader::Type, std::string>& sources, bool retrievable = false, bool deferred = false);
+
+		inline const std::string& getDirectory() const { return m_directory; }
+		inline const Stats& getStats() const { return m_stats; }
+		inline void resetStats() { m_stats = Stats(); }
+
+	private:
+		std::string getFilename(const std::string& name) const;
+		// hash of the vendor, renderer and version of the driver
+		uint64_t getDriverHash();
+
+		std::string m_directory;
+		uint64_t m_driverHash;
+		Stats m_stats;
+	};
+}
@@ -1,24 +1,30 @@
 /// Copyright (c) Vito Domenico Tagliente
 #pragma once
 
-#include <vector>
+#include <array>
+#include <cstdint>
 
 #include <vdtmath/matrix4.h>
 
 #include "common.h"
 #include "render_command.h"
+#include "sprite_instance.h"
+#include "vertex_buffer.h"
 
 namespace graphics
 {
+	class CameraBuffer;
 	class Font;
 	class Renderable;
 	class ShaderProgram;
+	class SpriteLayer;
 	class Texture;
+	class TextureArray;
 
 	class RenderShapeCommand final : public RenderCommand
 	{
 	public:
-		RenderShapeCommand(Renderable* const renderable, ShaderProgram* const program, const math::mat4& viewProjectionMatrix, ShapeRenderStyle style, size_t capacity);
+		RenderShapeCommand(Renderable* const renderable, ShaderProgram* const program, CameraBuffer* const cameras, uint32_t camera, ShapeRenderStyle style, size_t capacity, const VertexBuffer::Range& range);
 
 		size_t capacity() const { return m_capacity; }
 		size_t size() const { return m_size; }
@@ -27,72 +33,218 @@ namespace graphics
 		ShapeRenderStyle getStyle() const { return m_style; }
 
 		bool push(const Vertex& vertex);
+		// no more data will be pushed
+		void close();
 		
 		virtual RenderCommandResult execute() override;
 
 	private:
 		size_t m_capacity;
-		std::vector<float> m_data;
+		// vertices data, written in the mapped buffer or allocated for the frame
+		float* m_data;
+		VertexBuffer::Range m_range;
 		ShaderProgram* m_program;
 		Renderable* m_renderable;
 		size_t m_size;
 		ShapeRenderStyle m_style;
-		math::mat4 m_viewProjectionMatrix;
+		// the camera in the buffer of the frame
+		CameraBuffer* m_cameras;
+		uint32_t m_camera;
+	};
+
+	// indexed triangle strips, consecutive strips are joined by degenerate triangles
+	class RenderShapeStripCommand final : public RenderCommand
+	{
+	public:
+		// room for capacity vertices and twice as many indices
+		RenderShapeStripCommand(Renderable* const renderable, ShaderProgram* const program, CameraBuffer* const cameras, uint32_t camera, size_t capacity, const VertexBuffer::Range& range, uint32_t* const indices);
+
+		size_t capacity() const { return m_capacity; }
+		size_t size() const { return m_size; }
+		bool hasCapacity(size_t numOfVertices, size_t numOfIndices) const;
+
+		bool push(const Vertex* const vertices, size_t numOfVertices, const uint32_t* const indices, size_t numOfIndices);
+		void close();
+
+		virtual RenderCommandResult execute() override;
+
+	private:
+		size_t m_capacity;
+		// vertices data, written in the mapped buffer or allocated for the frame
+		float* m_data;
+		VertexBuffer::Range m_range;
+		// allocated for the frame, streamed on execution
+		uint32_t* m_indices;
+		size_t m_numOfIndices;
+		ShaderProgram* m_program;
+		Renderable* m_renderable;
+		size_t m_size;
+		// the camera in the buffer of the frame
+		CameraBuffer* m_cameras;
+		uint32_t m_camera;
+	};
+
+	// shapes drawn by their distance function, one instance each
+	class RenderShapeInstanceCommand final : public RenderCommand
+	{
+	public:
+		RenderShapeInstanceCommand(Renderable* const renderable, ShaderProgram* const program, CameraBuffer* const cameras, uint32_t camera, size_t capacity, const VertexBuffer::Range& range);
+
+		size_t capacity() const { return m_capacity; }
+		size_t size() const { return m_size; }
+		bool hasCapacity(const size_t numOfShapes) const { return m_capacity - m_size >= numOfShapes; }
+
+		bool push(const ShapeInstance& shape);
+		void close();
+
+		virtual RenderCommandResult execute() override;
+
+	private:
+		size_t m_capacity;
+		// instances data, written in the mapped buffer or allocated for the frame
+		unsigned char* m_data;
+		VertexBuffer::Range m_range;
+		ShaderProgram* m_program;
+		Renderable* m_renderable;
+		size_t m_size;
+		// the camera in the buffer of the frame
+		CameraBuffer* m_cameras;
+		uint32_t m_camera;
 	};
 
 	class RenderTextCommand : public RenderCommand
 	{
 	public:
-		RenderTextCommand(Renderable* const renderable, ShaderProgram* const program, const math::mat4& viewProjectionMatrix, size_t capacity);
+		static constexpr size_t max_font_units = 16;
+
+		RenderTextCommand(Renderable* const renderable, ShaderProgram* const program, CameraBuffer* const cameras, uint32_t camera, SpriteFormat format, size_t capacity, const VertexBuffer::Range& range);
 
 		size_t capacity() const { return m_capacity; }
 		size_t size() const { return m_size; }
 		bool hasCapacity(const size_t numOfFonts) const { return m_capacity - m_size >= numOfFonts; }
 
-		const std::vector<Font*>& getFonts() const { return m_fonts; }
+		SpriteFormat getFormat() const { return m_format; }
+
+		const std::array<Font*, max_font_units>& getFonts() const { return m_fonts; }
+		size_t getNumOfFonts() const { return m_numOfFonts; }
 		bool hasCapacity(Font* const font) const;
 
 		bool push(const SpriteVertex& vertex, Font* const font);
+		void close();
 
 		virtual RenderCommandResult execute() override;
 
 	private:
 		size_t m_capacity; 
-		std::vector<float> m_data;
-		std::vector<Font*> m_fonts;
+		SpriteFormat m_format;
+		// instances data, written in the mapped buffer or allocated for the frame
+		unsigned char* m_data;
+		VertexBuffer::Range m_range;
+		std::array<Font*, max_font_units> m_fonts;
+		size_t m_numOfFonts;
 		ShaderProgram* m_program;
 		Renderable* m_renderable;
 		size_t m_size;
-		math::mat4 m_viewProjectionMatrix;
-
-		static constexpr size_t max_font_units = 16;
+		// the camera in the buffer of the frame
+		CameraBuffer* m_cameras;
+		uint32_t m_camera;
 	};
 
 	class RenderTextureCommand : public RenderCommand
 	{
 	public:
-		RenderTextureCommand(Renderable* const renderable, ShaderProgram* const program, const math::mat4& viewProjectionMatrix, size_t capacity);
+		static constexpr size_t max_texture_units = 16;
+
+		RenderTextureCommand(Renderable* const renderable, ShaderProgram* const program, CameraBuffer* const cameras, uint32_t camera, SpriteFormat format, size_t capacity, const VertexBuffer::Range& range, RenderPass pass = RenderPass::Default);
 
 		size_t capacity() const { return m_capacity; }
 		size_t size() const { return m_size; }
 		bool hasCapacity(const size_t numOfTextures) const { return m_capacity - m_size >= numOfTextures; }
 
-		const std::vector<Texture*>& getTextures() const { return m_textures; }
+		SpriteFormat getFormat() const { return m_format; }
+		RenderPass getPass() const { return m_pass; }
+
+		const std::array<Texture*, max_texture_units>& getTextures() const { return m_textures; }
+		size_t getNumOfTextures() const { return m_numOfTextures; }
+		// false if the texture doesn't fit or isn't premultiplied as the others
 		bool hasCapacity(Texture* const texture) const;
+		// blended with One instead of SourceAlpha
+		bool isPremultiplied() const;
 
 		bool push(const SpriteVertex& vertex, Texture* const texture);
+		void close();
 
 		virtual RenderCommandResult execute() override;
 
 	private:
 		size_t m_capacity;
-		std::vector<float> m_data;
+		SpriteFormat m_format;
+		// instances data, written in the mapped buffer or allocated for the frame
+		unsigned char* m_data;
+		VertexBuffer::Range m_range;
 		ShaderProgram* m_program;
 		Renderable* m_renderable;
 		size_t m_size;
-		std::vector<Texture*> m_textures;
-		math::mat4 m_viewProjectionMatrix;
+		std::array<Texture*, max_texture_units> m_textures;
+		size_t m_numOfTextures;
+		// the camera in the buffer of the frame
+		CameraBuffer* m_cameras;
+		uint32_t m_camera;
+		RenderPass m_pass;
+	};
 
-		static constexpr size_t max_texture_units = 16;
+	// sprites using the layers of the same texture array
+	class RenderTextureArrayCommand final : public RenderCommand
+	{
+	public:
+		RenderTextureArrayCommand(Renderable* const renderable, ShaderProgram* const program, CameraBuffer* const cameras, uint32_t camera, SpriteFormat format, size_t capacity, const VertexBuffer::Range& range, RenderPass pass = RenderPass::Default);
+
+		size_t capacity() const { return m_capacity; }
+		size_t size() const { return m_size; }
+		bool hasCapacity(const size_t numOfTextures) const { return m_capacity - m_size >= numOfTextures; }
+
+		SpriteFormat getFormat() const { return m_format; }
+		RenderPass getPass() const { return m_pass; }
+
+		TextureArray* const getTextureArray() const { return m_textureArray; }
+		bool hasCapacity(TextureArray* const textureArray) const { return m_textureArray == nullptr || m_textureArray == textureArray; }
+
+		// the texture must be a layer of an array
+		bool push(const SpriteVertex& vertex, Texture* const texture);
+		void close();
+
+		virtual RenderCommandResult execute() override;
+
+	private:
+		size_t m_capacity;
+		SpriteFormat m_format;
+		// instances data, written in the mapped buffer or allocated for the frame
+		unsigned char* m_data;
+		VertexBuffer::Range m_range;
+		ShaderProgram* m_program;
+		Renderable* m_renderable;
+		size_t m_size;
+		TextureArray* m_textureArray;
+		// the camera in the buffer of the frame
+		CameraBuffer* m_cameras;
+		uint32_t m_camera;
+		RenderPass m_pass;
+	};
+
+	class RenderSpriteLayerCommand final : public RenderCommand
+	{
+	public:
+		RenderSpriteLayerCommand(Renderable* const renderable, ShaderProgram* const program, CameraBuffer* const cameras, uint32_t camera, SpriteLayer* const layer);
+
+		virtual RenderCommandResult execute() override;
+
+	private:
+		// the quad shared with the sprite batches
+		Renderable* m_renderable;
+		ShaderProgram* m_program;
+		SpriteLayer* m_layer;
+		// the camera in the buffer of the frame
+		CameraBuffer* m_cameras;
+		uint32_t m_camera;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,47 @@
+/// Copyright (c) Vito Domenico Tagliente
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace graphics
+{
+	// Collect draw requests tagged by a 64 bits sort key
+	// and order them with a stable radix sort.
+	// The key layout, from the most significant bits, is:
+	// | layer (16) | pipeline (8) | blend state (8) | texture set (32) |
+	// so that draws of the same layer end up grouped by state.
+	class RenderQueue
+	{
+	public:
+
+		struct Item
+		{
+			// the sort key
+			uint64_t key;
+			// index of the draw data, owned by the caller
+			uint32_t index;
+		};
+
+		RenderQueue();
+
+		// the layer is clamped to the 16 bits of the key
+		static uint64_t makeKey(int layer, uint8_t pipeline, uint8_t blend, uint32_t textureSet);
+		static uint8_t getPipeline(uint64_t key);
+
+		inline size_t size() const { return m_items.size(); }
+		inline bool empty() const { return m_items.empty(); }
+		inline const std::vector<Item>& getItems() const { return m_items; }
+
+		void push(uint64_t key, uint32_t index);
+		// sort the items, preserving the submission order of equal keys
+		const std::vector<Item>& sort();
+		void clear();
+
+	private:
+		std::vector<Item> m_items;
+		// scratch storage for the radix passes
+		std::vector<Item> m_buffer;
+	};
+}
@@ -1,46 +1,127 @@
 /// Copyright (c) Vito Domenico Tagliente
 #pragma once
 
+#include <array>
+#include <initializer_list>
 #include <memory>
+#include <mutex>
 #include <stack>
+#include <utility>
 
 #include <vdtmath/matrix4.h>
 #include <vdtmath/vector3.h>
 
 #include "common.h"
+#include "camera_buffer.h"
 #include "color.h"
+#include "command_list.h"
+#include "draw_submitter.h"
+#include "frame_allocator.h"
 #include "renderable.h"
 #include "render_command.h"
+#include "render_queue.h"
 #include "shader_library.h"
 #include "shader_program.h"
+#include "sprite_instance.h"
 #include "texture_rect.h"
+#include "vertex_buffer.h"
+#include "visibility_culler.h"
 
 namespace graphics
 {
 	class Context;
 	class Font;
+	class ProgramCache;
+	class RenderShapeCommand;
+	class RenderShapeInstanceCommand;
+	class RenderShapeStripCommand;
 	class RenderTarget;
+	class RenderTextCommand;
+	class RenderTextureCommand;
+	class RenderTextureArrayCommand;
+	class SpatialSpriteIndex;
+	class SpriteLayer;
 	class Texture;
+	class TextureArray;
 
-	class Renderer
+	class Renderer : public DrawSubmitter
 	{
 	public:
 
 		struct Stats
 		{
 			int drawCalls{ 0 };
+			// draws outside of the view, dropped before being batched, sprites of a spatial index included
+			int culledDraws{ 0 };
+			// polygons submitted to the renderer found in its triangulation cache, or triangulated
+			int polygonCacheHits{ 0 };
+			int polygonCacheMisses{ 0 };
+			// sprites drawn by the opaque and translucent passes
+			int opaqueSprites{ 0 };
+			int translucentSprites{ 0 };
+
+			float getPolygonCacheHitRate() const
+			{
+				const int lookups = polygonCacheHits + polygonCacheMisses;
+				return lookups > 0 ? static_cast<float>(polygonCacheHits) / lookups : 0.f;
+			}
+		};
+
+		// the built-in programs, created by the first draw using them
+		enum class Pipeline
+		{
+			Color,
+			Shape,
+			ShapeInstance,
+			Text,
+			TextCompact,
+			Sprite,
+			SpriteCompact,
+			SpriteArray,
+			SpriteArrayCompact,
+			Texture,
+			Count
 		};
 
 		Renderer() = default;
 		virtual ~Renderer() = default;
 
-		bool init(Context* const context);
+		// the programs are loaded through the cache if given, it must outlive the renderer
+		bool init(Context* const context, ProgramCache* const programCache = nullptr);
 		void uninit();
 
+		// start the compilation of the pipelines without waiting for it, for instance
+		// during a loading screen. The driver compiles in the background if it supports
+		// KHR_parallel_shader_compile, otherwise the compilation happens in the call
+		void prewarm(const std::initializer_list<Pipeline>& pipelines);
+		void prewarm();
+		// true once the compilations started are done, it never waits
+		bool isPrewarmed();
+
 		void clear(const Color& color);
 		void setViewport(int width, int height);
 		void setWireframeMode(bool enabled);
 
+		// when enabled, draws are collected and sorted by layer and state at flush,
+		// instead of being batched in submission order
+		void setSortingEnabled(bool enabled);
+		bool isSortingEnabled() const { return m_sortingEnabled; }
+
+		// when enabled, shapes, glyphs and sprites outside of the view are not drawn
+		void setCullingEnabled(bool enabled) { m_cullingEnabled = enabled; }
+		bool isCullingEnabled() const { return m_cullingEnabled; }
+
+		// when enabled, the sprites of opaque textures and colors are drawn front to back
+		// without blending, then the other sprites back to front without depth writes,
+		// after the rest of the draws submitted with the same view. See Texture::isOpaque
+		void setOpaquePassEnabled(bool enabled);
+		bool isOpaquePassEnabled() const { return m_opaquePassEnabled; }
+
+		// layout of the text and sprite instances, the compact one keeps only
+		// the 2D part of the transforms and halves the uploaded data
+		void setSpriteFormat(SpriteFormat format);
+		SpriteFormat getSpriteFormat() const { return m_spriteFormat; }
+
 		void setRenderTarget(RenderTarget* const renderTarget);
 
 		void setProjectionMatrix(const math::matrix4& m);
@@ -48,43 +129,157 @@ namespace graphics
 		const math::matrix4& getProjectionMatrix() const { return m_projectionMatrix; }
 		const math::matrix4& getViewMatrix() const { return m_viewMatrix; }
 		const math::matrix4& getViewProjectionMatrix() const { return m_viewProjectionMatrix; }
+		// seconds, exposed to the shaders as u_time from the next batches
+		void setTime(float time);
+		float getTime() const { return m_time; }
 
 		void submit(std::unique_ptr<RenderCommand> command);
-		void submitDrawCircle(ShapeRenderStyle style, const math::vec3& position, float radius, const Color& color);
-		void submitDrawLine(const math::vec3& point1, const Color& color1, const math::vec3& point2, const Color& color2);
-		void submitDrawShape(ShapeRenderStyle style, const std::vector<Vertex>& vertices);
-		void submitDrawRect(ShapeRenderStyle style, const math::vec3& position, float width, float height, const Color& color);
-		void submitDrawText(Font* const font, const std::string& text, const math::vec3& position, float scale = 1.0f, const Color& color = Color::White);
-		void submitDrawTexture(Texture* const texture, const math::mat4& matrix, const TextureRect& rect = {}, const Color& color = Color::White);
-		void submitDrawTexture(Texture* const texture, const math::vec3& position, const TextureRect& rect = {}, const Color& color = Color::White);
-		void submitDrawTexture(Texture* const texture, const math::vec3& position, float rotation, const TextureRect& rect = {}, const Color& color = Color::White);
-		void submitDrawTexture(Texture* const texture, const math::vec3& position, const math::vec3& scale, const TextureRect& rect = {}, const Color& color = Color::White);
-		void submitDrawTexture(Texture* const texture, const math::vec3& position, float rotation, const math::vec3& scale, const TextureRect& rect = {}, const Color& color = Color::White);
+		// merge a recorded list at the next flush, the list must stay alive until then.
+		// Can be called by any thread, the lists are merged by order and creation whatever the calls order
+		void submit(const CommandList& commandList);
+		// draw the retained sprites with one call, uploading only what changed since the last draw.
+		// The layer must stay alive until flush, in sorting mode it is drawn before the sorted draws
+		void submit(SpriteLayer& layer);
+		// draw the sprites of the index seen by the current view and projection,
+		// only the cells around the view are visited
+		void submit(const SpatialSpriteIndex& index);
 
 		void flush();
 
 		Stats stats;
 
+	protected:
+		virtual void pushShape(ShapeRenderStyle style, const Vertex* const vertices, size_t numOfVertices) override;
+		virtual void pushShapeInstance(const ShapeInstance& shape) override;
+		virtual void pushShapeStrip(const Vertex* const vertices, size_t numOfVertices, const uint32_t* const indices, size_t numOfIndices) override;
+		virtual void pushGlyph(const SpriteVertex& vertex, Font* const font) override;
+		virtual void pushSprite(const SpriteVertex& vertex, Texture* const texture) override;
+
 	private:
-		std::unique_ptr<ShaderProgram> createProgram(const std::string& name);
+		// the program of the pipeline, compiled on first use
+		ShaderProgram* getProgram(Pipeline pipeline);
+		std::unique_ptr<ShaderProgram> createProgram(Pipeline pipeline);
+		// finish the programs done linking, and store them in the cache
+		void finishPrograms();
+		// quad and streaming instance buffer of the text and sprite batches
+		std::unique_ptr<Renderable> createSpriteRenderable(const std::vector<float>& vertices, SpriteFormat format);
+
+		// find the open batch able to accept the data, or start a new one
+		RenderShapeCommand* const getShapeCommand(ShapeRenderStyle style, size_t numOfVertices);
+		RenderShapeInstanceCommand* const getShapeInstanceCommand();
+		RenderShapeStripCommand* const getShapeStripCommand(size_t numOfVertices, size_t numOfIndices);
+		RenderTextCommand* const getTextCommand(Font* const font, size_t numOfGlyphs);
+		RenderTextureCommand* const getTextureCommand(Texture* const texture);
+		RenderTextureArrayCommand* const getTextureArrayCommand(TextureArray* const textureArray);
+		// the index of the current camera in the buffer of the frame, uploaded at execution
+		uint32_t getCamera();
+		// batch the vertices, spreading them over more batches if they don't fit in one
+		void batchShape(ShapeRenderStyle style, const Vertex* const vertices, size_t numOfVertices);
+		// batch the sprite with the pipeline of its texture, or defer it to its pass
+		void batchSprite(const SpriteVertex& vertex, Texture* const texture);
+		// batch the deferred sprites, opaque ones first
+		void drawPasses();
+		// the normalized device depth of the center of the sprite
+		float getDepth(const SpriteVertex& vertex) const;
+		// reserve the data of a new batch, written in place if the buffer is persistently mapped
+		VertexBuffer::Range reserve(VertexBuffer& buffer, size_t size);
+		// stop appending to the current batches
+		void closeBatches();
+		// run the commands submitted so far
+		void executeCommands();
+		// merge the recorded draws and move them into batches
+		void resolveQueue();
+		// move a recorded draw into its batch
+		void resolve(const CommandList& commandList, const RenderQueue::Item& item);
+		// true if the draw is outside of the view and must be dropped
+		bool cull(const VisibilityCuller::Bounds& bounds);
+		// test the recorded draws of the list, by submission order
+		void computeVisibility(const CommandList& commandList);
+		static VisibilityCuller::Bounds getBounds(const CommandList& commandList, const RenderQueue::Item& item);
+
+		// the last batch of each pipeline, the only ones data can be appended to
+		struct Batches
+		{
+			RenderShapeCommand* shapeFill{ nullptr };
+			RenderShapeCommand* shapeStroke{ nullptr };
+			RenderShapeInstanceCommand* shapeInstance{ nullptr };
+			RenderShapeStripCommand* shapeStrip{ nullptr };
+			RenderTextCommand* text{ nullptr };
+			RenderTextureCommand* texture{ nullptr };
+			RenderTextureArrayCommand* textureArray{ nullptr };
+		};
 
-		std::vector<std::unique_ptr<RenderCommand>> m_commands;
+		// commands and transient data of the frame
+		FrameAllocator m_frameAllocator;
+		std::vector<RenderCommand*> m_commands;
+		// commands submitted by the user
+		std::vector<std::unique_ptr<RenderCommand>> m_ownedCommands;
+		Batches m_batches;
+		SpriteFormat m_spriteFormat{ SpriteFormat::Standard };
+		// sorting mode, the draws of the renderer are recorded too
+		bool m_sortingEnabled{ false };
+		CommandList m_commandList;
+		// lists submitted by the other threads
+		std::mutex m_commandListsMutex;
+		std::vector<const CommandList*> m_commandLists;
+		// draws of all the lists, sorted together
+		RenderQueue m_mergeQueue;
+		std::vector<std::pair<const CommandList*, uint32_t>> m_mergeItems;
+		// culling
+		bool m_cullingEnabled{ true };
+		VisibilityCuller m_culler;
+		std::vector<VisibilityCuller::Bounds> m_cullBounds;
+		std::vector<uint8_t> m_visibility;
+		// sprites deferred to the opaque and translucent passes
+		struct PassSprite
+		{
+			float depth;
+			SpriteVertex vertex;
+			Texture* texture;
+		};
+		bool m_opaquePassEnabled{ false };
+		RenderPass m_pass{ RenderPass::Default };
+		std::vector<PassSprite> m_opaqueSprites;
+		std::vector<PassSprite> m_translucentSprites;
+		std::vector<uint32_t> m_passOrder;
+		// sprites of the spatial indices seen by the view
+		std::vector<uint32_t> m_spriteHandles;
+		// streaming buffers, fenced at every flush
+		std::vector<VertexBuffer*> m_streamingBuffers;
 		RenderTarget* m_renderTarget{ nullptr };
 		std::unique_ptr<ShaderLibrary> m_shaderLibrary;
+		ProgramCache* m_programCache{ nullptr };
 		// matrices
 		math::mat4 m_projectionMatrix{ math::mat4::identity };
 		math::mat4 m_viewMatrix{ math::mat4::identity };
 		math::mat4 m_viewProjectionMatrix{ math::mat4::identity };
+		// cameras of the frame, shared by the shaders
+		std::unique_ptr<CameraBuffer> m_cameraBuffer;
+		uint32_t m_camera{ CameraBuffer::invalid_index };
+		float m_viewport[2]{ 0.f, 0.f };
+		float m_time{ 0.f };
 		// renderables
 		std::unique_ptr<Renderable> m_shapeFillRenderable;
 		std::unique_ptr<Renderable> m_shapeStrokeRenderable;
+		std::unique_ptr<Renderable> m_shapeInstanceRenderable;
+		std::unique_ptr<Renderable> m_shapeStripRenderable;
 		std::unique_ptr<Renderable> m_textRenderable;
 		std::unique_ptr<Renderable> m_textureRenderable;
-		// programs
-		std::unique_ptr<ShaderProgram> m_colorProgram;
-		std::unique_ptr<ShaderProgram> m_shapeProgram;
-		std::unique_ptr<ShaderProgram> m_spriteProgram;
-		std::unique_ptr<ShaderProgram> m_textProgram;
-		std::unique_ptr<ShaderProgram> m_textureProgram;
+		std::unique_ptr<Renderable> m_compactTextRenderable;
+		std::unique_ptr<Renderable> m_compactTextureRenderable;
+		std::unique_ptr<Renderable> m_textureArrayRenderable;
+		std::unique_ptr<Renderable> m_compactTextureArrayRenderable;
+		// programs by pipeline, and the ones still linking
+		std::array<std::unique_ptr<ShaderProgram>, static_cast<size_t>(Pipeline::Count)> m_programs;
+		std::vector<Pipeline> m_linkingPrograms;
+
+		// num of vertices of a shape batch
+		static constexpr size_t shape_batch_capacity = 1000;
+		// num of vertices of a shape strip batch, it holds twice as many indices
+		static constexpr size_t shape_strip_batch_capacity = 8192;
+		// num of instances of a shape, text or sprite batch
+		static constexpr size_t sprite_batch_capacity = 10000;
+		// num of batches a streaming buffer holds, shared by the frames in flight
+		static constexpr size_t streaming_batches = 4;
 	};
 }
\ No newline at end of file
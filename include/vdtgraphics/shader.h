@@ -34,7 +34,9 @@ namespace graphics
 			static bool parse(const std::string& content, std::map<Type, std::string>& sources);
 		};
 
-		Shader(Type type, const std::string& source);
+		// a deferred shader doesn't wait for the compile status, its state stays Unknown
+		// and errors are reported by the program it is linked to
+		Shader(Type type, const std::string& source, bool deferred = false);
 		~Shader();
 
 		void free();
@@ -19,8 +19,13 @@ namespace graphics
 
 			static const std::string ColorShader;
 			static const std::string PolygonBatchShader;
+			static const std::string ShapeShader;
 			static const std::string SpriteBatchShader;
+			static const std::string SpriteBatchCompactShader;
+			static const std::string SpriteArrayShader;
+			static const std::string SpriteArrayCompactShader;
 			static const std::string TextShader;
+			static const std::string TextCompactShader;
 			static const std::string TextureShader;
 		};
 
@@ -1,16 +1,53 @@
 /// Copyright (c) Vito Domenico Tagliente
 #pragma once
 
+#include <cstdint>
 #include <initializer_list>
-#include <map>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include <vdtmath/matrix4.h>
 
+#include "color.h"
+
 namespace graphics
 {
 	class Shader;
 
+	// the name of a uniform, hashed at compile time when constant
+	class UniformName
+	{
+	public:
+		constexpr UniformName(const char* const name) : m_hash(hash(name)) {}
+		UniformName(const std::string& name) : m_hash(hash(name.c_str())) {}
+
+		constexpr uint32_t getHash() const { return m_hash; }
+
+		// FNV-1a
+		static constexpr uint32_t hash(const char* name)
+		{
+			uint32_t result = 2166136261u;
+			while (*name != '\0')
+			{
+				result = (result ^ static_cast<uint8_t>(*name++)) * 16777619u;
+			}
+			return result;
+		}
+
+	private:
+		uint32_t m_hash;
+	};
+
+	// the location of a uniform of type T, resolved once
+	template <typename T>
+	struct UniformHandle
+	{
+		int location{ -1 };
+
+		bool isValid() const { return location >= 0; }
+	};
+
 	class ShaderProgram
 	{
 	public:
@@ -19,12 +56,19 @@ namespace graphics
 		{
 			Unknown,
 			Error,
-			Linked
+			Linked,
+			// link issued, not finished yet
+			Linking
 		};
 
-		ShaderProgram(const std::initializer_list<Shader*>& shaders);
+		// link the shaders, a retrievable program can be saved with getBinary.
+		// A deferred program is left Linking, so that the driver can link it in the background
+		ShaderProgram(const std::initializer_list<Shader*>& shaders, bool retrievable = false, bool deferred = false);
+		// load a binary given by getBinary, the state is Error if the driver rejects it
+		ShaderProgram(unsigned int binaryFormat, const void* const binary, size_t size);
 		~ShaderProgram();
 
+		// a Linking program is finished first
 		void bind();
 		void unbind();
 		void free();
@@ -34,17 +78,59 @@ namespace graphics
 		inline const std::string& getErrorMessage() const { return m_errorMessage; }
 		inline bool isValid() const { return m_id != 0; }
 
-		// uniform setters
+		// true unless the driver is still linking, it never waits
+		bool isReady() const;
+		// wait for the link and resolve the uniforms of a Linking program
+		State finish();
+		// true if the driver compiles and links in the background, see KHR_parallel_shader_compile
+		static bool isParallelCompileSupported();
+
+		// the driver specific binary of the linked program, false if not available
+		bool getBinary(unsigned int& binaryFormat, std::vector<uint8_t>& binary) const;
+
+		// the uniform of the linked program, invalid if missing or of another type.
+		// Defined for bool, int, float, math::mat4 and Color. A Linking program is finished first
+		template <typename T>
+		UniformHandle<T> getUniform(UniformName name);
+		// the unit assigned to the sampler at link, its trailing number
+		// or the first free unit, -1 if there is no such sampler. A Linking program is finished first
+		int getTextureUnit(UniformName name);
+
+		// set the uniforms of the bound program
+		void set(UniformHandle<bool> handle, bool value);
+		void set(UniformHandle<int> handle, int value);
+		void set(UniformHandle<float> handle, float value);
+		void set(UniformHandle<math::mat4> handle, const math::mat4& matrix);
+		void set(UniformHandle<Color> handle, const Color& color);
+
+		// uniform setters, looked up by name. The elements of arrays are named as in GLSL, u_lights[2]
 		void set(const std::string& name, bool value);
 		void set(const std::string& name, int value);
 		void set(const std::string& name, float value);
 		void set(const std::string& name, const math::mat4& matrix);
 		void set(const std::string& name, float f1, float f2, float f3, float f4);
+		// assign the uniform block to a binding point, false if the program has no such block.
+		// The blocks of a Linking program are assigned once finished
+		bool bindUniformBlock(const std::string& name, unsigned int bindingPoint);
 
 	protected:
 
-		// find the uniform layout location
-		int getUniformLocation(const std::string& t_name) const;
+		struct Uniform
+		{
+			uint32_t hash;
+			// without the index of arrays
+			std::string name;
+			int location;
+			unsigned int type;
+			// the first texture unit of a sampler, or -1
+			int unit;
+		};
+
+		// read the active uniforms of the linked program and assign the texture units
+		void resolveUniforms();
+		const Uniform* const findUniform(UniformName name) const;
+		// find the uniform layout location, asking the driver for the elements of arrays
+		int getUniformLocation(const std::string& t_name);
 
 		// program id
 		unsigned int m_id;
@@ -53,7 +139,10 @@ namespace graphics
 		// error message
 		std::string m_errorMessage;
 
-		// uniform locations
-		mutable std::map<std::string, unsigned int> m_uniformLocations;
+		// active uniforms, sorted by hash
+		std::vector<Uniform> m_uniforms;
+		// shaders to detach and blocks to bind once linked
+		std::vector<unsigned int> m_shaders;
+		std::vector<std::pair<std::string, unsigned int>> m_uniformBlocks;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,87 @@
+/// Copyright (c) Vito Domenico Tagliente
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <vdtmath/matrix4.h>
+#include <vdtmath/vector3.h>
+
+#include "color.h"
+#include "common.h"
+#include "texture_rect.h"
+#include "visibility_culler.h"
+
+namespace graphics
+{
+	class Texture;
+
+	// Sprites placed in the world, indexed by a loose uniform grid so that
+	// only the ones near the view are visited when drawing.
+	// A sprite belongs to the cell of its center and may overflow it by up to
+	// a cell, larger sprites are kept aside and always tested.
+	// Adding, moving and removing a sprite are constant time.
+	// Drawn through Renderer::submit, with the current view and projection
+	class SpatialSpriteIndex
+	{
+	public:
+		typedef uint32_t Handle;
+
+		static constexpr Handle invalid_handle = ~0u;
+
+		// the cells should be about as large as the sprites, or a bit larger
+		SpatialSpriteIndex(float cellSize = 128.f);
+
+		inline size_t size() const { return m_size; }
+		inline bool empty() const { return m_size == 0; }
+		inline float getCellSize() const { return m_cellSize; }
+		inline size_t getNumOfCells() const { return m_cells.size(); }
+
+		Handle add(Texture* const texture, const math::mat4& transform, const TextureRect& rect = {}, const Color& color = Color::White);
+		Handle add(Texture* const texture, const math::vec3& position, const TextureRect& rect = {}, const Color& color = Color::White);
+		bool update(Handle handle, const math::mat4& transform);
+		bool update(Handle handle, const math::mat4& transform, const TextureRect& rect, const Color& color);
+		// the handle becomes invalid and can be given to a new sprite
+		bool remove(Handle handle);
+		bool contains(Handle handle) const;
+		void clear();
+
+		// append the sprites seen through the view projection matrix, as given
+		// by Camera::ortho and Camera::view. Only the cells around the view are visited
+		void query(const math::mat4& viewProjectionMatrix, std::vector<Handle>& handles) const;
+		void query(const VisibilityCuller& culler, std::vector<Handle>& handles) const;
+
+		// the handle must be valid
+		inline const SpriteVertex& getVertex(const Handle handle) const { return m_sprites[handle].vertex; }
+		inline Texture* const getTexture(const Handle handle) const { return m_sprites[handle].texture; }
+
+	private:
+		struct Sprite
+		{
+			SpriteVertex vertex;
+			Texture* texture;
+			VisibilityCuller::Bounds bounds;
+			// the cell holding the sprite, and its position in the cell
+			uint64_t cell;
+			uint32_t slot;
+			bool oversized;
+			bool used;
+		};
+
+		// the key of the cell of the sprite, false if it is too large for a cell
+		bool getCell(const VisibilityCuller::Bounds& bounds, uint64_t& cell) const;
+		void insert(Handle handle);
+		void erase(Handle handle);
+		void queryCell(const std::vector<Handle>& sprites, const VisibilityCuller& culler, std::vector<Handle>& handles) const;
+
+		float m_cellSize;
+		// by handle
+		std::vector<Sprite> m_sprites;
+		std::vector<Handle> m_freeHandles;
+		size_t m_size;
+		// the handles of the sprites of each cell
+		std::unordered_map<uint64_t, std::vector<Handle>> m_cells;
+		std::vector<Handle> m_oversized;
+	};
+}
@@ -0,0 +1,49 @@
+/// Copyright (c) Vito Domenico Tagliente
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "common.h"
+#include "vertex_buffer.h"
+
+namespace graphics
+{
+	// how the text and sprite instances are streamed to the GPU
+	enum class SpriteFormat
+	{
+		// texture index, crop, color and transform as floats, 100 bytes
+		Standard,
+		// 2D affine transform, packed crop and color, 40 bytes
+		Compact
+	};
+
+	// compact layout of a text or sprite instance.
+	// Only the 2D part of the transform is kept, the depth is a half float,
+	// the crop is normalized to [0, 1] and the color to 8 bits per channel
+	struct CompactSpriteInstance
+	{
+		// the rows of the 2x3 affine transform
+		float transform[6];
+		uint16_t crop[4];
+		uint8_t color[4];
+		uint16_t textureIndex;
+		// half float
+		uint16_t depth;
+	};
+
+	static_assert(sizeof(CompactSpriteInstance) == 40, "unexpected compact sprite instance size");
+
+	// size in bytes of an instance
+	size_t getInstanceSize(SpriteFormat format);
+	// the attributes of an instance, starting at location 2 after the quad ones
+	void setInstanceLayout(SpriteFormat format, VertexBufferLayout& layout);
+	// write the instance at data in the given format. The color is multiplied
+	// by its alpha for the premultiplied textures, blended with One
+	void writeInstance(void* const data, SpriteFormat format, size_t textureIndex, const SpriteVertex& vertex, bool premultiply = false);
+
+	// write the instance in its compact layout
+	void packInstance(const SpriteVertex& vertex, uint16_t textureIndex, CompactSpriteInstance& instance);
+	// the half float closest to the value
+	uint16_t toHalfFloat(float value);
+}
@@ -0,0 +1,93 @@
+/// Copyright (c) Vito Domenico Tagliente
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <vdtmath/matrix4.h>
+#include <vdtmath/vector3.h>
+
+#include "color.h"
+#include "sprite_instance.h"
+#include "texture_rect.h"
+
+namespace graphics
+{
+	class Texture;
+	class VertexBuffer;
+
+	// sprites kept on the GPU across frames, only the changed ones are uploaded again.
+	// Drawn with a single instanced call through Renderer::submit
+	class SpriteLayer
+	{
+	public:
+		typedef uint32_t Handle;
+
+		static constexpr Handle invalid_handle = ~0u;
+		static constexpr size_t max_texture_units = 16;
+
+		SpriteLayer(size_t capacity = 1000, SpriteFormat format = SpriteFormat::Standard);
+		~SpriteLayer();
+
+		SpriteLayer(const SpriteLayer&) = delete;
+		SpriteLayer& operator=(const SpriteLayer&) = delete;
+
+		inline size_t size() const { return m_handles.size(); }
+		inline bool empty() const { return m_handles.empty(); }
+		inline SpriteFormat getFormat() const { return m_format; }
+
+		const std::array<Texture*, max_texture_units>& getTextures() const { return m_textures; }
+		size_t getNumOfTextures() const { return m_numOfTextures; }
+		// the layer is drawn with One instead of SourceAlpha
+		bool isPremultiplied() const;
+
+		// returns invalid_handle if the layer already uses max_texture_units other textures,
+		// if the texture is the layer of a TextureArray or isn't premultiplied as the others
+		Handle add(Texture* const texture, const math::mat4& transform, const TextureRect& rect = {}, const Color& color = Color::White);
+		Handle add(Texture* const texture, const math::vec3& position, const TextureRect& rect = {}, const Color& color = Color::White);
+		bool update(Handle handle, const math::mat4& transform);
+		bool update(Handle handle, const math::mat4& transform, const TextureRect& rect, const Color& color);
+		// the handle becomes invalid and can be given to a new sprite
+		bool remove(Handle handle);
+		bool contains(Handle handle) const;
+		void clear();
+
+		// upload the changed instances, must be called on the render thread
+		VertexBuffer* const upload();
+		// bytes sent to the GPU by the last upload
+		size_t getUploadedBytes() const { return m_uploadedBytes; }
+
+	private:
+		struct Sprite
+		{
+			SpriteVertex vertex;
+			size_t textureIndex;
+		};
+
+		void write(size_t index);
+		void setDirty(size_t index);
+		size_t findTexture(Texture* const texture);
+		void releaseTexture(size_t textureIndex);
+
+		SpriteFormat m_format;
+		size_t m_capacity;
+		// instances on the CPU, the GPU buffer mirrors them
+		std::vector<unsigned char> m_data;
+		std::vector<Sprite> m_sprites;
+		// dense index to handle and handle to dense index
+		std::vector<Handle> m_handles;
+		std::vector<uint32_t> m_indices;
+		std::vector<Handle> m_freeHandles;
+		// changed ranges of instances, [begin, end)
+		std::vector<std::pair<size_t, size_t>> m_dirtyRanges;
+		// textures and the num of sprites using them
+		std::array<Texture*, max_texture_units> m_textures;
+		std::array<size_t, max_texture_units> m_textureReferences;
+		size_t m_numOfTextures;
+		std::unique_ptr<VertexBuffer> m_buffer;
+		size_t m_uploadedBytes;
+	};
+}
@@ -3,13 +3,26 @@
 
 #include <memory>
 
+#include "compressed_image.h"
 #include "image.h"
+#include "texture_file.h"
 
 namespace graphics
 {
+	class TextureArray;
+
 	class Texture
 	{
 	public:
+		// how the sprites of the texture are drawn when the renderer splits opaque and translucent draws
+		enum class Opacity
+		{
+			// detected from the alpha of the data
+			Auto,
+			Opaque,
+			Translucent
+		};
+
 		struct Options
 		{
 			Options();
@@ -22,27 +35,75 @@ namespace graphics
 			unsigned int filterMin;
 			// Filtering mode if texture pixels > screen pixels
 			unsigned int filterMax;
+			// Opacity hint
+			Opacity opacity;
+			// allocated once by glTexStorage2D where available, the size and the levels can't change
+			bool immutable;
+			// levels of the mip chain, 0 for the whole chain when created with data, 1 otherwise
+			unsigned int levels;
 		};
 
 		Texture(const unsigned char* const data, unsigned int width, unsigned int height,
 			unsigned int channels, const Options& options = Options{});
 		Texture(const Image& image, const Options& options = Options{});
+		// uploads the mip chain as it is, or decoded to RGBA if the context lacks the format
+		Texture(const CompressedImage& image, const Options& options = Options{});
+		// uploads the mip chain of the file from its mapped pages, without generating it
+		Texture(const TextureFile& file, const Options& options = Options{});
 		~Texture();
 
+		// not supported by compressed textures
 		void fillSubData(int offsetX, int offsetY, int width, int height, unsigned char* const data);
+		// drops the mip chain, not supported by immutable textures either
 		void resize(int width, int height);
+		// the sampling parameters and the opacity hint, Auto leaves the opacity as it is
+		void setOptions(const Options& options);
 
 		inline unsigned int id() const { return m_id; }
 		inline bool isValid() const { return m_id != 0; }
 
 		inline unsigned int getWidth() const { return m_width; }
 		inline unsigned int getHeight() const { return m_height; }
+		// GL format of the pixels
+		inline unsigned int getFormat() const { return m_format; }
+		// true if the GPU samples the blocks of a CompressedImage
+		bool isCompressed() const;
+		inline unsigned int getNumOfLevels() const { return m_levels; }
+		// true if the storage was allocated once by glTexStorage2D
+		inline bool isImmutable() const { return m_immutable; }
+		// of the chain down to 1x1
+		static unsigned int getMaxNumOfLevels(unsigned int width, unsigned int height);
+		// GL format of pixels with the channels
+		static unsigned int toFormat(unsigned int channels);
+		// bytes of a pixel in an uncompressed GL format
+		static size_t getPixelSize(unsigned int format);
+
+		// opaque textures are drawn front to back without blending,
+		// not detected again when the data changes
+		inline bool isOpaque() const { return m_opaque; }
+		inline void setOpaque(const bool opaque) { m_opaque = opaque; }
+		// the color is multiplied by the alpha, blended with One instead of SourceAlpha.
+		// Set by the texture files converted with the option
+		inline bool isPremultiplied() const { return m_premultiplied; }
+		inline void setPremultiplied(const bool premultiplied) { m_premultiplied = premultiplied; }
+
+		// the array the texture is a layer of, if any
+		inline TextureArray* const getArray() const { return m_array; }
+		inline unsigned int getLayer() const { return m_layer; }
 
 		void bind(unsigned int slot = 0);
 		void unbind();
 		void free();
 
 	protected:
+		friend class TextureArray;
+
+		// a layer of the array, sharing its id
+		Texture(TextureArray* const array, unsigned int layer);
+
+		// allocates the levels by glTexStorage2D if asked and supported, on the bound texture.
+		// False if the levels are left to glTexImage2D
+		bool allocateStorage(const Options& options);
 
 		// texture id
 		unsigned int m_id;
@@ -50,6 +111,14 @@ namespace graphics
 		unsigned int m_width, m_height;
 		// format of the texture object
 		unsigned int m_format;
+		// levels of the mip chain
+		unsigned int m_levels;
+		bool m_immutable;
+		bool m_opaque;
+		bool m_premultiplied;
+		// array of the layer
+		TextureArray* m_array;
+		unsigned int m_layer;
 	};
 
 	typedef std::shared_ptr<Texture> TexturePtr;
@@ -0,0 +1,63 @@
+/// Copyright (c) Vito Domenico Tagliente
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "image.h"
+#include "texture.h"
+
+namespace graphics
+{
+	// Textures of the same size and format stored as the layers of a single texture,
+	// sprites using any of them are batched together and sampled without branching
+	class TextureArray
+	{
+	public:
+		TextureArray(unsigned int width, unsigned int height, unsigned int channels,
+			unsigned int capacity, const Texture::Options& options = Texture::Options{});
+		~TextureArray();
+
+		TextureArray(const TextureArray&) = delete;
+		TextureArray& operator=(const TextureArray&) = delete;
+
+		inline unsigned int id() const { return m_id; }
+		inline bool isValid() const { return m_id != 0; }
+
+		inline unsigned int getWidth() const { return m_width; }
+		inline unsigned int getHeight() const { return m_height; }
+		inline unsigned int getFormat() const { return m_format; }
+		inline unsigned int capacity() const { return m_capacity; }
+		inline size_t size() const { return m_layers.size(); }
+
+		bool isCompatible(unsigned int width, unsigned int height, unsigned int channels) const;
+		bool isCompatible(const Image& image) const;
+
+		// copy the image in a new layer, the returned texture can be drawn as any other one.
+		// Returns nullptr if the image is not compatible or the array is full
+		Texture* const add(const unsigned char* const data, unsigned int width, unsigned int height, unsigned int channels);
+		Texture* const add(const Image& image);
+		Texture* const getLayer(size_t layer) const;
+
+		// the mip chain is generated again once, when the array is next bound
+		void fillSubData(unsigned int layer, int offsetX, int offsetY, int width, int height, const unsigned char* const data);
+		// after a batch of layers, if the mip chain is out of date
+		void generateMipmaps();
+
+		void bind(unsigned int slot = 0);
+		void unbind();
+		void free();
+
+	private:
+		// texture id
+		unsigned int m_id;
+		// size of every layer
+		unsigned int m_width, m_height;
+		// format of the texture object
+		unsigned int m_format;
+		unsigned int m_capacity;
+		std::vector<std::unique_ptr<Texture>> m_layers;
+		// layers were written since the mip chain was generated
+		bool m_dirty;
+	};
+}
@@ -0,0 +1,81 @@
+/// Copyright (c) Vito Domenico Tagliente
+#pragma once
+
+#include <vector>
+
+#include "image.h"
+#include "texture.h"
+#include "texture_rect.h"
+
+namespace graphics
+{
+	// Packs many small images into a few large pages, so that the sprites
+	// using them share the same texture and batch together.
+	// Images are placed with a skyline bottom-left packer and can be
+	// inserted at any time, a new page is added when no page has room
+	class TextureAtlas
+	{
+	public:
+		// where an image has been placed
+		struct Region
+		{
+			Texture* texture{ nullptr };
+			// ready to be passed to submitDrawTexture
+			TextureRect rect;
+			size_t page{ 0 };
+		};
+
+		// padding is the num of pixels around each image, filled with its extruded edges
+		TextureAtlas(unsigned int pageWidth = 2048, unsigned int pageHeight = 2048,
+			unsigned int padding = 1, const Texture::Options& options = Texture::Options{});
+		~TextureAtlas() = default;
+
+		TextureAtlas(const TextureAtlas&) = delete;
+		TextureAtlas& operator=(const TextureAtlas&) = delete;
+
+		// fails if the image, with its padding, doesn't fit in an empty page
+		bool insert(const unsigned char* const data, unsigned int width, unsigned int height, unsigned int channels, Region& region);
+		bool insert(const Image& image, Region& region);
+
+		inline unsigned int getPageWidth() const { return m_pageWidth; }
+		inline unsigned int getPageHeight() const { return m_pageHeight; }
+		inline unsigned int getPadding() const { return m_padding; }
+		inline size_t getNumOfPages() const { return m_pages.size(); }
+		Texture* const getPage(size_t page) const;
+
+		// the fraction of the page covered by images
+		float getOccupancy(size_t page) const;
+		// the fraction of all the pages covered by images
+		float getOccupancy() const;
+
+		void clear();
+
+	private:
+		// the top of the packed area, from x to x + width
+		struct SkylineNode
+		{
+			unsigned int x;
+			unsigned int y;
+			unsigned int width;
+		};
+
+		struct Page
+		{
+			TexturePtr texture;
+			std::vector<SkylineNode> skyline;
+			// pixels covered by images, padding excluded
+			size_t usedArea;
+		};
+
+		// find the lowest position for the rect, returns false if it doesn't fit
+		bool findPosition(const Page& page, unsigned int width, unsigned int height, size_t& index, unsigned int& x, unsigned int& y) const;
+		void addSkylineLevel(Page& page, size_t index, unsigned int x, unsigned int y, unsigned int width, unsigned int height);
+		Page& addPage();
+
+		unsigned int m_pageWidth;
+		unsigned int m_pageHeight;
+		unsigned int m_padding;
+		Texture::Options m_options;
+		std::vector<Page> m_pages;
+	};
+}
@@ -0,0 +1,28 @@
+/// Copyright (c) Vito Domenico Tagliente
+#pragma once
+
+#include <memory>
+
+#include "compressed_image.h"
+#include "image.h"
+
+namespace graphics
+{
+	// Compresses pixels in the block formats of CompressedImage, and
+	// decompresses them for the contexts that can't sample the format.
+	// Blocks are 4x4 RGBA8 pixels, row major. Can be called by any thread
+	class TextureCodec final
+	{
+	public:
+		// the mip chain down to 1x1 is box filtered when mipmaps is set.
+		// BC7 blocks are encoded in mode 5 or 6, ETC2 blocks in the modes shared with ETC1
+		static CompressedImage encode(const Image& image, CompressedImage::Format format, bool mipmaps = true);
+		// RGBA8 pixels of a level. The blocks in a mode the decoder lacks,
+		// the partitioned BC7 modes, are magenta
+		static std::shared_ptr<unsigned char> decode(const CompressedImage& image, size_t level);
+
+		static void encodeBlock(CompressedImage::Format format, const unsigned char* const pixels, unsigned char* const block);
+		// false if the block is in a mode the decoder lacks
+		static bool decodeBlock(CompressedImage::Format format, const unsigned char* const block, unsigned char* const pixels);
+	};
+}
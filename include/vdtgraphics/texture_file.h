@@ -0,0 +1,52 @@
+/// Copyright (c) Vito Domenico Tagliente
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+
+#include "image.h"
+
+namespace graphics
+{
+	// A .vdttex file mapped in memory: pixels decoded ahead of time with
+	// their whole mip chain, uploaded straight from the pages of the file.
+	// The mapping is released with the last file or level image referencing it
+	class TextureFile final
+	{
+	public:
+		TextureFile();
+
+		// maps the file, can be called by any thread. Invalid if the file can't be
+		// mapped, isn't a texture file or its levels aren't the chain of its size
+		static TextureFile open(const std::filesystem::path& filename);
+		// the mip chain down to 1x1 is box filtered when mipmaps is set, after the
+		// color is premultiplied by the alpha if asked. Images of 1, 3 or 4 channels only
+		static bool save(const std::filesystem::path& filename, const Image& image, bool premultiply = false, bool mipmaps = true);
+
+		inline bool isValid() const { return m_data != nullptr; }
+		// bytes of the file
+		inline size_t getSize() const { return m_size; }
+
+		int getWidth() const;
+		int getHeight() const;
+		int getChannels() const;
+		size_t getNumOfLevels() const;
+		// drawn with a source blend of One instead of SourceAlpha
+		bool isPremultiplied() const;
+		// detected once by the conversion
+		bool isOpaque() const;
+
+		// the pixels of a level in the mapped pages, copied only when written.
+		// The image keeps the file mapped
+		Image getLevel(size_t level) const;
+		const unsigned char* getLevelData(size_t level) const;
+
+		static constexpr const char* extension = ".vdttex";
+
+	private:
+		// the whole file
+		std::shared_ptr<unsigned char> m_data;
+		size_t m_size;
+	};
+}
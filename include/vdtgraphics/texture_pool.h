@@ -0,0 +1,80 @@
+/// Copyright (c) Vito Domenico Tagliente
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <vector>
+
+#include "texture.h"
+
+namespace graphics
+{
+	// Recycles transient textures by size, format and levels instead of
+	// creating and deleting them every few frames. The textures are immutable,
+	// a released one is handed out again only once the GPU is done with the
+	// frames that could have sampled it. To be used on the context thread
+	class TexturePool
+	{
+	public:
+		struct Stats
+		{
+			// acquires served by a released texture
+			size_t hits{ 0 };
+			// acquires that created a texture
+			size_t misses{ 0 };
+			// bytes of the textures held by the pool, free or waiting for the GPU
+			size_t residentBytes{ 0 };
+		};
+
+		// bytes of free textures kept at most, the oldest are deleted first
+		TexturePool(size_t budget = 64 * 1024 * 1024);
+		~TexturePool();
+
+		TexturePool(const TexturePool&) = delete;
+		TexturePool& operator= (const TexturePool&) = delete;
+
+		// a texture of the size with undefined content, the options are applied again
+		// to a recycled one. 0 levels of the options is a single level
+		TexturePtr acquire(unsigned int width, unsigned int height, unsigned int channels, const Texture::Options& options = Texture::Options{});
+		// gives the texture back at the end of the frame, the other references
+		// to it should be dropped. Layers and compressed textures are ignored.
+		// A texture released again while the pool holds it is ignored
+		void release(const TexturePtr& texture);
+
+		// fences the textures released during the frame, and frees the ones of
+		// the frames completed by the GPU. Once per frame after the draws, waits only if a fence fails
+		void update();
+		// deletes the free textures
+		void trim();
+
+		inline size_t getBudget() const { return m_budget; }
+		inline size_t getNumOfFreeTextures() const { return m_free.size(); }
+		inline const Stats& getStats() const { return m_stats; }
+		inline void resetStats() { m_stats.hits = m_stats.misses = 0; }
+
+		// bytes of all the levels of the texture
+		static size_t getSize(const Texture& texture);
+
+	private:
+		// the textures released during a frame
+		struct Frame
+		{
+			// GLsync of the frame
+			void* fence;
+			std::vector<TexturePtr> textures;
+		};
+
+		// deletes the oldest free textures over the budget
+		void evict(size_t budget);
+		// free or waiting for the GPU
+		bool contains(const TexturePtr& texture) const;
+
+		size_t m_budget;
+		// oldest first
+		std::vector<TexturePtr> m_free;
+		std::vector<TexturePtr> m_released;
+		std::deque<Frame> m_frames;
+		size_t m_freeBytes;
+		Stats m_stats;
+	};
+}
@@ -0,0 +1,111 @@
+/// Copyright (c) Vito Domenico Tagliente
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "image.h"
+
+namespace graphics
+{
+	class Texture;
+
+	// Streams pixels to textures through a ring of pixel unpack buffers.
+	// Every update copies at most a budget of bytes into the next buffer and
+	// lets the driver read them asynchronously, large uploads are split by rows
+	// across frames. A buffer is reused once the fence of its copies is signaled
+	class TextureUploader
+	{
+	public:
+		// identifies an upload, tickets grow in submission order
+		typedef uint64_t Ticket;
+
+		struct Stats
+		{
+			// bytes copied into the buffers by the last update
+			size_t stagedBytes{ 0 };
+			// updates that found the next buffer still in use by the GPU, since the last reset
+			size_t stalls{ 0 };
+		};
+
+		static constexpr size_t num_buffers = 3;
+		static constexpr Ticket invalid_ticket = 0;
+
+		// bytes staged at most by an update, each buffer is as big
+		TextureUploader(size_t budget = 4 * 1024 * 1024);
+		~TextureUploader();
+
+		TextureUploader(const TextureUploader&) = delete;
+		TextureUploader& operator= (const TextureUploader&) = delete;
+
+		// queue the copy of the pixels, tightly packed in the format of the texture,
+		// to a region of the texture. The texture must stay alive until complete,
+		// compressed textures can't be uploaded
+		Ticket upload(Texture& texture, const std::shared_ptr<unsigned char>& data, int offsetX, int offsetY, int width, int height);
+		// the whole texture
+		Ticket upload(Texture& texture, const Image& image);
+
+		// stage the pending uploads within the budget, on the context thread once per frame.
+		// Never waits for the GPU
+		void update();
+
+		// true once the GPU has read all the pixels of the upload
+		bool isComplete(Ticket ticket) const { return ticket <= m_completedTicket; }
+		inline size_t getNumOfPendingUploads() const { return m_requests.size(); }
+		inline size_t getBudget() const { return m_budget; }
+		inline const Stats& getStats() const { return m_stats; }
+		inline void resetStats() { m_stats.stalls = 0; }
+
+	private:
+		struct Request
+		{
+			Ticket ticket;
+			Texture* texture;
+			std::shared_ptr<unsigned char> data;
+			int offsetX;
+			int offsetY;
+			int width;
+			int height;
+			// rows staged so far
+			int row;
+		};
+
+		struct Slot
+		{
+			unsigned int id;
+			size_t size;
+			// GLsync of the last copies, nullptr if none
+			void* fence;
+			// the last upload fully staged in the buffer
+			Ticket ticket;
+		};
+
+		// a region of the buffer to copy into the texture
+		struct Copy
+		{
+			Texture* texture;
+			int offsetX;
+			int offsetY;
+			int width;
+			int height;
+			size_t offset;
+		};
+
+		// non blocking, true if the buffer can be written
+		bool poll(Slot& slot);
+
+		size_t m_budget;
+		std::array<Slot, num_buffers> m_slots;
+		size_t m_nextSlot;
+		std::vector<Copy> m_copies;
+		std::deque<Request> m_requests;
+		Ticket m_lastTicket;
+		// the last upload fully staged, and the last one read by the GPU
+		Ticket m_stagedTicket;
+		Ticket m_completedTicket;
+		Stats m_stats;
+	};
+}
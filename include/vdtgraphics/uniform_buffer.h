@@ -0,0 +1,36 @@
+/// Copyright (c) Vito Domenico Tagliente
+#pragma once
+
+#include <cstddef>
+
+#include "buffer.h"
+
+namespace graphics
+{
+	class UniformBuffer : public Buffer
+	{
+	public:
+		UniformBuffer(size_t size, BufferUsageMode mode = BufferUsageMode::Dynamic);
+		virtual ~UniformBuffer() override;
+
+		inline unsigned int id() const { return m_id; }
+
+		virtual void bind() override;
+		virtual void unbind() override;
+		virtual void free() override;
+		virtual void fillData(void* const data, size_t size) override;
+		virtual void fillSubData(void* const data, size_t size, int offset) override;
+
+		// give up the storage in use by the draws in flight
+		void orphan();
+		// bind a range to the block binding point, the offset must be aligned
+		void bindRange(unsigned int bindingPoint, size_t offset, size_t size);
+
+		// the alignment of the ranges bound to a binding point
+		static size_t getOffsetAlignment();
+
+	private:
+		unsigned int m_id;
+		unsigned int m_usage;
+	};
+}
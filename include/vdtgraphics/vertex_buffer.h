@@ -1,6 +1,7 @@
 /// Copyright (c) Vito Domenico Tagliente
 #pragma once
 
+#include <array>
 #include <string>
 #include <vector>
 
@@ -14,8 +15,11 @@ namespace graphics
 		{
 			Char,
 			Float,
+			HalfFloat,
 			Integer,
-			UnsignedInteger
+			UnsignedByte,
+			UnsignedInteger,
+			UnsignedShort
 		};
 
 		// the name of the element
@@ -24,7 +28,7 @@ namespace graphics
 		Type type;
 		// num of components
 		std::size_t size;
-		// if normalized
+		// if normalized, integer types not normalized are read as integers
 		bool normalized;
 		// if per instance
 		bool instanced;
@@ -42,6 +46,9 @@ namespace graphics
 			, normalized(normalized)
 			, instanced(instanced)
 		{}
+
+		// size in bytes of a component
+		std::size_t getTypeSize() const;
 	};
 
 	class VertexBufferLayout
@@ -63,13 +70,22 @@ namespace graphics
 	private:
 		// buffer elements
 		std::vector<VertexBufferElement> m_elements;
-		// layout stride
+		// layout stride in bytes
 		std::size_t m_stride;
 	};
 
 	class VertexBuffer : public Buffer
 	{
 	public:
+		// a range of the buffer, directly writable if mapped
+		struct Range
+		{
+			void* data{ nullptr };
+			size_t offset{ 0 };
+			size_t size{ 0 };
+			bool mapped{ false };
+		};
+
 		VertexBuffer(size_t size, BufferUsageMode mode = BufferUsageMode::Static);
 		virtual ~VertexBuffer() override;
 
@@ -79,11 +95,47 @@ namespace graphics
 		virtual void fillData(void* const data, size_t size) override;
 		virtual void fillSubData(void* const data, size_t size, int offset) override;
 
-		void activateLayout();
+		// point the attributes to the data starting at offset bytes
+		void activateLayout(size_t offset = 0);
+
+		// ring mode
+		inline bool isPersistent() const { return m_mapping != nullptr; }
+		// reserve a range of the persistent mapping to write into,
+		// fails if the ring is full of data not fenced yet
+		bool reserve(size_t size, Range& range);
+		// close the reserved range, keeping only the first size bytes
+		void commit(size_t size);
+		// copy the data after the last written range, orphaning the buffer when full.
+		// Persistent buffers reserve it in the ring instead, waiting for the oldest fences
+		bool stream(const void* const data, size_t size, size_t& offset);
+		// the data written so far is in use by the GPU until the fence is signaled
+		void fence();
 
 		VertexBufferLayout layout;
 
 	private:
+		struct Fence
+		{
+			// GLsync
+			void* sync;
+			// bytes of the ring released when signaled
+			size_t size;
+		};
+
+		void waitFence();
+
 		unsigned int m_id;
+		// persistent mapping
+		void* m_mapping;
+		// ring state
+		size_t m_head;
+		size_t m_used;
+		size_t m_pending;
+		Range m_reserved;
+		size_t m_reservedPadding;
+		// frames in flight
+		std::array<Fence, 8> m_fences;
+		size_t m_firstFence;
+		size_t m_numOfFences;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,52 @@
+/// Copyright (c) Vito Domenico Tagliente
+#pragma once
+
+#include <cstdint>
+
+#include <vdtmath/matrix4.h>
+#include <vdtmath/vector2.h>
+#include <vdtmath/vector3.h>
+
+#include "common.h"
+
+namespace graphics
+{
+	// Tests the bounding boxes of the draws against the view volume.
+	// Boxes are mapped to clip space by their center and extent, the test is
+	// exact for 2D cameras and conservative when the view is rotated.
+	// Only the x and y planes are tested, perspective projections are not culled
+	class VisibilityCuller
+	{
+	public:
+		// axis aligned, in world space
+		struct Bounds
+		{
+			math::vec3 center;
+			// half size
+			math::vec3 extent;
+		};
+
+		VisibilityCuller() = default;
+
+		void setViewProjectionMatrix(const math::mat4& matrix);
+
+		bool isVisible(const Bounds& bounds) const;
+		// test the boxes four at a time, writing 1 for the visible ones and 0 for the others,
+		// returns the num of visible boxes
+		size_t test(const Bounds* const bounds, size_t count, uint8_t* const visibility) const;
+		// the world area seen on the plane z = 0, false if it is unbounded
+		bool getVisibleArea(math::vec2& min, math::vec2& max) const;
+
+		static Bounds getBounds(const Vertex* const vertices, size_t numOfVertices);
+		static Bounds getBounds(const ShapeInstance& shape);
+		// the unit quad placed by the transform
+		static Bounds getBounds(const SpriteVertex& vertex);
+
+	private:
+		// the rows of the matrix producing the clip x and y
+		float m_x[4]{ 1.f, 0.f, 0.f, 0.f };
+		float m_y[4]{ 0.f, 1.f, 0.f, 0.f };
+		// false for perspective projections, everything is visible
+		bool m_affine{ false };
+	};
+}
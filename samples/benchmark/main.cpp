@@ -0,0 +1,565 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <vdtgraphics/graphics.h>
+#include <vdtmath/math.h>
+
+using namespace std;
+using namespace graphics;
+using namespace math;
+
+// count the heap allocations of the whole process
+std::atomic<size_t> allocations{ 0 };
+
+void* operator new(const size_t size)
+{
+	++allocations;
+	if (void* const pointer = std::malloc(size == 0 ? 1 : size))
+	{
+		return pointer;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* const pointer) noexcept
+{
+	std::free(pointer);
+}
+
+void operator delete(void* const pointer, size_t) noexcept
+{
+	std::free(pointer);
+}
+
+std::unique_ptr<Context> context;
+std::unique_ptr<Renderer> renderer;
+
+Font font;
+TexturePtr circleTexture;
+TexturePtr potatoeTexture;
+TexturePtr squareTexture;
+
+// run the function and return the elapsed time in nanoseconds
+long long measure(const std::function<void()>& function)
+{
+	const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+	function();
+	const std::chrono::steady_clock::time_point endTime = std::chrono::steady_clock::now();
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime).count();
+}
+
+void report(const std::string& name, const int count, const long long elapsedTime)
+{
+	std::cout << std::left << std::setw(24) << name
+		<< " submissions[" << std::setw(8) << count << "]"
+		<< " total[" << std::setw(10) << elapsedTime / 1000 << "µs]"
+		<< " per submit[" << static_cast<double>(elapsedTime) / count << "ns]"
+		<< std::endl;
+}
+
+// sprites interleaved with shapes and text, the worst case for batching
+void submitInterleaved(DrawSubmitter& submitter, const int count)
+{
+	const float s = 1.f / 11;
+	for (int i = 0; i < count; ++i)
+	{
+		const math::vec3 position(static_cast<float>(i % 40 - 20), static_cast<float>(i % 30 - 15), 0.f);
+		switch (i % 8)
+		{
+		case 0: submitter.submitDrawRect(ShapeRenderStyle::fill, position, 1.f, 1.f, Color::Magenta); break;
+		case 1: submitter.submitDrawLine(position, Color::Red, position + math::vec3(1.f, 1.f, 0.f), Color::Yellow); break;
+		case 2: submitter.submitDrawText(&font, "a", position); break;
+		case 3: submitter.submitDrawTexture(circleTexture.get(), position); break;
+		case 4: submitter.submitDrawTexture(squareTexture.get(), position); break;
+		default: submitter.submitDrawTexture(potatoeTexture.get(), position, TextureRect(s * 9, s * (i % 5), s, s)); break;
+		}
+	}
+}
+
+void benchmarkSubmit(const int count)
+{
+	const long long elapsedTime = measure([count]() { submitInterleaved(*renderer, count); });
+	report("submit (interleaved)", count, elapsedTime);
+	renderer->clear(Color::Black);
+}
+
+// compare the draw calls of a frame with and without sorting
+void benchmarkSorting(const int count)
+{
+	for (const bool sorting : { false, true })
+	{
+		renderer->setSortingEnabled(sorting);
+		renderer->clear(Color::Black);
+		const long long elapsedTime = measure([count]()
+			{
+				submitInterleaved(*renderer, count);
+				renderer->flush();
+			}
+		);
+		report(sorting ? "submit + flush (sorted)" : "submit + flush", count, elapsedTime);
+		std::cout << "    draw calls[" << renderer->stats.drawCalls << "]" << std::endl;
+	}
+	renderer->setSortingEnabled(false);
+	renderer->clear(Color::Black);
+}
+
+// sprites only, streamed with each instance format
+void benchmarkSpriteFormat(const int count)
+{
+	for (const SpriteFormat format : { SpriteFormat::Standard, SpriteFormat::Compact })
+	{
+		renderer->setSpriteFormat(format);
+		renderer->clear(Color::Black);
+		const long long elapsedTime = measure([count]()
+			{
+				for (int i = 0; i < count; ++i)
+				{
+					const math::vec3 position(static_cast<float>(i % 40 - 20), static_cast<float>(i % 30 - 15), 0.f);
+					renderer->submitDrawTexture(i % 2 ? circleTexture.get() : squareTexture.get(), position, static_cast<float>(i));
+				}
+				renderer->flush();
+			}
+		);
+		const bool compact = format == SpriteFormat::Compact;
+		report(compact ? "sprites (compact)" : "sprites (standard)", count, elapsedTime);
+		std::cout << "    instance data[" << getInstanceSize(format) * count / 1024 << "KB]" << std::endl;
+	}
+	renderer->setSpriteFormat(SpriteFormat::Standard);
+	renderer->clear(Color::Black);
+}
+
+// static sprites, retained in a layer or submitted every frame
+void benchmarkSpriteLayer(const int count)
+{
+	SpriteLayer layer(count);
+	std::vector<SpriteLayer::Handle> handles;
+	for (int i = 0; i < count; ++i)
+	{
+		const math::vec3 position(static_cast<float>(i % 40 - 20), static_cast<float>(i % 30 - 15), 0.f);
+		handles.push_back(layer.add(i % 2 ? circleTexture.get() : squareTexture.get(), position));
+	}
+
+	for (const int changes : { 0, 100 })
+	{
+		// the first frame uploads the whole layer
+		renderer->clear(Color::Black);
+		renderer->submit(layer);
+		renderer->flush();
+
+		renderer->clear(Color::Black);
+		const long long elapsedTime = measure([count, changes, &layer, &handles]()
+			{
+				for (int i = 0; i < changes; ++i)
+				{
+					layer.update(handles[(i * 7919) % count], math::matrix4::translate(math::vec3(static_cast<float>(i % 40 - 20), 0.f, 0.f)));
+				}
+				renderer->submit(layer);
+				renderer->flush();
+			}
+		);
+		report("layer (" + std::to_string(changes) + " changes)", count, elapsedTime);
+		std::cout << "    draw calls[" << renderer->stats.drawCalls << "] uploaded[" << layer.getUploadedBytes() << "B]" << std::endl;
+	}
+	renderer->clear(Color::Black);
+}
+
+// hundreds of tile textures, as separate textures or as the layers of an array
+void benchmarkTextureArray(const int count)
+{
+	constexpr unsigned int numOfTiles = 256;
+	constexpr unsigned int tileSize = 16;
+	std::vector<unsigned char> pixels(tileSize * tileSize * 4);
+
+	std::vector<std::unique_ptr<Texture>> textures;
+	TextureArray textureArray(tileSize, tileSize, 4, numOfTiles);
+	std::vector<Texture*> layers;
+	for (unsigned int i = 0; i < numOfTiles; ++i)
+	{
+		std::fill(pixels.begin(), pixels.end(), static_cast<unsigned char>(i));
+		textures.push_back(std::make_unique<Texture>(&pixels[0], tileSize, tileSize, 4));
+		layers.push_back(textureArray.add(&pixels[0], tileSize, tileSize, 4));
+	}
+
+	for (const bool useArray : { false, true })
+	{
+		renderer->clear(Color::Black);
+		const long long elapsedTime = measure([count, useArray, &textures, &layers]()
+			{
+				for (int i = 0; i < count; ++i)
+				{
+					const math::vec3 position(static_cast<float>(i % 40 - 20), static_cast<float>(i % 30 - 15), 0.f);
+					Texture* const texture = useArray ? layers[i % numOfTiles] : textures[i % numOfTiles].get();
+					renderer->submitDrawTexture(texture, position);
+				}
+				renderer->flush();
+			}
+		);
+		report(useArray ? "tiles (texture array)" : "tiles (textures)", count, elapsedTime);
+		std::cout << "    draw calls[" << renderer->stats.drawCalls << "]" << std::endl;
+	}
+	renderer->clear(Color::Black);
+}
+
+// tile textures as separate textures or packed in the pages of an atlas
+void benchmarkAtlas(const int count)
+{
+	constexpr unsigned int numOfTiles = 256;
+	std::vector<std::unique_ptr<Texture>> textures;
+	std::vector<TextureAtlas::Region> regions;
+	TextureAtlas atlas(512, 512);
+	for (unsigned int i = 0; i < numOfTiles; ++i)
+	{
+		// tiles of different sizes
+		const unsigned int size = 8 + (i * 7) % 25;
+		std::vector<unsigned char> pixels(size * size * 4, static_cast<unsigned char>(i));
+		textures.push_back(std::make_unique<Texture>(&pixels[0], size, size, 4));
+		TextureAtlas::Region region;
+		if (atlas.insert(&pixels[0], size, size, 4, region))
+		{
+			regions.push_back(region);
+		}
+	}
+
+	std::cout << "atlas pages[" << atlas.getNumOfPages() << "] occupancy[" << atlas.getOccupancy() * 100.f << "%]" << std::endl;
+
+	for (const bool useAtlas : { false, true })
+	{
+		renderer->clear(Color::Black);
+		const long long elapsedTime = measure([count, useAtlas, &textures, &regions]()
+			{
+				for (int i = 0; i < count; ++i)
+				{
+					const math::vec3 position(static_cast<float>(i % 40 - 20), static_cast<float>(i % 30 - 15), 0.f);
+					if (useAtlas)
+					{
+						const TextureAtlas::Region& region = regions[i % regions.size()];
+						renderer->submitDrawTexture(region.texture, position, region.rect);
+					}
+					else
+					{
+						renderer->submitDrawTexture(textures[i % textures.size()].get(), position);
+					}
+				}
+				renderer->flush();
+			}
+		);
+		report(useAtlas ? "tiles (atlas)" : "tiles (textures)", count, elapsedTime);
+		std::cout << "    draw calls[" << renderer->stats.drawCalls << "]" << std::endl;
+	}
+	renderer->clear(Color::Black);
+}
+
+// record the same frame from many threads, merged by the renderer at flush
+void benchmarkCommandLists(const int count)
+{
+	const unsigned int numOfThreads = std::max(std::thread::hardware_concurrency(), 2u);
+	std::vector<CommandList> commandLists;
+	for (unsigned int i = 0; i < numOfThreads; ++i)
+	{
+		commandLists.emplace_back(static_cast<int>(i));
+	}
+
+	for (const bool sorting : { false, true })
+	{
+		renderer->setSortingEnabled(sorting);
+		renderer->clear(Color::Black);
+		const long long elapsedTime = measure([count, numOfThreads, &commandLists]()
+			{
+				std::vector<std::thread> threads;
+				for (unsigned int i = 0; i < numOfThreads; ++i)
+				{
+					threads.emplace_back([count, numOfThreads, &commandList = commandLists[i]]()
+						{
+							commandList.clear();
+							submitInterleaved(commandList, count / static_cast<int>(numOfThreads));
+							renderer->submit(commandList);
+						}
+					);
+				}
+				for (std::thread& thread : threads)
+				{
+					thread.join();
+				}
+				renderer->flush();
+			}
+		);
+		report(sorting ? "threads + flush (sorted)" : "threads + flush", count, elapsedTime);
+		std::cout << "    threads[" << numOfThreads << "] draw calls[" << renderer->stats.drawCalls << "]" << std::endl;
+	}
+	renderer->setSortingEnabled(false);
+	renderer->clear(Color::Black);
+}
+
+// a large texture uploaded at once from client memory, or streamed through the uploader
+void benchmarkTextureStreaming(const int size)
+{
+	const size_t numOfBytes = static_cast<size_t>(size) * size * 4;
+	std::shared_ptr<unsigned char> pixels(new unsigned char[numOfBytes](), std::default_delete<unsigned char[]>());
+	Texture texture(nullptr, size, size, 4);
+
+	const long long directTime = measure([&texture, &pixels, size]()
+		{
+			texture.fillSubData(0, 0, size, size, pixels.get());
+		}
+	);
+	std::cout << "texture upload (direct)  size[" << size << "] total[" << directTime / 1000 << "µs]" << std::endl;
+
+	TextureUploader uploader;
+	const TextureUploader::Ticket ticket = uploader.upload(texture, pixels, 0, 0, size, size);
+	int frames = 0;
+	long long worstTime = 0;
+	while (!uploader.isComplete(ticket))
+	{
+		worstTime = std::max(worstTime, measure([&uploader]() { uploader.update(); }));
+		renderer->clear(Color::Black);
+		renderer->flush();
+		++frames;
+	}
+	std::cout << "texture upload (stream)  size[" << size << "] frames[" << frames << "]"
+		<< " worst frame[" << worstTime / 1000 << "µs]" << std::endl;
+}
+
+// cold load of a texture: decoding the png and generating the mips,
+// or mapping the converted file and uploading its mip chain
+void benchmarkTextureLoading(const std::string& filename)
+{
+	const std::string convertedFilename = "benchmark" + std::string(TextureFile::extension);
+	TextureFile::save(convertedFilename, Image::load(filename));
+
+	constexpr int iterations = 10;
+	const long long pngTime = measure([&filename]()
+		{
+			for (int i = 0; i < iterations; ++i)
+			{
+				Texture texture(Image::load(filename));
+			}
+			glFinish();
+		}
+	);
+	const long long fileTime = measure([&convertedFilename]()
+		{
+			for (int i = 0; i < iterations; ++i)
+			{
+				Texture texture(TextureFile::open(convertedFilename));
+			}
+			glFinish();
+		}
+	);
+
+	std::cout << "texture load (png)       per load[" << pngTime / iterations / 1000 << "µs]" << std::endl;
+	std::cout << "texture load (vdttex)    per load[" << fileTime / iterations / 1000 << "µs]"
+		<< " bytes[" << TextureFile::open(convertedFilename).getSize() << "]" << std::endl;
+	std::remove(convertedFilename.c_str());
+}
+
+// transient textures of a frame created and deleted every time, or recycled by a pool
+void benchmarkTexturePool(const int frames)
+{
+	constexpr int texturesPerFrame = 8;
+	const long long createTime = measure([frames]()
+		{
+			for (int frame = 0; frame < frames; ++frame)
+			{
+				for (int i = 0; i < texturesPerFrame; ++i)
+				{
+					Texture texture(nullptr, 512 + 64 * (i % 4), 256, 4);
+				}
+				glFlush();
+			}
+			glFinish();
+		}
+	);
+
+	TexturePool pool;
+	const long long poolTime = measure([&pool, frames]()
+		{
+			for (int frame = 0; frame < frames; ++frame)
+			{
+				for (int i = 0; i < texturesPerFrame; ++i)
+				{
+					pool.release(pool.acquire(512 + 64 * (i % 4), 256, 4));
+				}
+				pool.update();
+				glFlush();
+			}
+			glFinish();
+		}
+	);
+
+	const TexturePool::Stats& stats = pool.getStats();
+	std::cout << "transient textures (new)  frames[" << frames << "] per frame[" << createTime / frames / 1000 << "µs]" << std::endl;
+	std::cout << "transient textures (pool) frames[" << frames << "] per frame[" << poolTime / frames / 1000 << "µs]"
+		<< " hits[" << stats.hits << "] misses[" << stats.misses << "] resident bytes[" << stats.residentBytes << "]" << std::endl;
+}
+
+// time to create the programs of a renderer, from the sources or from the program cache
+void benchmarkStartup()
+{
+	ProgramCache cache(".");
+	// start from an empty cache
+	for (const auto& pair : ShaderLibrary().getShaders())
+	{
+		cache.remove(pair.first);
+	}
+
+	// the programs are compiled on first use, the loading screen prewarms them all
+	const auto& startup = [](ProgramCache* const programCache, const bool prewarm)
+	{
+		return measure([programCache, prewarm]()
+			{
+				Renderer startupRenderer;
+				startupRenderer.init(context.get(), programCache);
+				if (prewarm)
+				{
+					startupRenderer.prewarm();
+					while (!startupRenderer.isPrewarmed())
+					{
+						std::this_thread::yield();
+					}
+				}
+				glFinish();
+			}
+		);
+	};
+
+	const long long lazyTime = startup(nullptr, false);
+	const long long sourceTime = startup(nullptr, true);
+	const long long coldTime = startup(&cache, true);
+	const ProgramCache::Stats coldStats = cache.getStats();
+	cache.resetStats();
+	const long long warmTime = startup(&cache, true);
+	const ProgramCache::Stats warmStats = cache.getStats();
+
+	std::cout << "startup (lazy)           total[" << lazyTime / 1000 << "µs]" << std::endl;
+	std::cout << "startup (sources)        total[" << sourceTime / 1000 << "µs]"
+		<< (ShaderProgram::isParallelCompileSupported() ? " parallel compile" : "") << std::endl;
+	std::cout << "startup (cold cache)     total[" << coldTime / 1000 << "µs]"
+		<< " misses[" << coldStats.misses << "]" << std::endl;
+	std::cout << "startup (warm cache)     total[" << warmTime / 1000 << "µs]"
+		<< " hits[" << warmStats.hits << "] rejected[" << warmStats.rejected << "]"
+		<< (ProgramCache::isSupported() ? "" : " program binaries not supported") << std::endl;
+}
+
+// a frame must not allocate once the renderer has seen it before
+void benchmarkAllocations(const int count)
+{
+	for (const bool sorting : { false, true })
+	{
+		renderer->setSortingEnabled(sorting);
+		// warm up
+		for (int frame = 0; frame < 3; ++frame)
+		{
+			renderer->clear(Color::Black);
+			submitInterleaved(*renderer, count);
+			renderer->flush();
+		}
+
+		const size_t startAllocations = allocations;
+		renderer->clear(Color::Black);
+		submitInterleaved(*renderer, count);
+		renderer->flush();
+		std::cout << "steady frame" << (sorting ? " (sorted)" : "")
+			<< " submissions[" << count << "]"
+			<< " heap allocations[" << allocations - startAllocations << "]" << std::endl;
+	}
+	renderer->setSortingEnabled(false);
+	renderer->clear(Color::Black);
+}
+
+int main(void)
+{
+	if (!glfwInit())
+		return -1;
+
+	// the benchmark doesn't need to present anything
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+	GLFWwindow* window = glfwCreateWindow(720, 480, "vdtgraphics benchmark", NULL, NULL);
+	if (!window)
+	{
+		glfwTerminate();
+		return -1;
+	}
+
+	glfwMakeContextCurrent(window);
+
+	context = std::make_unique<Context>();
+	if (context->initialize() != Context::State::Initialized)
+	{
+		glfwTerminate();
+		return -1;
+	}
+
+	benchmarkStartup();
+
+	renderer = std::make_unique<Renderer>();
+	renderer->init(context.get());
+
+	circleTexture = std::make_unique<Texture>(Image::load("../../../assets/circle.png"));
+	potatoeTexture = std::make_unique<Texture>(Image::load("../../../assets/spritesheet.png"));
+	squareTexture = std::make_unique<Texture>(Image::load("../../../assets/square.png"));
+	font = Font::load("../../../assets/font.ttf");
+
+	for (const int count : { 1000, 10000, 100000, 1000000 })
+	{
+		benchmarkSubmit(count);
+	}
+
+	for (const int count : { 1000, 10000 })
+	{
+		benchmarkSorting(count);
+	}
+
+	for (const int count : { 10000, 100000 })
+	{
+		benchmarkSpriteFormat(count);
+	}
+
+	for (const int count : { 10000, 100000 })
+	{
+		benchmarkSpriteLayer(count);
+	}
+
+	for (const int count : { 10000, 100000 })
+	{
+		benchmarkTextureArray(count);
+	}
+
+	for (const int count : { 10000, 100000 })
+	{
+		benchmarkAtlas(count);
+	}
+
+	for (const int count : { 10000, 100000 })
+	{
+		benchmarkCommandLists(count);
+	}
+
+	benchmarkAllocations(10000);
+
+	for (const int size : { 1024, 4096 })
+	{
+		benchmarkTextureStreaming(size);
+	}
+
+	benchmarkTextureLoading("../../../assets/spritesheet.png");
+	benchmarkTexturePool(200);
+
+	renderer->uninit();
+	glfwTerminate();
+	return 0;
+}
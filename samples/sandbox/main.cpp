@@ -174,7 +174,13 @@ void testCase1()
 	renderer->submitDrawRect(ShapeRenderStyle::fill, math::vec3::zero, 10.f, 10.f, Color::Magenta);
 	renderer->submitDrawRect(ShapeRenderStyle::stroke, math::vec3(-5.4f, 5.3f, 0.0f), 5.f, 5.f, Color::Green);
 	renderer->submitDrawCircle(ShapeRenderStyle::stroke, math::vec3::zero, 15.f, Color::Yellow);
+	renderer->submitDrawCircle(math::vec3(12.f, -8.f, 0.f), 3.f, Color::Blue, 0.5f, Color::White);
+	renderer->submitDrawEllipse(math::vec3(-12.f, -8.f, 0.f), math::vec2(4.f, 2.f), Color::Red);
+	renderer->submitDrawRoundedRect(math::vec3(0.f, -12.f, 0.f), math::vec2(8.f, 4.f), 1.f, Color::Cyan, 0.25f, Color::Black);
 	renderer->submitDrawLine(math::vec3(-10.f, -10.f, 0.f), Color::Red, math::vec3(10.f, 10.f, 0.f), Color::Yellow);
+	renderer->submitDrawPolyline({ math::vec3(-14.f, 8.f, 0.f), math::vec3(-10.f, 12.f, 0.f), math::vec3(-6.f, 8.f, 0.f), math::vec3(-2.f, 12.f, 0.f) }, 0.5f, Color::White, LineJoin::Round, LineCap::Round);
+	renderer->submitDrawPolygon({ math::vec3(6.f, 6.f, 0.f), math::vec3(14.f, 6.f, 0.f), math::vec3(14.f, 14.f, 0.f), math::vec3(10.f, 10.f, 0.f), math::vec3(6.f, 14.f, 0.f) },
+		{ { math::vec3(7.f, 7.f, 0.f), math::vec3(8.f, 7.f, 0.f), math::vec3(8.f, 8.f, 0.f) } }, Color::Green);
 	renderer->submitDrawTexture(potatoeTexture.get(), math::vec3::zero);
 	renderer->submitDrawTexture(circleTexture.get(), math::vec3::zero, math::vec3(10.f, 10.f, 1.f), {}, Color::Cyan);
 	renderer->submitDrawTexture(squareTexture.get(), math::vec3(5.f, 5.f, 0.f), math::vec3(5.f, 5.f, 1.f), {}, Color::Green);
@@ -0,0 +1,197 @@
+#include <vdtgraphics/asset_loader.h>
+
+#include <algorithm>
+#include <memory>
+
+namespace graphics
+{
+	AssetLoader::AssetLoader(size_t numOfThreads)
+		: m_threads()
+		, m_tasks()
+		, m_tasksMutex()
+		, m_tasksCondition()
+		, m_stopping(false)
+		, m_uploads()
+		, m_uploadsMutex()
+		, m_uploadsCondition()
+		, m_numOfPendingLoads(0)
+	{
+		if (numOfThreads == 0)
+		{
+			const size_t cores = std::thread::hardware_concurrency();
+			numOfThreads = std::max<size_t>(cores > 1 ? cores - 1 : 1, 1);
+		}
+
+		for (size_t i = 0; i < numOfThreads; ++i)
+		{
+			m_threads.emplace_back(&AssetLoader::work, this);
+		}
+	}
+
+	AssetLoader::~AssetLoader()
+	{
+		// the requests not completed yet are dropped, their futures report a broken promise
+		{
+			std::lock_guard<std::mutex> lock(m_tasksMutex);
+			m_stopping = true;
+		}
+		m_tasksCondition.notify_all();
+		for (std::thread& thread : m_threads)
+		{
+			thread.join();
+		}
+	}
+
+	std::shared_future<Image> AssetLoader::loadImage(const std::filesystem::path& filename, const bool flipVertically)
+	{
+		const auto promise = std::make_shared<std::promise<Image>>();
+		std::shared_future<Image> future = promise->get_future().share();
+
+		++m_numOfPendingLoads;
+		schedule([this, promise, filename, flipVertically]()
+			{
+				promise->set_value(Image::load(filename, flipVertically));
+				{
+					std::lock_guard<std::mutex> lock(m_uploadsMutex);
+					--m_numOfPendingLoads;
+				}
+				m_uploadsCondition.notify_all();
+			}
+		);
+		return future;
+	}
+
+	std::shared_future<TexturePtr> AssetLoader::loadTexture(const std::filesystem::path& filename, const Texture::Options& options, const bool flipVertically)
+	{
+		const auto promise = std::make_shared<std::promise<TexturePtr>>();
+		std::shared_future<TexturePtr> future = promise->get_future().share();
+
+		++m_numOfPendingLoads;
+		schedule([this, promise, filename, options, flipVertically]()
+			{
+				// converted files are mapped, their pixels are read by the upload
+				if (filename.extension() == TextureFile::extension)
+				{
+					const TextureFile file = TextureFile::open(filename);
+					scheduleUpload([promise, file, options]()
+						{
+							promise->set_value(file.isValid() ? std::make_shared<Texture>(file, options) : nullptr);
+						}
+					);
+					return;
+				}
+
+				const Image image = Image::load(filename, flipVertically);
+				scheduleUpload([promise, image, options]()
+					{
+						promise->set_value(image.data != nullptr ? std::make_shared<Texture>(image, options) : nullptr);
+					}
+				);
+			}
+		);
+		return future;
+	}
+
+	std::shared_future<Font> AssetLoader::loadFont(const std::filesystem::path& filename)
+	{
+		const auto promise = std::make_shared<std::promise<Font>>();
+		std::shared_future<Font> future = promise->get_future().share();
+
+		++m_numOfPendingLoads;
+		schedule([this, promise, filename]()
+			{
+				// the atlas stays empty if the font can't be rasterized, create returns an invalid font
+				const auto atlas = std::make_shared<Image>();
+				const auto data = std::make_shared<std::map<char, Glyph>>();
+				Font::rasterize(filename, *atlas, *data);
+				scheduleUpload([promise, atlas, data, filename]()
+					{
+						promise->set_value(Font::create(*atlas, *data, filename));
+					}
+				);
+			}
+		);
+		return future;
+	}
+
+	size_t AssetLoader::update(const size_t maxUploads)
+	{
+		size_t numOfUploads = 0;
+		while (numOfUploads < maxUploads)
+		{
+			std::function<void()> upload;
+			{
+				std::lock_guard<std::mutex> lock(m_uploadsMutex);
+				if (m_uploads.empty()) break;
+
+				upload = std::move(m_uploads.front());
+				m_uploads.pop_front();
+			}
+
+			upload();
+			++numOfUploads;
+			{
+				std::lock_guard<std::mutex> lock(m_uploadsMutex);
+				--m_numOfPendingLoads;
+			}
+		}
+		return numOfUploads;
+	}
+
+	void AssetLoader::finish()
+	{
+		std::unique_lock<std::mutex> lock(m_uploadsMutex);
+		while (m_numOfPendingLoads > 0)
+		{
+			m_uploadsCondition.wait(lock, [this]()
+				{
+					return !m_uploads.empty() || m_numOfPendingLoads == 0;
+				}
+			);
+
+			const size_t numOfUploads = m_uploads.size();
+			lock.unlock();
+			update(numOfUploads);
+			lock.lock();
+		}
+	}
+
+	void AssetLoader::work()
+	{
+		while (true)
+		{
+			std::function<void()> task;
+			{
+				std::unique_lock<std::mutex> lock(m_tasksMutex);
+				m_tasksCondition.wait(lock, [this]()
+					{
+						return m_stopping || !m_tasks.empty();
+					}
+				);
+				if (m_stopping) return;
+
+				task = std::move(m_tasks.front());
+				m_tasks.pop_front();
+			}
+			task();
+		}
+	}
+
+	void AssetLoader::schedule(std::function<void()>&& task)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_tasksMutex);
+			m_tasks.push_back(std::move(task));
+		}
+		m_tasksCondition.notify_one();
+	}
+
+	void AssetLoader::scheduleUpload(std::function<void()>&& upload)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_uploadsMutex);
+			m_uploads.push_back(std::move(upload));
+		}
+		m_uploadsCondition.notify_all();
+	}
+}
@@ -0,0 +1,68 @@
+#include <vdtgraphics/camera_buffer.h>
+
+#include <cstring>
+
+namespace graphics
+{
+	static_assert(sizeof(CameraBuffer::Block) == 3 * 64 + 16, "the camera block must match the std140 layout");
+
+	CameraBuffer::CameraBuffer(const size_t capacity)
+		: m_capacity(capacity > 0 ? capacity : 1)
+		, m_stride()
+		, m_buffer()
+		, m_data()
+		, m_numOfCameras(0)
+		, m_numOfUploadedCameras(0)
+		, m_orphan(false)
+	{
+		const size_t alignment = UniformBuffer::getOffsetAlignment();
+		m_stride = (sizeof(Block) + alignment - 1) / alignment * alignment;
+		m_buffer = std::make_unique<UniformBuffer>(m_capacity * m_stride, BufferUsageMode::Dynamic);
+		m_data.resize(m_capacity * m_stride);
+	}
+
+	uint32_t CameraBuffer::push(const Block& block)
+	{
+		if (m_numOfCameras == m_capacity)
+		{
+			// the cameras bound so far are uploaded again with the new storage
+			m_capacity *= 2;
+			m_data.resize(m_capacity * m_stride);
+			m_buffer = std::make_unique<UniformBuffer>(m_capacity * m_stride, BufferUsageMode::Dynamic);
+			m_numOfUploadedCameras = 0;
+			m_orphan = false;
+		}
+
+		std::memcpy(&m_data[m_numOfCameras * m_stride], &block, sizeof(Block));
+		return static_cast<uint32_t>(m_numOfCameras++);
+	}
+
+	void CameraBuffer::upload()
+	{
+		if (m_numOfUploadedCameras == m_numOfCameras) return;
+
+		m_buffer->bind();
+		if (m_orphan)
+		{
+			m_buffer->orphan();
+			m_orphan = false;
+		}
+
+		const size_t offset = m_numOfUploadedCameras * m_stride;
+		m_buffer->fillSubData(&m_data[offset], (m_numOfCameras - m_numOfUploadedCameras) * m_stride, static_cast<int>(offset));
+		m_numOfUploadedCameras = m_numOfCameras;
+	}
+
+	void CameraBuffer::bind(const uint32_t index)
+	{
+		m_buffer->bindRange(binding_point, index * m_stride, sizeof(Block));
+	}
+
+	void CameraBuffer::clear()
+	{
+		// the cameras of the last frame may be still in use
+		m_orphan = m_numOfUploadedCameras > 0;
+		m_numOfCameras = 0;
+		m_numOfUploadedCameras = 0;
+	}
+}
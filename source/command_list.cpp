@@ -0,0 +1,76 @@
+#include <vdtgraphics/command_list.h>
+
+#include <atomic>
+
+#include <vdtgraphics/font.h>
+#include <vdtgraphics/texture.h>
+
+namespace graphics
+{
+	namespace
+	{
+		std::atomic<uint64_t> next_creation_index{ 0 };
+	}
+
+	CommandList::CommandList(const int order)
+		: DrawSubmitter()
+		, m_order(order)
+		, m_creationIndex(next_creation_index++)
+		, m_queue()
+		, m_shapes()
+		, m_vertices()
+		, m_shapeInstances()
+		, m_shapeStrips()
+		, m_indices()
+		, m_texts()
+		, m_sprites()
+	{
+	}
+
+	void CommandList::clear()
+	{
+		m_queue.clear();
+		m_shapes.clear();
+		m_vertices.clear();
+		m_shapeInstances.clear();
+		m_shapeStrips.clear();
+		m_indices.clear();
+		m_texts.clear();
+		m_sprites.clear();
+	}
+
+	void CommandList::pushShape(const ShapeRenderStyle style, const Vertex* const vertices, const size_t numOfVertices)
+	{
+		const Pipeline pipeline = style == ShapeRenderStyle::fill ? Pipeline::ShapeFill : Pipeline::ShapeStroke;
+		m_queue.push(RenderQueue::makeKey(m_layer, static_cast<uint8_t>(pipeline), 0, 0), static_cast<uint32_t>(m_shapes.size()));
+		m_shapes.push_back({ style, m_vertices.size(), numOfVertices });
+		m_vertices.insert(m_vertices.end(), vertices, vertices + numOfVertices);
+	}
+
+	void CommandList::pushShapeInstance(const ShapeInstance& shape)
+	{
+		m_queue.push(RenderQueue::makeKey(m_layer, static_cast<uint8_t>(Pipeline::ShapeInstance), 0, 0), static_cast<uint32_t>(m_shapeInstances.size()));
+		m_shapeInstances.push_back(shape);
+	}
+
+	void CommandList::pushShapeStrip(const Vertex* const vertices, const size_t numOfVertices, const uint32_t* const indices, const size_t numOfIndices)
+	{
+		m_queue.push(RenderQueue::makeKey(m_layer, static_cast<uint8_t>(Pipeline::ShapeStrip), 0, 0), static_cast<uint32_t>(m_shapeStrips.size()));
+		m_shapeStrips.push_back({ m_vertices.size(), numOfVertices, m_indices.size(), numOfIndices });
+		m_vertices.insert(m_vertices.end(), vertices, vertices + numOfVertices);
+		m_indices.insert(m_indices.end(), indices, indices + numOfIndices);
+	}
+
+	void CommandList::pushGlyph(const SpriteVertex& vertex, Font* const font)
+	{
+		const uint32_t textureSet = font->texture ? font->texture->id() : 0;
+		m_queue.push(RenderQueue::makeKey(m_layer, static_cast<uint8_t>(Pipeline::Text), 0, textureSet), static_cast<uint32_t>(m_texts.size()));
+		m_texts.push_back({ vertex, font });
+	}
+
+	void CommandList::pushSprite(const SpriteVertex& vertex, Texture* const texture)
+	{
+		m_queue.push(RenderQueue::makeKey(m_layer, static_cast<uint8_t>(Pipeline::Texture), 0, texture->id()), static_cast<uint32_t>(m_sprites.size()));
+		m_sprites.push_back({ vertex, texture });
+	}
+}
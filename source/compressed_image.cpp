@@ -0,0 +1,219 @@
+#include <vdtgraphics/compressed_image.h>
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+#include <glad/glad.h>
+
+#include <vdtgraphics/context.h>
+#include <vdtgraphics/texture.h>
+
+namespace graphics
+{
+	namespace
+	{
+		// EXT_texture_compression_s3tc, not in the core profile
+		constexpr unsigned int GL_COMPRESSED_RGB_S3TC_DXT1 = 0x83F0;
+		constexpr unsigned int GL_COMPRESSED_RGBA_S3TC_DXT5 = 0x83F3;
+
+		constexpr uint8_t ktx_identifier[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x31, 0x31, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+		constexpr uint32_t ktx_endianness = 0x04030201;
+
+		struct KtxHeader
+		{
+			uint8_t identifier[12];
+			uint32_t endianness;
+			uint32_t glType;
+			uint32_t glTypeSize;
+			uint32_t glFormat;
+			uint32_t glInternalFormat;
+			uint32_t glBaseInternalFormat;
+			uint32_t pixelWidth;
+			uint32_t pixelHeight;
+			uint32_t pixelDepth;
+			uint32_t numberOfArrayElements;
+			uint32_t numberOfFaces;
+			uint32_t numberOfMipmapLevels;
+			uint32_t bytesOfKeyValueData;
+		};
+
+		constexpr CompressedImage::Format formats[] = {
+			CompressedImage::Format::BC1,
+			CompressedImage::Format::BC3,
+			CompressedImage::Format::BC7,
+			CompressedImage::Format::ETC2_RGB,
+			CompressedImage::Format::ETC2_RGBA
+		};
+
+		bool findFormat(const unsigned int glFormat, CompressedImage::Format& format)
+		{
+			for (const CompressedImage::Format candidate : formats)
+			{
+				if (CompressedImage::getGLFormat(candidate) == glFormat)
+				{
+					format = candidate;
+					return true;
+				}
+			}
+			return false;
+		}
+	}
+
+	CompressedImage::CompressedImage()
+		: format(Format::BC1)
+		, width()
+		, height()
+		, levels()
+		, data()
+	{
+	}
+
+	CompressedImage::CompressedImage(const Format format, const int width, const int height, const std::vector<Level>& levels, const std::shared_ptr<unsigned char>& data)
+		: format(format)
+		, width(width)
+		, height(height)
+		, levels(levels)
+		, data(data)
+	{
+	}
+
+	CompressedImage CompressedImage::load(const std::filesystem::path& filename)
+	{
+		std::ifstream input(filename, std::ios::binary);
+		if (!input.is_open()) return CompressedImage();
+
+		KtxHeader header{};
+		input.read(reinterpret_cast<char*>(&header), sizeof(KtxHeader));
+
+		Format format;
+		if (!input
+			|| std::memcmp(header.identifier, ktx_identifier, sizeof(ktx_identifier)) != 0
+			|| header.endianness != ktx_endianness
+			|| header.pixelDepth > 1 || header.numberOfArrayElements > 0 || header.numberOfFaces != 1
+			|| header.pixelWidth == 0 || header.pixelHeight == 0
+			|| header.pixelWidth > INT_MAX || header.pixelHeight > INT_MAX
+			|| header.numberOfMipmapLevels > Texture::getMaxNumOfLevels(header.pixelWidth, header.pixelHeight)
+			|| !findFormat(header.glInternalFormat, format))
+		{
+			return CompressedImage();
+		}
+		input.seekg(header.bytesOfKeyValueData, std::ios::cur);
+
+		const int width = static_cast<int>(header.pixelWidth);
+		const int height = static_cast<int>(header.pixelHeight);
+		const size_t numOfLevels = std::max<size_t>(header.numberOfMipmapLevels, 1);
+
+		// the levels are packed, their sizes are multiples of 4 and need no padding
+		std::vector<Level> levels;
+		size_t size = 0;
+		for (size_t i = 0; i < numOfLevels; ++i)
+		{
+			const int levelWidth = std::max(width >> i, 1);
+			const int levelHeight = std::max(height >> i, 1);
+			const size_t levelSize = getLevelSize(format, levelWidth, levelHeight);
+			levels.push_back({ levelWidth, levelHeight, size, levelSize });
+			size += levelSize;
+		}
+
+		std::shared_ptr<unsigned char> data(new unsigned char[size], std::default_delete<unsigned char[]>());
+		for (const Level& level : levels)
+		{
+			uint32_t imageSize = 0;
+			input.read(reinterpret_cast<char*>(&imageSize), sizeof(uint32_t));
+			if (!input || imageSize != level.size) return CompressedImage();
+
+			input.read(reinterpret_cast<char*>(data.get() + level.offset), level.size);
+			if (!input) return CompressedImage();
+		}
+		return CompressedImage(format, width, height, levels, data);
+	}
+
+	bool CompressedImage::save(const std::filesystem::path& filename) const
+	{
+		if (!isValid()) return false;
+
+		std::ofstream output(filename, std::ios::binary | std::ios::trunc);
+		if (!output.is_open()) return false;
+
+		KtxHeader header{};
+		std::memcpy(header.identifier, ktx_identifier, sizeof(ktx_identifier));
+		header.endianness = ktx_endianness;
+		header.glTypeSize = 1;
+		header.glInternalFormat = getGLFormat(format);
+		header.glBaseInternalFormat = hasAlpha(format) ? GL_RGBA : GL_RGB;
+		header.pixelWidth = static_cast<uint32_t>(width);
+		header.pixelHeight = static_cast<uint32_t>(height);
+		header.numberOfFaces = 1;
+		header.numberOfMipmapLevels = static_cast<uint32_t>(levels.size());
+		output.write(reinterpret_cast<const char*>(&header), sizeof(KtxHeader));
+
+		for (const Level& level : levels)
+		{
+			const uint32_t imageSize = static_cast<uint32_t>(level.size);
+			output.write(reinterpret_cast<const char*>(&imageSize), sizeof(uint32_t));
+			output.write(reinterpret_cast<const char*>(data.get() + level.offset), level.size);
+		}
+		return static_cast<bool>(output);
+	}
+
+	size_t CompressedImage::getBlockSize(const Format format)
+	{
+		switch (format)
+		{
+		case Format::BC1:
+		case Format::ETC2_RGB:
+			return 8;
+		case Format::BC3:
+		case Format::BC7:
+		case Format::ETC2_RGBA:
+		default:
+			return 16;
+		}
+	}
+
+	size_t CompressedImage::getLevelSize(const Format format, const int width, const int height)
+	{
+		const size_t numOfBlocksX = (static_cast<size_t>(width) + 3) / 4;
+		const size_t numOfBlocksY = (static_cast<size_t>(height) + 3) / 4;
+		return numOfBlocksX * numOfBlocksY * getBlockSize(format);
+	}
+
+	bool CompressedImage::hasAlpha(const Format format)
+	{
+		return format != Format::BC1 && format != Format::ETC2_RGB;
+	}
+
+	unsigned int CompressedImage::getGLFormat(const Format format)
+	{
+		switch (format)
+		{
+		case Format::BC1: return GL_COMPRESSED_RGB_S3TC_DXT1;
+		case Format::BC3: return GL_COMPRESSED_RGBA_S3TC_DXT5;
+		case Format::BC7: return GL_COMPRESSED_RGBA_BPTC_UNORM;
+		case Format::ETC2_RGB: return GL_COMPRESSED_RGB8_ETC2;
+		case Format::ETC2_RGBA:
+		default:
+			return GL_COMPRESSED_RGBA8_ETC2_EAC;
+		}
+	}
+
+	bool CompressedImage::isSupported(const Format format)
+	{
+		switch (format)
+		{
+		case Format::BC1:
+		case Format::BC3:
+			return Context::hasExtension("GL_EXT_texture_compression_s3tc");
+		case Format::BC7:
+			return GLAD_GL_VERSION_4_2 || Context::hasExtension("GL_ARB_texture_compression_bptc");
+		case Format::ETC2_RGB:
+		case Format::ETC2_RGBA:
+		default:
+			return GLAD_GL_VERSION_4_3 || Context::hasExtension("GL_ARB_ES3_compatibility");
+		}
+	}
+}
@@ -1,5 +1,9 @@
 #include "vdtgraphics/context.h"
 
+#include <algorithm>
+#include <string>
+#include <vector>
+
 #include <glad/glad.h>
 
 namespace graphics
@@ -11,11 +15,41 @@ namespace graphics
 			m_state = gladLoadGL() ? State::Initialized : State::Error;
 			if (m_state == State::Initialized)
 			{
-				glEnable(GL_BLEND);
-				glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-				glEnable(GL_DEPTH_TEST);
+				GLStateCache::makeCurrent(&m_stateCache);
+				m_stateCache.setBlendEnabled(true);
+				m_stateCache.setBlendFunction(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+				m_stateCache.setDepthTestEnabled(true);
+				m_stateCache.setDepthMask(true);
 			}
 		}
 		return m_state;
 	}
+
+	bool Context::hasExtension(const char* const name)
+	{
+		// looked up once, the extensions don't change with the context
+		static const std::vector<std::string> extensions = []()
+		{
+			std::vector<std::string> result;
+			int numOfExtensions = 0;
+			glGetIntegerv(GL_NUM_EXTENSIONS, &numOfExtensions);
+			for (int i = 0; i < numOfExtensions; ++i)
+			{
+				const GLubyte* const extension = glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i));
+				if (extension == nullptr) continue;
+
+				result.push_back(reinterpret_cast<const char*>(extension));
+			}
+			return result;
+		}();
+		return std::find(extensions.begin(), extensions.end(), name) != extensions.end();
+	}
+
+	Context::~Context()
+	{
+		if (&GLStateCache::get() == &m_stateCache)
+		{
+			GLStateCache::makeCurrent(nullptr);
+		}
+	}
 }
\ No newline at end of file
@@ -0,0 +1,183 @@
+#include <vdtgraphics/draw_submitter.h>
+
+#include <vdtgraphics/font.h>
+
+namespace graphics
+{
+	namespace
+	{
+		ShapeInstance makeShape(const ShapeType type, const ShapeRenderStyle style, const math::vec3& position, const math::vec2& extent, const Color& color)
+		{
+			if (style == ShapeRenderStyle::fill)
+			{
+				return { type, position, extent, 0.f, 0.f, 0.f, false, color, Color::Transparent };
+			}
+			return { type, position, extent, 0.f, 0.f, 1.f, true, Color::Transparent, color };
+		}
+	}
+
+	void DrawSubmitter::submitDrawCircle(const ShapeRenderStyle style, const math::vec3& position, const float radius, const Color& color)
+	{
+		pushShapeInstance(makeShape(ShapeType::Circle, style, position, math::vec2(radius * 2, radius * 2), color));
+	}
+
+	void DrawSubmitter::submitDrawCircle(const math::vec3& position, const float radius, const Color& fillColor, const float strokeWidth, const Color& strokeColor)
+	{
+		pushShapeInstance({ ShapeType::Circle, position, math::vec2(radius * 2, radius * 2), 0.f, 0.f, strokeWidth, false, fillColor, strokeColor });
+	}
+
+	void DrawSubmitter::submitDrawEllipse(const math::vec3& position, const math::vec2& radii, const Color& fillColor, const float strokeWidth, const Color& strokeColor)
+	{
+		pushShapeInstance({ ShapeType::Ellipse, position, radii * 2, 0.f, 0.f, strokeWidth, false, fillColor, strokeColor });
+	}
+
+	void DrawSubmitter::submitDrawLine(const math::vec3& point1, const Color& color1, const math::vec3& point2, const Color& color2)
+	{
+		const Vertex vertices[] = {
+			{ point1, color1 },
+			{ point2, color2 }
+		};
+		submitDrawShape(ShapeRenderStyle::stroke, vertices, 2);
+	}
+
+	void DrawSubmitter::submitDrawPolyline(const std::vector<math::vec3>& points, const float width, const Color& color, const LineJoin join, const LineCap cap, const bool closed)
+	{
+		submitDrawPolyline(points.data(), points.size(), width, color, join, cap, closed);
+	}
+
+	void DrawSubmitter::submitDrawPolyline(const math::vec3* const points, const size_t numOfPoints, const float width, const Color& color, const LineJoin join, const LineCap cap, const bool closed)
+	{
+		PolylineTessellator::Style style;
+		style.width = width;
+		style.join = join;
+		style.cap = cap;
+		style.closed = closed;
+		if (!m_polylineTessellator.begin(points, numOfPoints, style, color)) return;
+
+		// long polylines come in more strips
+		while (m_polylineTessellator.next())
+		{
+			const std::vector<Vertex>& vertices = m_polylineTessellator.getVertices();
+			const std::vector<uint32_t>& indices = m_polylineTessellator.getIndices();
+			pushShapeStrip(vertices.data(), vertices.size(), indices.data(), indices.size());
+		}
+	}
+
+	void DrawSubmitter::submitDrawPolygon(const std::vector<math::vec3>& outline, const Color& color)
+	{
+		submitDrawPolygon(outline.data(), outline.size(), color);
+	}
+
+	void DrawSubmitter::submitDrawPolygon(const math::vec3* const points, const size_t numOfPoints, const Color& color)
+	{
+		fillPolygon(points, &numOfPoints, 1, color);
+	}
+
+	void DrawSubmitter::submitDrawPolygon(const std::vector<math::vec3>& outline, const std::vector<std::vector<math::vec3>>& holes, const Color& color)
+	{
+		if (holes.empty())
+		{
+			submitDrawPolygon(outline, color);
+			return;
+		}
+
+		// the rings one after the other
+		m_polygonPoints.assign(outline.begin(), outline.end());
+		m_polygonRingEnds.clear();
+		m_polygonRingEnds.push_back(m_polygonPoints.size());
+		for (const std::vector<math::vec3>& hole : holes)
+		{
+			m_polygonPoints.insert(m_polygonPoints.end(), hole.begin(), hole.end());
+			m_polygonRingEnds.push_back(m_polygonPoints.size());
+		}
+		fillPolygon(m_polygonPoints.data(), m_polygonRingEnds.data(), m_polygonRingEnds.size(), color);
+	}
+
+	void DrawSubmitter::fillPolygon(const math::vec3* const points, const size_t* const ringEnds, const size_t numOfRings, const Color& color)
+	{
+		const std::vector<uint32_t>& indices = m_polygonTriangulator.triangulate(points, ringEnds, numOfRings);
+		if (indices.empty()) return;
+
+		m_polygonVertices.clear();
+		m_polygonVertices.reserve(indices.size());
+		for (const uint32_t index : indices)
+		{
+			m_polygonVertices.push_back({ points[index], color });
+		}
+		pushShape(ShapeRenderStyle::fill, m_polygonVertices.data(), m_polygonVertices.size());
+	}
+
+	void DrawSubmitter::submitDrawShape(const ShapeRenderStyle style, const std::vector<Vertex>& vertices)
+	{
+		submitDrawShape(style, vertices.data(), vertices.size());
+	}
+
+	void DrawSubmitter::submitDrawShape(const ShapeRenderStyle style, const Vertex* const vertices, const size_t numOfVertices)
+	{
+		if (vertices == nullptr || numOfVertices == 0) return;
+
+		pushShape(style, vertices, numOfVertices);
+	}
+
+	void DrawSubmitter::submitDrawRect(const ShapeRenderStyle style, const math::vec3& position, const float width, const float height, const Color& color)
+	{
+		pushShapeInstance(makeShape(ShapeType::Rect, style, position, math::vec2(width, height), color));
+	}
+
+	void DrawSubmitter::submitDrawRoundedRect(const math::vec3& position, const math::vec2& size, const float radius, const Color& fillColor, const float strokeWidth, const Color& strokeColor)
+	{
+		const ShapeType type = radius > 0.f ? ShapeType::RoundedRect : ShapeType::Rect;
+		pushShapeInstance({ type, position, size, 0.f, radius, strokeWidth, false, fillColor, strokeColor });
+	}
+
+	void DrawSubmitter::submitDrawShape(const ShapeInstance& shape)
+	{
+		pushShapeInstance(shape);
+	}
+
+	void DrawSubmitter::submitDrawText(Font* const font, const std::string& text, const math::vec3& position, const float scale, const Color& color)
+	{
+		if (text.empty() || font == nullptr) return;
+
+		float x = position.x;
+		for (const char c : text)
+		{
+			const auto& it = font->data.find(c);
+			if (it == font->data.end()) continue;
+
+			const Glyph& glyph = it->second;
+			const float x_pos = x + glyph.bearing.x * scale;
+			const float y_pos = position.y + (glyph.size.y - glyph.bearing.y) * scale;
+			pushGlyph({ math::matrix4::scale(math::vec3(glyph.size.x, glyph.size.y, 1.f) * scale) * math::matrix4::translate(math::vec3(x_pos, y_pos, position.z)), color, glyph.rect }, font);
+
+			x += scale * 0.25f + glyph.advance * scale;
+		}
+	}
+
+	void DrawSubmitter::submitDrawTexture(Texture* const texture, const math::mat4& transform, const TextureRect& rect, const Color& color)
+	{
+		if (texture == nullptr) return;
+
+		pushSprite({ transform, color, rect }, texture);
+	}
+
+	void DrawSubmitter::submitDrawTexture(Texture* const texture, const math::vec3& position, const TextureRect& rect, const Color& color)
+	{
+		submitDrawTexture(texture, math::matrix4::translate(position), rect, color);
+	}
+
+	void DrawSubmitter::submitDrawTexture(Texture* const texture, const math::vec3& position, const float rotation, const TextureRect& rect, const Color& color)
+	{
+		submitDrawTexture(texture, math::matrix4::translate(position) * math::matrix4::rotate_z(rotation), rect, color);
+	}
+
+	void DrawSubmitter::submitDrawTexture(Texture* const texture, const math::vec3& position, const math::vec3& scale, const TextureRect& rect, const Color& color)
+	{
+		submitDrawTexture(texture, math::matrix4::scale(scale) * math::matrix4::translate(position), rect, color);
+	}
+
+	void DrawSubmitter::submitDrawTexture(Texture* const texture, const math::vec3& position, const float rotation, const math::vec3& scale, const TextureRect& rect, const Color& color)
+	{
+		submitDrawTexture(texture, math::matrix4::scale(scale) * math::matrix4::rotate_z(rotation) * math::matrix4::translate(position), rect, color);
+	}
+}
\ No newline at end of file
@@ -1,5 +1,8 @@
 #include <vdtgraphics/font.h>
 
+#include <algorithm>
+#include <mutex>
+
 #include <glad/glad.h>
 
 #include <ft2build.h>
@@ -9,12 +12,26 @@ namespace graphics
 {
 	namespace
 	{
+		// faces are created and destroyed under the lock, a face is used by one thread only
 		struct Context
 		{
+			Context()
+				: data()
+				, ready(FT_Init_FreeType(&data) == 0)
+				, mutex()
+			{
+			}
+
 			FT_Library data;
-			bool initialized = false;
-			bool ready = false;
+			bool ready;
+			std::mutex mutex;
 		};
+
+		Context& getContext()
+		{
+			static Context context;
+			return context;
+		}
 	}
 
 	Font::Font()
@@ -44,19 +61,27 @@ namespace graphics
 
 	Font Font::load(const std::filesystem::path& path)
 	{
-		static Context context;
-
-		if (!context.initialized)
+		Image atlas;
+		std::map<char, Glyph> data;
+		if (!rasterize(path, atlas, data))
 		{
-			context.ready = FT_Init_FreeType(&context.data) == 0;
+			return Font(nullptr, {}, path);
 		}
+		return create(atlas, data, path);
+	}
 
-		if (!context.ready) return Font(nullptr, {}, path);
+	bool Font::rasterize(const std::filesystem::path& path, Image& atlas, std::map<char, Glyph>& data)
+	{
+		Context& context = getContext();
+		if (!context.ready) return false;
 
 		FT_Face face;
-		if (FT_New_Face(context.data, path.string().c_str(), 0, &face) != 0)
 		{
-			return Font(nullptr, {}, path);
+			std::lock_guard<std::mutex> lock(context.mutex);
+			if (FT_New_Face(context.data, path.string().c_str(), 0, &face) != 0)
+			{
+				return false;
+			}
 		}
 		FT_Set_Pixel_Sizes(face, 0, font_size);
 
@@ -76,17 +101,13 @@ namespace graphics
 
 		if (atlas_width == 0 || atlas_height == 0)
 		{
-			return Font(nullptr, {}, path);
+			std::lock_guard<std::mutex> lock(context.mutex);
+			FT_Done_Face(face);
+			return false;
 		}
 
-		Texture::Options options;
-		options.wrapS = GL_CLAMP_TO_EDGE;
-		options.wrapT = GL_CLAMP_TO_EDGE;
-		options.filterMin = GL_LINEAR;
-		options.filterMax = GL_LINEAR;
-		TexturePtr texture = std::make_shared<Texture>(nullptr, atlas_width, atlas_height, 1);
-
-		std::map<char, Glyph> data;
+		std::shared_ptr<unsigned char> pixels(new unsigned char[static_cast<size_t>(atlas_width) * atlas_height](), std::default_delete<unsigned char[]>());
+		data.clear();
 
 		int x_pos = 0;
 		for (unsigned char c = 32; c < num_glyphs; c++)
@@ -97,24 +118,48 @@ namespace graphics
 				continue;
 			}
 
+			const FT_Bitmap& bitmap = face->glyph->bitmap;
 			Glyph glyph = {
 				// advance
 				static_cast<float>(face->glyph->advance.x / 64) / font_size,
 				// bearing
 				math::vec2(static_cast<float>(face->glyph->bitmap_left) / font_size, static_cast<float>(face->glyph->bitmap_top) / font_size),
 				// texture rect
-				TextureRect(static_cast<float>(x_pos) / atlas_width, 0.f, static_cast<float>(face->glyph->bitmap.width) / atlas_width, 1.f),
+				TextureRect(static_cast<float>(x_pos) / atlas_width, 0.f, static_cast<float>(bitmap.width) / atlas_width, 1.f),
 				// size
-				math::vec2(static_cast<float>(face->glyph->bitmap.width) / font_size, static_cast<float>(face->glyph->bitmap.rows) / font_size)
+				math::vec2(static_cast<float>(bitmap.width) / font_size, static_cast<float>(bitmap.rows) / font_size)
 			};
 			data.insert(std::pair<char, Glyph>(c, glyph));
 
-			texture->fillSubData(x_pos, 0, face->glyph->bitmap.width, face->glyph->bitmap.rows, face->glyph->bitmap.buffer);
-			x_pos += face->glyph->bitmap.width;
+			for (unsigned int row = 0; row < bitmap.rows; ++row)
+			{
+				std::copy_n(bitmap.buffer + static_cast<ptrdiff_t>(row) * bitmap.pitch, bitmap.width,
+					pixels.get() + static_cast<size_t>(row) * atlas_width + x_pos);
+			}
+			x_pos += bitmap.width;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(context.mutex);
+			FT_Done_Face(face);
 		}
 
-		FT_Done_Face(face);
+		atlas = Image(pixels, atlas_width, atlas_height, 1);
+		return true;
+	}
+
+	Font Font::create(const Image& atlas, const std::map<char, Glyph>& data, const std::filesystem::path& path)
+	{
+		if (atlas.data == nullptr) return Font(nullptr, {}, path);
 
+		// the glyphs are packed edge to edge, a repeat or a mip would sample the neighbours.
+		// The coverage is read as alpha, never opaque
+		Texture::Options options;
+		options.wrapS = GL_CLAMP_TO_EDGE;
+		options.wrapT = GL_CLAMP_TO_EDGE;
+		options.opacity = Texture::Opacity::Translucent;
+		options.levels = 1;
+		TexturePtr texture = std::make_shared<Texture>(atlas, options);
 		return Font(std::move(texture), data, path);
 	}
 
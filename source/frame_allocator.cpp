@@ -0,0 +1,75 @@
+#include <vdtgraphics/frame_allocator.h>
+
+#include <algorithm>
+#include <cstdint>
+
+namespace graphics
+{
+	FrameAllocator::FrameAllocator(const size_t capacity)
+		: m_blocks()
+		, m_destructors(nullptr)
+		, m_size(0)
+	{
+		addBlock(capacity);
+	}
+
+	FrameAllocator::~FrameAllocator()
+	{
+		reset();
+	}
+
+	void* FrameAllocator::allocate(const size_t size, const size_t alignment)
+	{
+		const auto& align = [alignment](Block& block) -> size_t
+		{
+			const uintptr_t address = reinterpret_cast<uintptr_t>(block.data.get()) + block.offset;
+			return block.offset + ((alignment - (address % alignment)) % alignment);
+		};
+
+		size_t offset = align(m_blocks.back());
+		if (offset + size > m_blocks.back().capacity)
+		{
+			addBlock(std::max(m_blocks.back().capacity * 2, size + alignment));
+			offset = align(m_blocks.back());
+		}
+
+		Block& block = m_blocks.back();
+		m_size += offset + size - block.offset;
+		block.offset = offset + size;
+		return block.data.get() + offset;
+	}
+
+	void FrameAllocator::reset()
+	{
+		// objects are destroyed in reverse order of creation
+		for (Destructor* destructor = m_destructors; destructor != nullptr; destructor = destructor->next)
+		{
+			destructor->function(destructor->object);
+		}
+		m_destructors = nullptr;
+
+		if (m_blocks.size() > 1)
+		{
+			const size_t totalCapacity = capacity();
+			m_blocks.clear();
+			addBlock(totalCapacity);
+		}
+		m_blocks.back().offset = 0;
+		m_size = 0;
+	}
+
+	size_t FrameAllocator::capacity() const
+	{
+		size_t result = 0;
+		for (const Block& block : m_blocks)
+		{
+			result += block.capacity;
+		}
+		return result;
+	}
+
+	void FrameAllocator::addBlock(const size_t capacity)
+	{
+		m_blocks.push_back({ std::make_unique<unsigned char[]>(capacity), capacity, 0 });
+	}
+}
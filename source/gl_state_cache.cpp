@@ -0,0 +1,275 @@
+#include <vdtgraphics/gl_state_cache.h>
+
+#include <glad/glad.h>
+
+namespace graphics
+{
+	namespace
+	{
+		constexpr unsigned int unknown_id = ~0u;
+		constexpr int unknown_flag = -1;
+
+		GLStateCache* s_current = nullptr;
+	}
+
+	GLStateCache::GLStateCache()
+		: m_program()
+		, m_vertexArray()
+		, m_buffers()
+		, m_uniformBufferRanges()
+		, m_activeTextureUnit()
+		, m_textures()
+		, m_framebuffer()
+		, m_viewport()
+		, m_blend()
+		, m_blendFunction()
+		, m_depthTest()
+		, m_depthMask()
+		, m_stats()
+	{
+		invalidate();
+	}
+
+	template <typename T>
+	bool GLStateCache::update(T& current, const T& value)
+	{
+		if (current == value)
+		{
+			++m_stats.skipped;
+			return false;
+		}
+
+		current = value;
+		++m_stats.issued;
+		return true;
+	}
+
+	GLStateCache& GLStateCache::get()
+	{
+		// objects created before the context is initialized go through a cache of their own
+		static GLStateCache detached;
+		return s_current != nullptr ? *s_current : detached;
+	}
+
+	void GLStateCache::makeCurrent(GLStateCache* const cache)
+	{
+		s_current = cache;
+	}
+
+	void GLStateCache::useProgram(const unsigned int id)
+	{
+		if (update(m_program, id))
+		{
+			glUseProgram(id);
+		}
+	}
+
+	void GLStateCache::bindVertexArray(const unsigned int id)
+	{
+		if (update(m_vertexArray, id))
+		{
+			glBindVertexArray(id);
+			// the element buffer is part of the vertex array
+			m_buffers[getBufferSlot(GL_ELEMENT_ARRAY_BUFFER)] = unknown_id;
+		}
+	}
+
+	void GLStateCache::bindBuffer(const unsigned int target, const unsigned int id)
+	{
+		const size_t slot = getBufferSlot(target);
+		if (slot >= num_buffer_slots)
+		{
+			++m_stats.issued;
+			glBindBuffer(target, id);
+		}
+		else if (update(m_buffers[slot], id))
+		{
+			glBindBuffer(target, id);
+		}
+	}
+
+	void GLStateCache::bindUniformBufferRange(const unsigned int index, const unsigned int id, const size_t offset, const size_t size)
+	{
+		if (index >= max_uniform_buffer_bindings)
+		{
+			++m_stats.issued;
+		}
+		else if (!update(m_uniformBufferRanges[index], { id, offset, size }))
+		{
+			return;
+		}
+
+		glBindBufferRange(GL_UNIFORM_BUFFER, index, id, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(size));
+		// the generic binding point is changed too
+		m_buffers[getBufferSlot(GL_UNIFORM_BUFFER)] = id;
+	}
+
+	void GLStateCache::setActiveTextureUnit(const unsigned int unit)
+	{
+		if (update(m_activeTextureUnit, unit))
+		{
+			glActiveTexture(GL_TEXTURE0 + unit);
+		}
+	}
+
+	void GLStateCache::bindTexture(const unsigned int target, const unsigned int id)
+	{
+		const size_t slot = getTextureSlot(target);
+		if (m_activeTextureUnit >= max_texture_units || slot >= num_texture_slots)
+		{
+			++m_stats.issued;
+			glBindTexture(target, id);
+		}
+		else if (update(m_textures[m_activeTextureUnit][slot], id))
+		{
+			glBindTexture(target, id);
+		}
+	}
+
+	void GLStateCache::bindTexture(const unsigned int unit, const unsigned int target, const unsigned int id)
+	{
+		// switch unit only if the binding changes
+		const size_t slot = getTextureSlot(target);
+		if (unit < max_texture_units && slot < num_texture_slots && m_textures[unit][slot] == id)
+		{
+			++m_stats.skipped;
+			return;
+		}
+
+		setActiveTextureUnit(unit);
+		bindTexture(target, id);
+	}
+
+	void GLStateCache::bindFramebuffer(const unsigned int id)
+	{
+		if (update(m_framebuffer, id))
+		{
+			glBindFramebuffer(GL_FRAMEBUFFER, id);
+		}
+	}
+
+	void GLStateCache::setViewport(const int x, const int y, const int width, const int height)
+	{
+		if (update(m_viewport, { x, y, width, height }))
+		{
+			glViewport(x, y, width, height);
+		}
+	}
+
+	void GLStateCache::setBlendEnabled(const bool enabled)
+	{
+		if (update(m_blend, enabled ? 1 : 0))
+		{
+			if (enabled) glEnable(GL_BLEND);
+			else glDisable(GL_BLEND);
+		}
+	}
+
+	void GLStateCache::setBlendFunction(const unsigned int source, const unsigned int destination)
+	{
+		if (update(m_blendFunction, { source, destination }))
+		{
+			glBlendFunc(source, destination);
+		}
+	}
+
+	void GLStateCache::setDepthTestEnabled(const bool enabled)
+	{
+		if (update(m_depthTest, enabled ? 1 : 0))
+		{
+			if (enabled) glEnable(GL_DEPTH_TEST);
+			else glDisable(GL_DEPTH_TEST);
+		}
+	}
+
+	void GLStateCache::setDepthMask(const bool enabled)
+	{
+		if (update(m_depthMask, enabled ? 1 : 0))
+		{
+			glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+		}
+	}
+
+	void GLStateCache::onProgramDeleted(const unsigned int id)
+	{
+		if (m_program == id) m_program = unknown_id;
+	}
+
+	void GLStateCache::onVertexArrayDeleted(const unsigned int id)
+	{
+		if (m_vertexArray == id)
+		{
+			m_vertexArray = unknown_id;
+			m_buffers[getBufferSlot(GL_ELEMENT_ARRAY_BUFFER)] = unknown_id;
+		}
+	}
+
+	void GLStateCache::onBufferDeleted(const unsigned int id)
+	{
+		for (unsigned int& buffer : m_buffers)
+		{
+			if (buffer == id) buffer = unknown_id;
+		}
+		for (BufferRange& range : m_uniformBufferRanges)
+		{
+			if (range.id == id) range.id = unknown_id;
+		}
+	}
+
+	void GLStateCache::onTextureDeleted(const unsigned int id)
+	{
+		for (auto& unit : m_textures)
+		{
+			for (unsigned int& texture : unit)
+			{
+				if (texture == id) texture = unknown_id;
+			}
+		}
+	}
+
+	void GLStateCache::onFramebufferDeleted(const unsigned int id)
+	{
+		if (m_framebuffer == id) m_framebuffer = unknown_id;
+	}
+
+	void GLStateCache::invalidate()
+	{
+		m_program = unknown_id;
+		m_vertexArray = unknown_id;
+		m_buffers.fill(unknown_id);
+		m_uniformBufferRanges.fill({ unknown_id, 0, 0 });
+		m_activeTextureUnit = unknown_id;
+		for (auto& unit : m_textures)
+		{
+			unit.fill(unknown_id);
+		}
+		m_framebuffer = unknown_id;
+		m_viewport = { 0, 0, unknown_flag, unknown_flag };
+		m_blend = unknown_flag;
+		m_blendFunction.fill(unknown_id);
+		m_depthTest = unknown_flag;
+		m_depthMask = unknown_flag;
+	}
+
+	size_t GLStateCache::getBufferSlot(const unsigned int target)
+	{
+		switch (target)
+		{
+		case GL_ARRAY_BUFFER: return 0;
+		case GL_ELEMENT_ARRAY_BUFFER: return 1;
+		case GL_PIXEL_UNPACK_BUFFER: return 2;
+		case GL_UNIFORM_BUFFER: return 3;
+		default: return num_buffer_slots;
+		}
+	}
+
+	size_t GLStateCache::getTextureSlot(const unsigned int target)
+	{
+		switch (target)
+		{
+		case GL_TEXTURE_2D: return 0;
+		case GL_TEXTURE_2D_ARRAY: return 1;
+		default: return num_texture_slots;
+		}
+	}
+}
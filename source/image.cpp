@@ -1,9 +1,26 @@
 #include <vdtgraphics/image.h>
+
+#include <algorithm>
+
+// the failure reason is a global written by every load, images are decoded by many threads
+#define STBI_NO_FAILURE_STRINGS
 #define STB_IMAGE_IMPLEMENTATION
 #include <vdtgraphics/stb_image.h>
 
 namespace graphics
 {
+	namespace
+	{
+		void flipRows(unsigned char* const data, const int width, const int height, const int channels)
+		{
+			const size_t stride = static_cast<size_t>(width) * static_cast<size_t>(channels);
+			for (int top = 0, bottom = height - 1; top < bottom; ++top, --bottom)
+			{
+				std::swap_ranges(data + top * stride, data + (top + 1) * stride, data + bottom * stride);
+			}
+		}
+	}
+
 	bool Image::flip_vertically = false;
 
 	Image::Image()
@@ -37,11 +54,67 @@ namespace graphics
 
 	Image Image::load(const std::filesystem::path& filename)
 	{
-		// stbi_set_flip_vertically_on_load(1);
+		return load(filename, flip_vertically);
+	}
+
+	Image Image::load(const std::filesystem::path& filename, const bool flipVertically)
+	{
+		// the flip setting of stb is global, the rows are flipped here instead
 		int width, height, channels;
-		stbi_set_flip_vertically_on_load(flip_vertically);
-		std::shared_ptr<unsigned char> data(stbi_load(filename.string().c_str(), &width, &height, &channels, 4));
-		return Image(data, width, height, channels);
+		std::shared_ptr<unsigned char> data(stbi_load(filename.string().c_str(), &width, &height, &channels, 4), stbi_image_free);
+		if (data != nullptr && flipVertically)
+		{
+			flipRows(data.get(), width, height, 4);
+		}
+		// the pixels are expanded to RGBA whatever the channels of the file
+		return Image(data, width, height, 4);
+	}
+
+	bool Image::isOpaque() const
+	{
+		return isOpaque(data.get(), width, height, channels);
+	}
+
+	bool Image::isOpaque(const unsigned char* const data, const int width, const int height, const int channels)
+	{
+		if (data == nullptr) return false;
+		if (channels != 4) return true;
+
+		const size_t numOfPixels = static_cast<size_t>(width) * static_cast<size_t>(height);
+		for (size_t i = 0; i < numOfPixels; ++i)
+		{
+			// between the discarded pixels and the opaque ones
+			const unsigned char alpha = data[i * 4 + 3];
+			if (alpha >= 128 && alpha < 255) return false;
+		}
+		return true;
+	}
+
+	Image Image::createMipmap() const
+	{
+		if (data == nullptr) return Image();
+
+		const int nextWidth = std::max(width / 2, 1);
+		const int nextHeight = std::max(height / 2, 1);
+		std::shared_ptr<unsigned char> result(new unsigned char[static_cast<size_t>(nextWidth) * nextHeight * channels], std::default_delete<unsigned char[]>());
+		const unsigned char* const pixels = data.get();
+		for (int y = 0; y < nextHeight; ++y)
+		{
+			const size_t row0 = static_cast<size_t>(std::min(y * 2, height - 1)) * width;
+			const size_t row1 = static_cast<size_t>(std::min(y * 2 + 1, height - 1)) * width;
+			for (int x = 0; x < nextWidth; ++x)
+			{
+				const size_t column0 = std::min(x * 2, width - 1);
+				const size_t column1 = std::min(x * 2 + 1, width - 1);
+				for (int c = 0; c < channels; ++c)
+				{
+					const int sum = pixels[(row0 + column0) * channels + c] + pixels[(row0 + column1) * channels + c]
+						+ pixels[(row1 + column0) * channels + c] + pixels[(row1 + column1) * channels + c];
+					result.get()[(static_cast<size_t>(y) * nextWidth + x) * channels + c] = static_cast<unsigned char>((sum + 2) / 4);
+				}
+			}
+		}
+		return Image(result, nextWidth, nextHeight, channels);
 	}
 
 	Image& Image::operator=(const Image& other)
@@ -1,12 +1,17 @@
 #include <vdtgraphics/index_buffer.h>
 
+#include <cstring>
+
 #include <glad/glad.h>
 
+#include <vdtgraphics/gl_state_cache.h>
+
 namespace graphics
 {
 	IndexBuffer::IndexBuffer(const size_t size, const BufferUsageMode mode)
 		: Buffer(size, mode)
 		, m_id()
+		, m_head(0)
 	{
 		GLenum usage = 0;
 		switch (mode)
@@ -35,16 +40,17 @@ namespace graphics
 
 	void IndexBuffer::bind()
 	{
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_id);
+		GLStateCache::get().bindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_id);
 	}
 
 	void IndexBuffer::unbind()
 	{
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+		GLStateCache::get().bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 	}
 
 	void IndexBuffer::free()
 	{
+		GLStateCache::get().onBufferDeleted(m_id);
 		glDeleteBuffers(1, &m_id);
 	}
 
@@ -57,4 +63,32 @@ namespace graphics
 	{
 		glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, offset, size, data);
 	}
+
+	bool IndexBuffer::stream(const void* const data, const size_t size, size_t& offset)
+	{
+		if (size > this->size()) return false;
+
+		// indices are read at their own alignment
+		offset = (m_head + 3) & ~static_cast<size_t>(3);
+		if (offset + size > this->size())
+		{
+			// orphan the storage, the driver keeps the old one alive for the draws in flight
+			glBufferData(GL_ELEMENT_ARRAY_BUFFER, this->size(), nullptr, GL_STREAM_DRAW);
+			offset = 0;
+		}
+
+		void* const mapping = glMapBufferRange(GL_ELEMENT_ARRAY_BUFFER, offset, size,
+			GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+		if (mapping == nullptr)
+		{
+			glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, offset, size, data);
+		}
+		else
+		{
+			std::memcpy(mapping, data, size);
+			glUnmapBuffer(GL_ELEMENT_ARRAY_BUFFER);
+		}
+		m_head = offset + size;
+		return true;
+	}
 }
\ No newline at end of file
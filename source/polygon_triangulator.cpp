@@ -0,0 +1,595 @@
+#include <vdtgraphics/polygon_triangulator.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <deque>
+#include <limits>
+
+namespace graphics
+{
+	namespace
+	{
+		// Ear clipping on a doubly linked ring of points.
+		// When no ear is found, the ring is cleaned up, local self intersections
+		// are cured and then it is split in two along a valid diagonal
+		class EarClipper
+		{
+		public:
+			EarClipper(const math::vec3* const points, std::vector<uint32_t>& indices)
+				: m_points(points)
+				, m_indices(indices)
+				, m_nodes()
+			{
+			}
+
+			void triangulate(const size_t* const ringEnds, const size_t numOfRings)
+			{
+				Node* outer = createRing(0, ringEnds[0], true);
+				if (outer == nullptr || outer->next == outer->prev) return;
+
+				if (numOfRings > 1)
+				{
+					outer = eliminateHoles(ringEnds, numOfRings, outer);
+				}
+				clip(outer, 0);
+			}
+
+		private:
+			struct Node
+			{
+				uint32_t index;
+				float x;
+				float y;
+				Node* prev;
+				Node* next;
+				// a hole of a single point
+				bool steiner;
+			};
+
+			Node* insert(const uint32_t index, Node* const last)
+			{
+				m_nodes.push_back({ index, m_points[index].x, m_points[index].y, nullptr, nullptr, false });
+				Node* const node = &m_nodes.back();
+				if (last == nullptr)
+				{
+					node->prev = node;
+					node->next = node;
+				}
+				else
+				{
+					node->next = last->next;
+					node->prev = last;
+					last->next->prev = node;
+					last->next = node;
+				}
+				return node;
+			}
+
+			static void remove(Node* const node)
+			{
+				node->next->prev = node->prev;
+				node->prev->next = node->next;
+			}
+
+			// the outline and the holes are linked in opposite windings
+			Node* createRing(const size_t begin, const size_t end, const bool outline)
+			{
+				float sum = 0.f;
+				for (size_t i = begin, j = end - 1; i < end; j = i++)
+				{
+					sum += (m_points[j].x - m_points[i].x) * (m_points[i].y + m_points[j].y);
+				}
+
+				Node* last = nullptr;
+				if (outline == (sum > 0.f))
+				{
+					for (size_t i = begin; i < end; ++i)
+					{
+						last = insert(static_cast<uint32_t>(i), last);
+					}
+				}
+				else
+				{
+					for (size_t i = end; i-- > begin;)
+					{
+						last = insert(static_cast<uint32_t>(i), last);
+					}
+				}
+
+				if (last != nullptr && equals(last, last->next))
+				{
+					remove(last);
+					last = last->next;
+				}
+				return last;
+			}
+
+			// remove duplicated and collinear points
+			Node* filter(Node* const start, Node* end = nullptr)
+			{
+				if (start == nullptr) return start;
+				if (end == nullptr) end = start;
+
+				Node* node = start;
+				bool again;
+				do
+				{
+					again = false;
+					if (!node->steiner && (equals(node, node->next) || area(node->prev, node, node->next) == 0.f))
+					{
+						remove(node);
+						node = end = node->prev;
+						if (node == node->next) break;
+						again = true;
+					}
+					else
+					{
+						node = node->next;
+					}
+				} while (again || node != end);
+				return end;
+			}
+
+			void clip(Node* ear, const int pass)
+			{
+				if (ear == nullptr) return;
+
+				Node* stop = ear;
+				while (ear->prev != ear->next)
+				{
+					Node* const prev = ear->prev;
+					Node* const next = ear->next;
+
+					if (isEar(ear))
+					{
+						addTriangle(prev, ear, next);
+						remove(ear);
+						// skipping the next vertex leads to less sliver triangles
+						ear = next->next;
+						stop = next->next;
+						continue;
+					}
+
+					ear = next;
+					if (ear == stop)
+					{
+						if (pass == 0)
+						{
+							clip(filter(ear), 1);
+						}
+						else if (pass == 1)
+						{
+							clip(cureLocalIntersections(filter(ear)), 2);
+						}
+						else
+						{
+							split(ear);
+						}
+						break;
+					}
+				}
+			}
+
+			bool isEar(Node* const ear) const
+			{
+				const Node* const a = ear->prev;
+				const Node* const b = ear;
+				const Node* const c = ear->next;
+
+				// reflex
+				if (area(a, b, c) >= 0.f) return false;
+
+				const float minX = std::min({ a->x, b->x, c->x });
+				const float minY = std::min({ a->y, b->y, c->y });
+				const float maxX = std::max({ a->x, b->x, c->x });
+				const float maxY = std::max({ a->y, b->y, c->y });
+
+				// no other point may lie in the ear
+				for (const Node* p = c->next; p != a; p = p->next)
+				{
+					if (p->x >= minX && p->x <= maxX && p->y >= minY && p->y <= maxY
+						&& pointInTriangle(a->x, a->y, b->x, b->y, c->x, c->y, p->x, p->y)
+						&& area(p->prev, p, p->next) >= 0.f) return false;
+				}
+				return true;
+			}
+
+			Node* cureLocalIntersections(Node* start)
+			{
+				Node* node = start;
+				do
+				{
+					Node* const a = node->prev;
+					Node* const b = node->next->next;
+
+					if (!equals(a, b) && intersects(a, node, node->next, b) && locallyInside(a, b) && locallyInside(b, a))
+					{
+						addTriangle(a, node, b);
+						remove(node);
+						remove(node->next);
+						node = start = b;
+					}
+					node = node->next;
+				} while (node != start);
+
+				return filter(node);
+			}
+
+			void split(Node* const start)
+			{
+				Node* a = start;
+				do
+				{
+					for (Node* b = a->next->next; b != a->prev; b = b->next)
+					{
+						if (a->index != b->index && isValidDiagonal(a, b))
+						{
+							Node* c = splitRing(a, b);
+							a = filter(a, a->next);
+							c = filter(c, c->next);
+							clip(a, 0);
+							clip(c, 0);
+							return;
+						}
+					}
+					a = a->next;
+				} while (a != start);
+			}
+
+			Node* eliminateHoles(const size_t* const ringEnds, const size_t numOfRings, Node* outer)
+			{
+				std::vector<Node*> holes;
+				for (size_t i = 1; i < numOfRings; ++i)
+				{
+					Node* const hole = createRing(ringEnds[i - 1], ringEnds[i], false);
+					if (hole == nullptr) continue;
+
+					if (hole == hole->next)
+					{
+						hole->steiner = true;
+					}
+					holes.push_back(getLeftmost(hole));
+				}
+
+				// from left to right, so that every hole is bridged to the outline or to a hole bridged before
+				std::sort(holes.begin(), holes.end(), [](const Node* const a, const Node* const b)
+				{
+					return a->x < b->x || (a->x == b->x && a->y < b->y);
+				});
+
+				for (Node* const hole : holes)
+				{
+					Node* const bridge = findHoleBridge(hole, outer);
+					if (bridge == nullptr) continue;
+
+					Node* const bridgeReverse = splitRing(bridge, hole);
+					filter(bridgeReverse, bridgeReverse->next);
+					outer = filter(bridge, bridge->next);
+				}
+				return outer;
+			}
+
+			// the point of the outline visible from the leftmost point of the hole
+			Node* findHoleBridge(Node* const hole, Node* const outer) const
+			{
+				const float hx = hole->x;
+				const float hy = hole->y;
+				float qx = -std::numeric_limits<float>::infinity();
+				Node* m = nullptr;
+
+				// the segment crossed by a ray going left from the hole
+				Node* p = outer;
+				do
+				{
+					if (hy <= p->y && hy >= p->next->y && p->next->y != p->y)
+					{
+						const float x = p->x + (hy - p->y) * (p->next->x - p->x) / (p->next->y - p->y);
+						if (x <= hx && x > qx)
+						{
+							qx = x;
+							m = p->x < p->next->x ? p : p->next;
+							if (x == hx) return m;
+						}
+					}
+					p = p->next;
+				} while (p != outer);
+
+				if (m == nullptr) return nullptr;
+
+				// a reflex point inside the triangle of the hole, the intersection and m
+				// would hide m, take the one with the smallest angle to the ray instead
+				Node* const stop = m;
+				const float mx = m->x;
+				const float my = m->y;
+				float tanMin = std::numeric_limits<float>::infinity();
+				p = m;
+				do
+				{
+					if (hx >= p->x && p->x >= mx && hx != p->x
+						&& pointInTriangle(hy < my ? hx : qx, hy, mx, my, hy < my ? qx : hx, hy, p->x, p->y))
+					{
+						const float tan = std::abs(hy - p->y) / (hx - p->x);
+						if (locallyInside(p, hole)
+							&& (tan < tanMin || (tan == tanMin && (p->x > m->x || (p->x == m->x && sectorContainsSector(m, p))))))
+						{
+							m = p;
+							tanMin = tan;
+						}
+					}
+					p = p->next;
+				} while (p != stop);
+
+				return m;
+			}
+
+			static Node* getLeftmost(Node* const start)
+			{
+				Node* node = start;
+				Node* leftmost = start;
+				do
+				{
+					if (node->x < leftmost->x || (node->x == leftmost->x && node->y < leftmost->y))
+					{
+						leftmost = node;
+					}
+					node = node->next;
+				} while (node != start);
+				return leftmost;
+			}
+
+			// link a and b with a diagonal, returns the first node of the second ring
+			Node* splitRing(Node* const a, Node* const b)
+			{
+				m_nodes.push_back({ a->index, a->x, a->y, nullptr, nullptr, false });
+				Node* const a2 = &m_nodes.back();
+				m_nodes.push_back({ b->index, b->x, b->y, nullptr, nullptr, false });
+				Node* const b2 = &m_nodes.back();
+				Node* const an = a->next;
+				Node* const bp = b->prev;
+
+				a->next = b;
+				b->prev = a;
+
+				a2->next = an;
+				an->prev = a2;
+
+				b2->next = a2;
+				a2->prev = b2;
+
+				bp->next = b2;
+				b2->prev = bp;
+
+				return b2;
+			}
+
+			bool isValidDiagonal(const Node* const a, const Node* const b) const
+			{
+				return a->next->index != b->index && a->prev->index != b->index && !intersectsRing(a, b)
+					&& ((locallyInside(a, b) && locallyInside(b, a) && middleInside(a, b)
+						&& (area(a->prev, a, b->prev) != 0.f || area(a, b->prev, b) != 0.f))
+						|| (equals(a, b) && area(a->prev, a, a->next) > 0.f && area(b->prev, b, b->next) > 0.f));
+			}
+
+			static bool intersectsRing(const Node* const a, const Node* const b)
+			{
+				const Node* p = a;
+				do
+				{
+					if (p->index != a->index && p->next->index != a->index && p->index != b->index && p->next->index != b->index
+						&& intersects(p, p->next, a, b)) return true;
+					p = p->next;
+				} while (p != a);
+				return false;
+			}
+
+			static bool locallyInside(const Node* const a, const Node* const b)
+			{
+				return area(a->prev, a, a->next) < 0.f
+					? area(a, b, a->next) >= 0.f && area(a, a->prev, b) >= 0.f
+					: area(a, b, a->prev) < 0.f || area(a, a->next, b) < 0.f;
+			}
+
+			static bool middleInside(const Node* const a, const Node* const b)
+			{
+				const float px = (a->x + b->x) / 2.f;
+				const float py = (a->y + b->y) / 2.f;
+				bool inside = false;
+				const Node* p = a;
+				do
+				{
+					if (((p->y > py) != (p->next->y > py)) && p->next->y != p->y
+						&& (px < (p->next->x - p->x) * (py - p->y) / (p->next->y - p->y) + p->x))
+					{
+						inside = !inside;
+					}
+					p = p->next;
+				} while (p != a);
+				return inside;
+			}
+
+			static bool sectorContainsSector(const Node* const m, const Node* const p)
+			{
+				return area(m->prev, m, p->prev) < 0.f && area(p->next, m, m->next) < 0.f;
+			}
+
+			static float area(const Node* const p, const Node* const q, const Node* const r)
+			{
+				return (q->y - p->y) * (r->x - q->x) - (q->x - p->x) * (r->y - q->y);
+			}
+
+			static bool equals(const Node* const a, const Node* const b)
+			{
+				return a->x == b->x && a->y == b->y;
+			}
+
+			static int sign(const float value)
+			{
+				return value > 0.f ? 1 : (value < 0.f ? -1 : 0);
+			}
+
+			static bool onSegment(const Node* const p, const Node* const q, const Node* const r)
+			{
+				return q->x <= std::max(p->x, r->x) && q->x >= std::min(p->x, r->x)
+					&& q->y <= std::max(p->y, r->y) && q->y >= std::min(p->y, r->y);
+			}
+
+			static bool intersects(const Node* const p1, const Node* const q1, const Node* const p2, const Node* const q2)
+			{
+				const int o1 = sign(area(p1, q1, p2));
+				const int o2 = sign(area(p1, q1, q2));
+				const int o3 = sign(area(p2, q2, p1));
+				const int o4 = sign(area(p2, q2, q1));
+
+				if (o1 != o2 && o3 != o4) return true;
+
+				// collinear cases
+				if (o1 == 0 && onSegment(p1, p2, q1)) return true;
+				if (o2 == 0 && onSegment(p1, q2, q1)) return true;
+				if (o3 == 0 && onSegment(p2, p1, q2)) return true;
+				if (o4 == 0 && onSegment(p2, q1, q2)) return true;
+				return false;
+			}
+
+			static bool pointInTriangle(const float ax, const float ay, const float bx, const float by, const float cx, const float cy, const float px, const float py)
+			{
+				return (cx - px) * (ay - py) >= (ax - px) * (cy - py)
+					&& (ax - px) * (by - py) >= (bx - px) * (ay - py)
+					&& (bx - px) * (cy - py) >= (cx - px) * (by - py);
+			}
+
+			void addTriangle(const Node* const a, const Node* const b, const Node* const c)
+			{
+				m_indices.push_back(a->index);
+				m_indices.push_back(b->index);
+				m_indices.push_back(c->index);
+			}
+
+			const math::vec3* m_points;
+			std::vector<uint32_t>& m_indices;
+			// the addresses of the nodes must not change
+			std::deque<Node> m_nodes;
+		};
+	}
+
+	PolygonTriangulator::PolygonTriangulator(const size_t cacheCapacity)
+		: m_cacheCapacity(cacheCapacity)
+		, m_entries()
+		, m_lookup()
+		, m_indices()
+	{
+	}
+
+	const std::vector<uint32_t>& PolygonTriangulator::triangulate(const math::vec3* const points, const size_t* const ringEnds, const size_t numOfRings)
+	{
+		m_indices.clear();
+		if (points == nullptr || ringEnds == nullptr || numOfRings == 0 || ringEnds[0] < 3) return m_indices;
+
+		const size_t numOfPoints = ringEnds[numOfRings - 1];
+		const uint64_t key = hash(points, ringEnds, numOfRings);
+		if (m_cacheCapacity > 0)
+		{
+			const auto& it = m_lookup.find(key);
+			if (it != m_lookup.end() && matches(*it->second, points, ringEnds, numOfRings))
+			{
+				++m_hits;
+				m_entries.splice(m_entries.begin(), m_entries, it->second);
+				return it->second->indices;
+			}
+		}
+		++m_misses;
+
+		std::vector<uint32_t> indices;
+		indices.reserve(3 * (numOfPoints + 2 * (numOfRings - 1)));
+		EarClipper(points, indices).triangulate(ringEnds, numOfRings);
+
+		if (m_cacheCapacity == 0)
+		{
+			m_indices = std::move(indices);
+			return m_indices;
+		}
+
+		const auto& it = m_lookup.find(key);
+		if (it != m_lookup.end())
+		{
+			// a collision, the newest outline takes the place
+			m_entries.erase(it->second);
+			m_lookup.erase(it);
+		}
+		else if (m_entries.size() >= m_cacheCapacity)
+		{
+			m_lookup.erase(m_entries.back().hash);
+			m_entries.pop_back();
+		}
+
+		std::vector<float> coordinates(2 * numOfPoints);
+		for (size_t i = 0; i < numOfPoints; ++i)
+		{
+			coordinates[2 * i] = points[i].x;
+			coordinates[2 * i + 1] = points[i].y;
+		}
+		m_entries.push_front({ key, std::move(coordinates), std::vector<size_t>(ringEnds, ringEnds + numOfRings), std::move(indices) });
+		m_lookup[key] = m_entries.begin();
+		return m_entries.front().indices;
+	}
+
+	void PolygonTriangulator::setCacheCapacity(const size_t capacity)
+	{
+		m_cacheCapacity = capacity;
+		while (m_entries.size() > m_cacheCapacity)
+		{
+			m_lookup.erase(m_entries.back().hash);
+			m_entries.pop_back();
+		}
+	}
+
+	void PolygonTriangulator::clearCache()
+	{
+		m_entries.clear();
+		m_lookup.clear();
+	}
+
+	bool PolygonTriangulator::matches(const Entry& entry, const math::vec3* const points, const size_t* const ringEnds, const size_t numOfRings)
+	{
+		if (entry.ringEnds.size() != numOfRings || !std::equal(entry.ringEnds.begin(), entry.ringEnds.end(), ringEnds)) return false;
+
+		// compared by bits as they are hashed
+		for (size_t i = 0; i < ringEnds[numOfRings - 1]; ++i)
+		{
+			if (std::memcmp(&entry.coordinates[2 * i], &points[i].x, sizeof(float)) != 0
+				|| std::memcmp(&entry.coordinates[2 * i + 1], &points[i].y, sizeof(float)) != 0)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	uint64_t PolygonTriangulator::hash(const math::vec3* const points, const size_t* const ringEnds, const size_t numOfRings)
+	{
+		// FNV-1a over the coordinates and the rings
+		uint64_t result = 14695981039346656037ull;
+		const auto& combine = [&result](const uint32_t value)
+		{
+			for (int i = 0; i < 4; ++i)
+			{
+				result ^= (value >> (i * 8)) & 0xff;
+				result *= 1099511628211ull;
+			}
+		};
+
+		for (size_t i = 0; i < ringEnds[numOfRings - 1]; ++i)
+		{
+			uint32_t x, y;
+			std::memcpy(&x, &points[i].x, sizeof(float));
+			std::memcpy(&y, &points[i].y, sizeof(float));
+			combine(x);
+			combine(y);
+		}
+		for (size_t i = 0; i < numOfRings; ++i)
+		{
+			combine(static_cast<uint32_t>(ringEnds[i]));
+		}
+		return result;
+	}
+}
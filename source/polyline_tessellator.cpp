@@ -0,0 +1,343 @@
+#include <vdtgraphics/polyline_tessellator.h>
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VDTGRAPHICS_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace graphics
+{
+	namespace
+	{
+		constexpr float pi = 3.14159265358979f;
+		// below this the segments are considered aligned
+		constexpr float collinear_epsilon = 1e-6f;
+	}
+
+	bool PolylineTessellator::begin(const math::vec3* const points, const size_t numOfPoints, const Style& style, const Color& color)
+	{
+		m_completed = true;
+		m_numOfPoints = 0;
+		m_numOfSegments = 0;
+		m_x.clear();
+		m_y.clear();
+		m_z.clear();
+
+		if (points == nullptr || numOfPoints < 2 || style.width <= 0.f) return false;
+
+		// repeated points have no direction
+		for (size_t i = 0; i < numOfPoints; ++i)
+		{
+			const math::vec3& point = points[i];
+			if (!m_x.empty() && m_x.back() == point.x && m_y.back() == point.y) continue;
+
+			m_x.push_back(point.x);
+			m_y.push_back(point.y);
+			m_z.push_back(point.z);
+		}
+
+		m_style = style;
+		if (m_style.closed && m_x.size() > 1 && m_x.back() == m_x.front() && m_y.back() == m_y.front())
+		{
+			m_x.pop_back();
+			m_y.pop_back();
+			m_z.pop_back();
+		}
+		if (m_x.size() < 3)
+		{
+			m_style.closed = false;
+		}
+
+		m_numOfPoints = m_x.size();
+		if (m_numOfPoints < 2) return false;
+
+		m_numOfSegments = m_style.closed ? m_numOfPoints : m_numOfPoints - 1;
+		if (m_style.closed)
+		{
+			// the end of the closing segment, so that every segment reads the point after its own
+			m_x.push_back(m_x.front());
+			m_y.push_back(m_y.front());
+			m_z.push_back(m_z.front());
+		}
+
+		m_color = color;
+		m_halfWidth = m_style.width * 0.5f;
+		m_nextJoint = 0;
+		m_completed = false;
+		computeSegments();
+		return true;
+	}
+
+	bool PolylineTessellator::next()
+	{
+		if (m_completed) return false;
+
+		m_vertices.clear();
+		m_indices.clear();
+
+		const size_t lastJoint = m_numOfPoints - 1;
+		const size_t first = m_nextJoint;
+		const size_t last = std::min(first + max_points_per_strip, lastJoint);
+
+		if (first == 0)
+		{
+			if (m_style.closed)
+			{
+				emitJoint(0, JointPart::Full);
+			}
+			else
+			{
+				emitStartCap();
+			}
+		}
+		else
+		{
+			// the previous strip ends with the rest of this joint
+			emitJoint(first, JointPart::Out);
+		}
+
+		for (size_t joint = first + 1; joint < last; ++joint)
+		{
+			emitJoint(joint, JointPart::Full);
+		}
+
+		if (last == lastJoint)
+		{
+			if (m_style.closed)
+			{
+				emitJoint(last, JointPart::Full);
+				emitJoint(0, JointPart::In);
+			}
+			else
+			{
+				emitEndCap();
+			}
+			m_completed = true;
+		}
+		else
+		{
+			emitJoint(last, JointPart::Full);
+		}
+
+		m_nextJoint = last;
+		return true;
+	}
+
+	void PolylineTessellator::computeSegments()
+	{
+		m_directionX.resize(m_numOfSegments);
+		m_directionY.resize(m_numOfSegments);
+		m_length.resize(m_numOfSegments);
+
+		size_t i = 0;
+#ifdef VDTGRAPHICS_SSE2
+		// four segments at a time, the points are stored by component
+		for (; i + 4 <= m_numOfSegments; i += 4)
+		{
+			const __m128 dx = _mm_sub_ps(_mm_loadu_ps(&m_x[i + 1]), _mm_loadu_ps(&m_x[i]));
+			const __m128 dy = _mm_sub_ps(_mm_loadu_ps(&m_y[i + 1]), _mm_loadu_ps(&m_y[i]));
+			const __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)));
+			_mm_storeu_ps(&m_directionX[i], _mm_div_ps(dx, length));
+			_mm_storeu_ps(&m_directionY[i], _mm_div_ps(dy, length));
+			_mm_storeu_ps(&m_length[i], length);
+		}
+#endif
+		for (; i < m_numOfSegments; ++i)
+		{
+			const float dx = m_x[i + 1] - m_x[i];
+			const float dy = m_y[i + 1] - m_y[i];
+			const float length = std::sqrt(dx * dx + dy * dy);
+			m_directionX[i] = dx / length;
+			m_directionY[i] = dy / length;
+			m_length[i] = length;
+		}
+	}
+
+	void PolylineTessellator::emitJoint(const size_t joint, const JointPart part)
+	{
+		const float px = m_x[joint];
+		const float py = m_y[joint];
+		const float pz = m_z[joint];
+		const float halfWidth = m_halfWidth;
+
+		const size_t in = joint == 0 ? m_numOfSegments - 1 : joint - 1;
+		const size_t out = joint;
+		const float ax = m_directionX[in], ay = m_directionY[in];
+		const float bx = m_directionX[out], by = m_directionY[out];
+		// the normals point to the left side
+		const float nax = -ay, nay = ax;
+		const float nbx = -by, nby = bx;
+		const float cross = ax * by - ay * bx;
+		const float dot = ax * bx + ay * by;
+
+		if (std::abs(cross) < collinear_epsilon && dot > 0.f)
+		{
+			addIndex(addVertex(px + nax * halfWidth, py + nay * halfWidth, pz));
+			addIndex(addVertex(px - nax * halfWidth, py - nay * halfWidth, pz));
+			return;
+		}
+
+		// the bisector of the normals, and the cosine of half the angle between them
+		float mx = nax + nbx, my = nay + nby;
+		const float bisectorLength = std::sqrt(mx * mx + my * my);
+		float cosine = 0.f;
+		if (bisectorLength > collinear_epsilon)
+		{
+			mx /= bisectorLength;
+			my /= bisectorLength;
+			cosine = mx * nax + my * nay;
+		}
+		else
+		{
+			// the polyline turns back
+			mx = nax;
+			my = nay;
+		}
+
+		if (m_style.join == LineJoin::Miter && cosine * m_style.miterLimit >= 1.f)
+		{
+			const float miter = halfWidth / cosine;
+			addIndex(addVertex(px + mx * miter, py + my * miter, pz));
+			addIndex(addVertex(px - mx * miter, py - my * miter, pz));
+			return;
+		}
+
+		// the signed angle of the turn, positive to the left
+		const float angle = std::atan2(cross, dot);
+		const float side = angle >= 0.f ? 1.f : -1.f;
+
+		// the sides intersect on the inner side, no further than the shortest segment
+		// so that the joint doesn't fold over the segments
+		float innerLength = halfWidth;
+		if (cosine > collinear_epsilon)
+		{
+			const float shortest = std::min(m_length[in], m_length[out]);
+			innerLength = std::min(halfWidth / cosine, std::sqrt(shortest * shortest + halfWidth * halfWidth));
+		}
+		const uint32_t inner = addVertex(px + side * mx * innerLength, py + side * my * innerLength, pz);
+
+		// the strip goes left then right
+		const auto& addPair = [this, side](const uint32_t innerIndex, const uint32_t outerIndex)
+		{
+			addIndex(side > 0.f ? innerIndex : outerIndex);
+			addIndex(side > 0.f ? outerIndex : innerIndex);
+		};
+
+		const float inX = px - side * nax * halfWidth, inY = py - side * nay * halfWidth;
+		const float outX = px - side * nbx * halfWidth, outY = py - side * nby * halfWidth;
+		if (part == JointPart::In)
+		{
+			addPair(inner, addVertex(inX, inY, pz));
+			return;
+		}
+		if (part == JointPart::Out)
+		{
+			addPair(inner, addVertex(outX, outY, pz));
+			return;
+		}
+
+		addPair(inner, addVertex(inX, inY, pz));
+		if (m_style.join == LineJoin::Round)
+		{
+			// fan around the inner vertex, rotating the outer side from a segment to the next one
+			const size_t steps = std::max<size_t>(1, static_cast<size_t>(std::ceil(std::abs(angle) / pi * round_segments)));
+			const float step = angle / steps;
+			const float stepCos = std::cos(step), stepSin = std::sin(step);
+			float vx = -side * nax, vy = -side * nay;
+			for (size_t i = 1; i < steps; ++i)
+			{
+				const float x = vx * stepCos - vy * stepSin;
+				vy = vx * stepSin + vy * stepCos;
+				vx = x;
+				addPair(inner, addVertex(px + vx * halfWidth, py + vy * halfWidth, pz));
+			}
+		}
+		addPair(inner, addVertex(outX, outY, pz));
+	}
+
+	void PolylineTessellator::emitStartCap()
+	{
+		const float dx = m_directionX[0], dy = m_directionY[0];
+		const float nx = -dy, ny = dx;
+		float px = m_x[0], py = m_y[0];
+		const float pz = m_z[0];
+
+		if (m_style.cap == LineCap::Round)
+		{
+			// half circle behind the point, from the left side to the right one,
+			// zigzagging from its middle to end with the sides of the segment
+			const uint32_t base = static_cast<uint32_t>(m_vertices.size());
+			for (size_t i = 0; i <= round_segments; ++i)
+			{
+				const float angle = pi * i / round_segments;
+				const float c = std::cos(angle), s = std::sin(angle);
+				addVertex(px + (nx * c - ny * s) * m_halfWidth, py + (nx * s + ny * c) * m_halfWidth, pz);
+			}
+
+			const uint32_t middle = static_cast<uint32_t>(round_segments / 2);
+			addIndex(base + middle);
+			for (uint32_t i = 1; i <= middle; ++i)
+			{
+				addIndex(base + middle - i);
+				addIndex(base + middle + i);
+			}
+			return;
+		}
+
+		if (m_style.cap == LineCap::Square)
+		{
+			px -= dx * m_halfWidth;
+			py -= dy * m_halfWidth;
+		}
+		addIndex(addVertex(px + nx * m_halfWidth, py + ny * m_halfWidth, pz));
+		addIndex(addVertex(px - nx * m_halfWidth, py - ny * m_halfWidth, pz));
+	}
+
+	void PolylineTessellator::emitEndCap()
+	{
+		const size_t segment = m_numOfSegments - 1;
+		const size_t point = m_numOfPoints - 1;
+		const float dx = m_directionX[segment], dy = m_directionY[segment];
+		const float nx = -dy, ny = dx;
+		float px = m_x[point], py = m_y[point];
+		const float pz = m_z[point];
+
+		if (m_style.cap == LineCap::Round)
+		{
+			// half circle in front of the point, starting with the sides of the segment
+			const uint32_t base = static_cast<uint32_t>(m_vertices.size());
+			for (size_t i = 0; i <= round_segments; ++i)
+			{
+				const float angle = -pi * i / round_segments;
+				const float c = std::cos(angle), s = std::sin(angle);
+				addVertex(px + (nx * c - ny * s) * m_halfWidth, py + (nx * s + ny * c) * m_halfWidth, pz);
+			}
+
+			const uint32_t middle = static_cast<uint32_t>(round_segments / 2);
+			for (uint32_t i = 0; i < middle; ++i)
+			{
+				addIndex(base + i);
+				addIndex(base + static_cast<uint32_t>(round_segments) - i);
+			}
+			addIndex(base + middle);
+			return;
+		}
+
+		if (m_style.cap == LineCap::Square)
+		{
+			px += dx * m_halfWidth;
+			py += dy * m_halfWidth;
+		}
+		addIndex(addVertex(px + nx * m_halfWidth, py + ny * m_halfWidth, pz));
+		addIndex(addVertex(px - nx * m_halfWidth, py - ny * m_halfWidth, pz));
+	}
+
+	uint32_t PolylineTessellator::addVertex(const float x, const float y, const float z)
+	{
+		m_vertices.push_back({ math::vec3(x, y, z), m_color });
+		return static_cast<uint32_t>(m_vertices.size() - 1);
+	}
+}
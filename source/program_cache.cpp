@@ -0,0 +1,211 @@
+#include <vdtgraphics/program_cache.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include <vdtgraphics/shader_program.h>
+
+namespace graphics
+{
+	namespace
+	{
+		constexpr uint32_t file_magic = 0x50474456; // VDGP
+		constexpr uint32_t file_version = 1;
+
+		struct FileHeader
+		{
+			uint32_t magic;
+			uint32_t version;
+			uint64_t sourceHash;
+			uint64_t driverHash;
+			uint32_t binaryFormat;
+			uint32_t size;
+		};
+
+		// FNV-1a
+		uint64_t hash(const void* const data, const size_t size, uint64_t result = 14695981039346656037ull)
+		{
+			const uint8_t* const bytes = static_cast<const uint8_t*>(data);
+			for (size_t i = 0; i < size; ++i)
+			{
+				result = (result ^ bytes[i]) * 1099511628211ull;
+			}
+			return result;
+		}
+
+		uint64_t hash(const std::string& text, const uint64_t result)
+		{
+			// the terminator separates the strings
+			return hash(text.c_str(), text.size() + 1, result);
+		}
+
+		uint64_t hash(const std::map<Shader::Type, std::string>& sources)
+		{
+			uint64_t result = hash(nullptr, 0);
+			for (const auto& pair : sources)
+			{
+				const uint8_t type = static_cast<uint8_t>(pair.first);
+				result = hash(&type, sizeof(type), result);
+				result = hash(pair.second, result);
+			}
+			return result;
+		}
+
+		bool isFormatSupported(const unsigned int binaryFormat)
+		{
+			int numOfFormats = 0;
+			glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numOfFormats);
+			if (numOfFormats <= 0) return false;
+
+			std::vector<int> formats(static_cast<size_t>(numOfFormats));
+			glGetIntegerv(GL_PROGRAM_BINARY_FORMATS, formats.data());
+			return std::find(formats.begin(), formats.end(), static_cast<int>(binaryFormat)) != formats.end();
+		}
+	}
+
+	ProgramCache::ProgramCache(const std::string& directory)
+		: m_directory(directory)
+		, m_driverHash(0)
+		, m_stats()
+	{
+	}
+
+	bool ProgramCache::isSupported()
+	{
+		if (!GLAD_GL_VERSION_4_1) return false;
+
+		int numOfFormats = 0;
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numOfFormats);
+		return numOfFormats > 0;
+	}
+
+	std::unique_ptr<ShaderProgram> ProgramCache::load(const std::string& name, const std::map<Shader::Type, std::string>& sources)
+	{
+		if (std::unique_ptr<ShaderProgram> program = find(name, sources))
+		{
+			return program;
+		}
+
+		std::unique_ptr<ShaderProgram> program = compile(sources, isSupported());
+		if (program != nullptr)
+		{
+			store(name, sources, *program);
+		}
+		return program;
+	}
+
+	std::unique_ptr<ShaderProgram> ProgramCache::find(const std::string& name, const std::map<Shader::Type, std::string>& sources)
+	{
+		if (!isSupported())
+		{
+			++m_stats.misses;
+			return nullptr;
+		}
+
+		std::ifstream input(getFilename(name), std::ios::binary);
+		if (input.is_open())
+		{
+			FileHeader header{};
+			input.read(reinterpret_cast<char*>(&header), sizeof(FileHeader));
+			// stale binaries are replaced when stored again
+			if (input
+				&& header.magic == file_magic
+				&& header.version == file_version
+				&& header.sourceHash == hash(sources)
+				&& header.driverHash == getDriverHash()
+				&& isFormatSupported(header.binaryFormat))
+			{
+				std::vector<uint8_t> binary(header.size);
+				input.read(reinterpret_cast<char*>(binary.data()), binary.size());
+				if (input)
+				{
+					std::unique_ptr<ShaderProgram> program = std::make_unique<ShaderProgram>(header.binaryFormat, binary.data(), binary.size());
+					if (program->getState() == ShaderProgram::State::Linked)
+					{
+						++m_stats.hits;
+						return program;
+					}
+					++m_stats.rejected;
+				}
+			}
+		}
+
+		++m_stats.misses;
+		return nullptr;
+	}
+
+	bool ProgramCache::store(const std::string& name, const std::map<Shader::Type, std::string>& sources, const ShaderProgram& program)
+	{
+		unsigned int binaryFormat = 0;
+		std::vector<uint8_t> binary;
+		if (!isSupported() || !program.getBinary(binaryFormat, binary))
+		{
+			// nothing to store, a stale binary must not be read again
+			remove(name);
+			return false;
+		}
+
+		// written aside and renamed, a partial file is never read
+		const std::string filename = getFilename(name);
+		const std::string temporaryFilename = filename + ".tmp";
+		std::ofstream output(temporaryFilename, std::ios::binary | std::ios::trunc);
+		if (!output.is_open()) return false;
+
+		const FileHeader header{ file_magic, file_version, hash(sources), getDriverHash(), binaryFormat, static_cast<uint32_t>(binary.size()) };
+		output.write(reinterpret_cast<const char*>(&header), sizeof(FileHeader));
+		output.write(reinterpret_cast<const char*>(binary.data()), binary.size());
+		output.close();
+
+		std::remove(filename.c_str());
+		if (!output || std::rename(temporaryFilename.c_str(), filename.c_str()) != 0)
+		{
+			std::remove(temporaryFilename.c_str());
+			return false;
+		}
+		return true;
+	}
+
+	void ProgramCache::remove(const std::string& name)
+	{
+		std::remove(getFilename(name).c_str());
+	}
+
+	std::unique_ptr<ShaderProgram> ProgramCache::compile(const std::map<Shader::Type, std::string>& sources, const bool retrievable, const bool deferred)
+	{
+		const auto& vertexSource = sources.find(Shader::Type::Vertex);
+		const auto& fragmentSource = sources.find(Shader::Type::Fragment);
+		if (vertexSource == sources.end() || fragmentSource == sources.end())
+		{
+			return nullptr;
+		}
+
+		Shader vs(Shader::Type::Vertex, vertexSource->second, deferred);
+		Shader fs(Shader::Type::Fragment, fragmentSource->second, deferred);
+		return std::make_unique<ShaderProgram>(std::initializer_list<Shader*>{ &vs, &fs }, retrievable, deferred);
+	}
+
+	std::string ProgramCache::getFilename(const std::string& name) const
+	{
+		return m_directory + "/" + name + ".program";
+	}
+
+	uint64_t ProgramCache::getDriverHash()
+	{
+		// read once the context is current
+		if (m_driverHash == 0)
+		{
+			uint64_t result = hash(nullptr, 0);
+			for (const GLenum parameter : { GL_VENDOR, GL_RENDERER, GL_VERSION })
+			{
+				const GLubyte* const value = glGetString(parameter);
+				result = hash(value != nullptr ? std::string(reinterpret_cast<const char*>(value)) : std::string(), result);
+			}
+			m_driverHash = result;
+		}
+		return m_driverHash;
+	}
+}
@@ -1,137 +1,410 @@
 #include <vdtgraphics/render_commands.h>
 
+#include <algorithm>
+
 #include <glad/glad.h>
 
+#include <vdtgraphics/camera_buffer.h>
 #include <vdtgraphics/font.h>
+#include <vdtgraphics/gl_state_cache.h>
+#include <vdtgraphics/index_buffer.h>
 #include <vdtgraphics/renderable.h>
 #include <vdtgraphics/shader_program.h>
+#include <vdtgraphics/sprite_layer.h>
 #include <vdtgraphics/texture.h>
+#include <vdtgraphics/texture_array.h>
 #include <vdtgraphics/vertex_buffer.h>
 
 namespace graphics
 {
+	namespace
+	{
+		constexpr UniformName textures_uniform{ "u_textures" };
+
+		// find the slot of the texture, or add it if there is room
+		template <typename T, size_t N>
+		size_t findIndex(T* const element, std::array<T*, N>& elements, size_t& count)
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				if (elements[i] == element) return i;
+			}
+
+			if (count < N)
+			{
+				elements[count] = element;
+				return count++;
+			}
+			return N;
+		}
+
+		// the offset of the data in the buffer, uploading it if not written in place
+		bool upload(VertexBuffer& buffer, const VertexBuffer::Range& range, const size_t size, size_t& offset)
+		{
+			if (range.mapped)
+			{
+				offset = range.offset;
+				return true;
+			}
+			return buffer.stream(range.data, size, offset);
+		}
+
+		// switch from the default state of the context to the one of the pass.
+		// Premultiplied colors are blended with One, the opaque pass doesn't blend
+		void beginPass(const RenderPass pass, const bool premultiplied = false)
+		{
+			if (pass == RenderPass::Opaque)
+			{
+				GLStateCache::get().setBlendEnabled(false);
+				return;
+			}
+			if (pass == RenderPass::Translucent)
+			{
+				GLStateCache::get().setDepthMask(false);
+			}
+			if (premultiplied)
+			{
+				GLStateCache::get().setBlendFunction(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+			}
+		}
+
+		void endPass(const RenderPass pass, const bool premultiplied = false)
+		{
+			if (pass == RenderPass::Opaque)
+			{
+				GLStateCache::get().setBlendEnabled(true);
+				return;
+			}
+			if (pass == RenderPass::Translucent)
+			{
+				GLStateCache::get().setDepthMask(true);
+			}
+			if (premultiplied)
+			{
+				GLStateCache::get().setBlendFunction(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+			}
+		}
+
+		void writeVertex(const Vertex& vertex, float* const data)
+		{
+			data[0] = vertex.position.x;
+			data[1] = vertex.position.y;
+			data[2] = vertex.position.z;
+			std::copy(vertex.color.data, vertex.color.data + 4, data + 3);
+		}
+
+		// the layout of a shape instance on the GPU
+		struct PackedShapeInstance
+		{
+			float position[3];
+			float extent[2];
+			float rotation;
+			float radius;
+			float strokeWidth;
+			uint8_t fillColor[4];
+			uint8_t strokeColor[4];
+			// type, 1 << 8 if the stroke width is in pixels
+			uint32_t type;
+		};
+
+		static_assert(sizeof(PackedShapeInstance) == ShapeInstance::size * 4, "unexpected shape instance size");
+
+		void packColor(const Color& color, uint8_t* const data)
+		{
+			for (size_t i = 0; i < 4; ++i)
+			{
+				data[i] = static_cast<uint8_t>(std::min(std::max(color.data[i], 0.0f), 1.0f) * 255.0f + 0.5f);
+			}
+		}
+	}
+
 	// RenderShapeCommand
-	RenderShapeCommand::RenderShapeCommand(Renderable* const renderable, ShaderProgram* const program, const math::mat4& viewProjectionMatrix, const ShapeRenderStyle style, const size_t capacity)
+	RenderShapeCommand::RenderShapeCommand(Renderable* const renderable, ShaderProgram* const program, CameraBuffer* const cameras, const uint32_t camera, const ShapeRenderStyle style, const size_t capacity, const VertexBuffer::Range& range)
 		: RenderCommand()
-		, m_capacity(capacity)
-		, m_data()
+		, m_capacity(range.data != nullptr ? capacity : 0)
+		, m_data(static_cast<float*>(range.data))
+		, m_range(range)
 		, m_program(program)
 		, m_renderable(renderable)
 		, m_size(0)
 		, m_style(style)
-		, m_viewProjectionMatrix(viewProjectionMatrix)
+		, m_cameras(cameras)
+		, m_camera(camera)
 	{
-		m_data.reserve(capacity * Vertex::size);
 	}
 
 	bool RenderShapeCommand::push(const Vertex& vertex)
 	{
 		if (m_size < m_capacity)
 		{
-			m_data.insert(m_data.end(), {
-				vertex.position.x, vertex.position.y, vertex.position.z,
-				vertex.color.red, vertex.color.green, vertex.color.blue, vertex.color.alpha
-				});
+			writeVertex(vertex, m_data + m_size * Vertex::size);
 			++m_size;
 			return true;
 		}
 		return false;
 	}
 
+	void RenderShapeCommand::close()
+	{
+		if (m_range.mapped && m_renderable != nullptr)
+		{
+			m_renderable->findVertexBuffer(Renderable::names::MainBuffer)->commit(m_size * Vertex::size * sizeof(float));
+		}
+	}
+
 	RenderCommandResult RenderShapeCommand::execute()
 	{
 		if (m_renderable == nullptr
 			|| m_program == nullptr
 			|| !m_program->isValid()
-			|| m_data.empty()) return RenderCommandResult::Invalid;
+			|| m_size == 0) return RenderCommandResult::Invalid;
 
 		m_renderable->bind();
 
 		VertexBuffer* vertexBuffer = m_renderable->findVertexBuffer(Renderable::names::MainBuffer);
 		vertexBuffer->bind();
-		vertexBuffer->fillData((void*)&m_data[0], m_data.size() * sizeof(float));
+		size_t dataOffset = 0;
+		if (!upload(*vertexBuffer, m_range, m_size * Vertex::size * sizeof(float), dataOffset)) return RenderCommandResult::Invalid;
+		vertexBuffer->activateLayout(dataOffset);
 
 		m_program->bind();
-		m_program->set("u_matrix", m_viewProjectionMatrix);
+		m_cameras->bind(m_camera);
 
 		const int primitiveType = m_style == ShapeRenderStyle::fill ? GL_TRIANGLES : GL_LINES;
 		const int offset = 0;
-		const int count = static_cast<int>(m_data.size()) / static_cast<int>(Vertex::size);
+		const int count = static_cast<int>(m_size);
 
 		glDrawArrays(primitiveType, offset, count);
 		return RenderCommandResult::OK;
 	}
 
+	// RenderShapeStripCommand
+	RenderShapeStripCommand::RenderShapeStripCommand(Renderable* const renderable, ShaderProgram* const program, CameraBuffer* const cameras, const uint32_t camera, const size_t capacity, const VertexBuffer::Range& range, uint32_t* const indices)
+		: RenderCommand()
+		, m_capacity(range.data != nullptr && indices != nullptr ? capacity : 0)
+		, m_data(static_cast<float*>(range.data))
+		, m_range(range)
+		, m_indices(indices)
+		, m_numOfIndices(0)
+		, m_program(program)
+		, m_renderable(renderable)
+		, m_size(0)
+		, m_cameras(cameras)
+		, m_camera(camera)
+	{
+	}
+
+	bool RenderShapeStripCommand::hasCapacity(const size_t numOfVertices, const size_t numOfIndices) const
+	{
+		// two more indices to join the strip to the previous one
+		return m_capacity - m_size >= numOfVertices
+			&& 2 * m_capacity - m_numOfIndices >= numOfIndices + 2;
+	}
+
+	bool RenderShapeStripCommand::push(const Vertex* const vertices, const size_t numOfVertices, const uint32_t* const indices, const size_t numOfIndices)
+	{
+		if (numOfVertices == 0 || numOfIndices == 0 || !hasCapacity(numOfVertices, numOfIndices)) return false;
+
+		const uint32_t base = static_cast<uint32_t>(m_size);
+		if (m_numOfIndices > 0)
+		{
+			// repeat the last index and the next one, the triangles in between have no area
+			m_indices[m_numOfIndices] = m_indices[m_numOfIndices - 1];
+			m_indices[m_numOfIndices + 1] = base + indices[0];
+			m_numOfIndices += 2;
+		}
+
+		for (size_t i = 0; i < numOfVertices; ++i)
+		{
+			writeVertex(vertices[i], m_data + (m_size + i) * Vertex::size);
+		}
+		for (size_t i = 0; i < numOfIndices; ++i)
+		{
+			m_indices[m_numOfIndices + i] = base + indices[i];
+		}
+		m_size += numOfVertices;
+		m_numOfIndices += numOfIndices;
+		return true;
+	}
+
+	void RenderShapeStripCommand::close()
+	{
+		if (m_range.mapped && m_renderable != nullptr)
+		{
+			m_renderable->findVertexBuffer(Renderable::names::MainBuffer)->commit(m_size * Vertex::size * sizeof(float));
+		}
+	}
+
+	RenderCommandResult RenderShapeStripCommand::execute()
+	{
+		if (m_renderable == nullptr
+			|| m_program == nullptr
+			|| !m_program->isValid()
+			|| m_size == 0) return RenderCommandResult::Invalid;
+
+		m_renderable->bind();
+
+		VertexBuffer* vertexBuffer = m_renderable->findVertexBuffer(Renderable::names::MainBuffer);
+		vertexBuffer->bind();
+		size_t dataOffset = 0;
+		if (!upload(*vertexBuffer, m_range, m_size * Vertex::size * sizeof(float), dataOffset)) return RenderCommandResult::Invalid;
+		vertexBuffer->activateLayout(dataOffset);
+
+		IndexBuffer* indexBuffer = m_renderable->findIndexBuffer(Renderable::names::MainBuffer);
+		indexBuffer->bind();
+		size_t indexOffset = 0;
+		if (!indexBuffer->stream(m_indices, m_numOfIndices * sizeof(uint32_t), indexOffset)) return RenderCommandResult::Invalid;
+
+		m_program->bind();
+		m_cameras->bind(m_camera);
+
+		const int primitiveType = GL_TRIANGLE_STRIP;
+		const int count = static_cast<int>(m_numOfIndices);
+		const int indexType = GL_UNSIGNED_INT;
+
+		glDrawElements(primitiveType, count, indexType, reinterpret_cast<const void*>(indexOffset));
+		return RenderCommandResult::OK;
+	}
+
+	// RenderShapeInstanceCommand
+	RenderShapeInstanceCommand::RenderShapeInstanceCommand(Renderable* const renderable, ShaderProgram* const program, CameraBuffer* const cameras, const uint32_t camera, const size_t capacity, const VertexBuffer::Range& range)
+		: RenderCommand()
+		, m_capacity(range.data != nullptr ? capacity : 0)
+		, m_data(static_cast<unsigned char*>(range.data))
+		, m_range(range)
+		, m_program(program)
+		, m_renderable(renderable)
+		, m_size(0)
+		, m_cameras(cameras)
+		, m_camera(camera)
+	{
+	}
+
+	bool RenderShapeInstanceCommand::push(const ShapeInstance& shape)
+	{
+		if (m_size < m_capacity)
+		{
+			PackedShapeInstance& instance = *reinterpret_cast<PackedShapeInstance*>(m_data + m_size * sizeof(PackedShapeInstance));
+			instance.position[0] = shape.position.x;
+			instance.position[1] = shape.position.y;
+			instance.position[2] = shape.position.z;
+			instance.extent[0] = shape.extent.x;
+			instance.extent[1] = shape.extent.y;
+			instance.rotation = shape.rotation;
+			instance.radius = shape.radius;
+			instance.strokeWidth = shape.strokeWidth;
+			packColor(shape.fillColor, instance.fillColor);
+			packColor(shape.strokeColor, instance.strokeColor);
+			instance.type = static_cast<uint32_t>(shape.type) | (shape.strokeInPixels ? 1u << 8 : 0u);
+			++m_size;
+			return true;
+		}
+		return false;
+	}
+
+	void RenderShapeInstanceCommand::close()
+	{
+		if (m_range.mapped && m_renderable != nullptr)
+		{
+			m_renderable->findVertexBuffer("data")->commit(m_size * sizeof(PackedShapeInstance));
+		}
+	}
+
+	RenderCommandResult RenderShapeInstanceCommand::execute()
+	{
+		if (m_renderable == nullptr
+			|| m_program == nullptr
+			|| !m_program->isValid()
+			|| m_size == 0) return RenderCommandResult::Invalid;
+
+		m_renderable->bind();
+
+		VertexBuffer& data = *m_renderable->findVertexBuffer("data");
+		data.bind();
+		size_t dataOffset = 0;
+		if (!upload(data, m_range, m_size * sizeof(PackedShapeInstance), dataOffset)) return RenderCommandResult::Invalid;
+		data.activateLayout(dataOffset);
+
+		m_program->bind();
+		m_cameras->bind(m_camera);
+
+		const int primitiveType = GL_TRIANGLES;
+		const int offset = 0;
+		const int count = 6;
+		const int numInstances = static_cast<int>(m_size);
+		const int indexType = GL_UNSIGNED_INT;
+
+		glDrawElementsInstanced(primitiveType, count, indexType, offset, numInstances);
+		return RenderCommandResult::OK;
+	}
+
 	// RenderTextCommand
-	RenderTextCommand::RenderTextCommand(Renderable* const renderable, ShaderProgram* const program, const math::mat4& viewProjectionMatrix, const size_t capacity)
+	RenderTextCommand::RenderTextCommand(Renderable* const renderable, ShaderProgram* const program, CameraBuffer* const cameras, const uint32_t camera, const SpriteFormat format, const size_t capacity, const VertexBuffer::Range& range)
 		: RenderCommand()
-		, m_capacity(capacity)
-		, m_data()
+		, m_capacity(range.data != nullptr ? capacity : 0)
+		, m_format(format)
+		, m_data(static_cast<unsigned char*>(range.data))
+		, m_range(range)
 		, m_fonts()
+		, m_numOfFonts(0)
 		, m_program(program)
 		, m_renderable(renderable)
 		, m_size(0)
-		, m_viewProjectionMatrix(viewProjectionMatrix)
+		, m_cameras(cameras)
+		, m_camera(camera)
 	{
-		m_data.reserve(capacity * (SpriteVertex::size + 1));
-		m_fonts.reserve(max_font_units);
 	}
 
 	bool RenderTextCommand::hasCapacity(Font* const font) const
 	{
-		const auto& it = std::find(m_fonts.begin(), m_fonts.end(), font);
-		return it != m_fonts.end() || m_fonts.size() < max_font_units;
+		const auto& end = m_fonts.begin() + m_numOfFonts;
+		return std::find(m_fonts.begin(), end, font) != end || m_numOfFonts < max_font_units;
 	}
 
 	bool RenderTextCommand::push(const SpriteVertex& vertex, Font* const font)
 	{
-		static const auto& findIndex = [](Font* const font, std::vector<Font*>& fonts) -> int
-		{
-			for (int i = 0; i < fonts.size(); ++i)
-			{
-				if (fonts[i] == font) return i;
-			}
-
-			fonts.push_back(font);
-			return static_cast<int>(fonts.size()) - 1;
-		};
-
 		if (m_size < m_capacity && font != nullptr)
 		{
-			const float textureIndex = static_cast<float>(findIndex(font, m_fonts));
-			m_data.insert(m_data.end(), {
-				textureIndex,
-				vertex.rect.x, vertex.rect.y, vertex.rect.width, vertex.rect.height,
-				vertex.color.red, vertex.color.green, vertex.color.blue, vertex.color.alpha
-				});
-			m_data.insert(m_data.end(), vertex.transform.data, vertex.transform.data + vertex.transform.length);
+			const size_t fontIndex = findIndex(font, m_fonts, m_numOfFonts);
+			if (fontIndex >= max_font_units) return false;
+
+			writeInstance(m_data + m_size * getInstanceSize(m_format), m_format, fontIndex, vertex);
 			++m_size;
 			return true;
 		}
 		return false;
 	}
 
+	void RenderTextCommand::close()
+	{
+		if (m_range.mapped && m_renderable != nullptr)
+		{
+			m_renderable->findVertexBuffer("data")->commit(m_size * getInstanceSize(m_format));
+		}
+	}
+
 	RenderCommandResult RenderTextCommand::execute()
 	{
 		if (m_renderable == nullptr
 			|| m_program == nullptr
 			|| !m_program->isValid()
-			|| m_fonts.empty()
-			|| m_data.empty()) return RenderCommandResult::Invalid;
+			|| m_numOfFonts == 0
+			|| m_size == 0) return RenderCommandResult::Invalid;
 
 		m_renderable->bind();
 
 		VertexBuffer& data = *m_renderable->findVertexBuffer("data");
 		data.bind();
-		data.fillData((void*)&m_data[0], m_data.size() * sizeof(float));
+		size_t dataOffset = 0;
+		if (!upload(data, m_range, m_size * getInstanceSize(m_format), dataOffset)) return RenderCommandResult::Invalid;
+		data.activateLayout(dataOffset);
 
 		m_program->bind();
-		for (int i = 0; i < m_fonts.size(); ++i)
+		for (size_t i = 0; i < m_numOfFonts; ++i)
 		{
 			m_fonts[i]->texture->bind(i);
-			m_program->set("u_texture" + std::to_string(i), i);
 		}
-		m_program->set("u_matrix", m_viewProjectionMatrix);
+		m_cameras->bind(m_camera);
 
 		const int primitiveType = GL_TRIANGLES;
 		const int offset = 0;
@@ -144,75 +417,156 @@ namespace graphics
 	}
 
 	// RenderTextureCommand
-	RenderTextureCommand::RenderTextureCommand(Renderable* const renderable, ShaderProgram* const program, const math::mat4& viewProjectionMatrix, const size_t capacity)
+	RenderTextureCommand::RenderTextureCommand(Renderable* const renderable, ShaderProgram* const program, CameraBuffer* const cameras, const uint32_t camera, const SpriteFormat format, const size_t capacity, const VertexBuffer::Range& range, const RenderPass pass)
 		: RenderCommand()
-		, m_capacity(capacity)
-		, m_data()
+		, m_capacity(range.data != nullptr ? capacity : 0)
+		, m_format(format)
+		, m_data(static_cast<unsigned char*>(range.data))
+		, m_range(range)
 		, m_program(program)
 		, m_renderable(renderable)
 		, m_size(0)
 		, m_textures()
-		, m_viewProjectionMatrix(viewProjectionMatrix)
+		, m_numOfTextures(0)
+		, m_cameras(cameras)
+		, m_camera(camera)
+		, m_pass(pass)
 	{
-		m_data.reserve(capacity * (SpriteVertex::size + 1));
-		m_textures.reserve(max_texture_units);
 	}
 
 	bool RenderTextureCommand::hasCapacity(Texture* const texture) const
 	{
-		const auto& it = std::find(m_textures.begin(), m_textures.end(), texture);
-		return it != m_textures.end() || m_textures.size() < max_texture_units;
+		// the batch is drawn with a single blend function
+		if (m_numOfTextures > 0 && texture->isPremultiplied() != isPremultiplied()) return false;
+
+		const auto& end = m_textures.begin() + m_numOfTextures;
+		return std::find(m_textures.begin(), end, texture) != end || m_numOfTextures < max_texture_units;
+	}
+
+	bool RenderTextureCommand::isPremultiplied() const
+	{
+		return m_numOfTextures > 0 && m_textures[0]->isPremultiplied();
 	}
 
 	bool RenderTextureCommand::push(const SpriteVertex& vertex, Texture* const texture)
 	{
-		static const auto& findIndex = [](Texture* const texture, std::vector<Texture*>& textures) -> int
+		if (m_size < m_capacity && texture != nullptr)
 		{
-			for (int i = 0; i < textures.size(); ++i)
-			{
-				if (textures[i] == texture) return i;
-			}
+			if (m_numOfTextures > 0 && texture->isPremultiplied() != isPremultiplied()) return false;
 
-			textures.push_back(texture);
-			return static_cast<int>(textures.size()) - 1;
-		};
+			const size_t textureIndex = findIndex(texture, m_textures, m_numOfTextures);
+			if (textureIndex >= max_texture_units) return false;
 
-		if (m_size < m_capacity && texture != nullptr)
-		{
-			const float textureIndex = static_cast<float>(findIndex(texture, m_textures));
-			m_data.insert(m_data.end(), {
-				textureIndex,
-				vertex.rect.x, vertex.rect.y, vertex.rect.width, vertex.rect.height,
-				vertex.color.red, vertex.color.green, vertex.color.blue, vertex.color.alpha
-				});
-			m_data.insert(m_data.end(), vertex.transform.data, vertex.transform.data + vertex.transform.length);
+			writeInstance(m_data + m_size * getInstanceSize(m_format), m_format, textureIndex, vertex, texture->isPremultiplied());
 			++m_size;
 			return true;
 		}
 		return false;
 	}
 
+	void RenderTextureCommand::close()
+	{
+		if (m_range.mapped && m_renderable != nullptr)
+		{
+			m_renderable->findVertexBuffer("data")->commit(m_size * getInstanceSize(m_format));
+		}
+	}
+
 	RenderCommandResult RenderTextureCommand::execute()
 	{
 		if (m_renderable == nullptr
 			|| m_program == nullptr
 			|| !m_program->isValid()
-			|| m_textures.empty()
-			|| m_data.empty()) return RenderCommandResult::Invalid;
+			|| m_numOfTextures == 0
+			|| m_size == 0) return RenderCommandResult::Invalid;
 
 		m_renderable->bind();
 
 		VertexBuffer& data = *m_renderable->findVertexBuffer("data");
 		data.bind();
-		data.fillData((void*)&m_data[0], m_data.size() * sizeof(float));
+		size_t dataOffset = 0;
+		if (!upload(data, m_range, m_size * getInstanceSize(m_format), dataOffset)) return RenderCommandResult::Invalid;
+		data.activateLayout(dataOffset);
 
 		m_program->bind();
-		for (int i = 0; i < m_textures.size(); ++i)
+		for (size_t i = 0; i < m_numOfTextures; ++i)
 		{
 			m_textures[i]->bind(i);
-			m_program->set("u_texture" + std::to_string(i), i);
 		}
-		m_program->set("u_matrix", m_viewProjectionMatrix);
+		m_cameras->bind(m_camera);
+
+		const int primitiveType = GL_TRIANGLES;
+		const int offset = 0;
+		const int count = 6;
+		const int numInstances = static_cast<int>(m_size);
+		const int indexType = GL_UNSIGNED_INT;
+
+		const bool premultiplied = isPremultiplied();
+		beginPass(m_pass, premultiplied);
+		glDrawElementsInstanced(primitiveType, count, indexType, offset, numInstances);
+		endPass(m_pass, premultiplied);
+		return RenderCommandResult::OK;
+	}
+
+	// RenderTextureArrayCommand
+	RenderTextureArrayCommand::RenderTextureArrayCommand(Renderable* const renderable, ShaderProgram* const program, CameraBuffer* const cameras, const uint32_t camera, const SpriteFormat format, const size_t capacity, const VertexBuffer::Range& range, const RenderPass pass)
+		: RenderCommand()
+		, m_capacity(range.data != nullptr ? capacity : 0)
+		, m_format(format)
+		, m_data(static_cast<unsigned char*>(range.data))
+		, m_range(range)
+		, m_program(program)
+		, m_renderable(renderable)
+		, m_size(0)
+		, m_textureArray(nullptr)
+		, m_cameras(cameras)
+		, m_camera(camera)
+		, m_pass(pass)
+	{
+	}
+
+	bool RenderTextureArrayCommand::push(const SpriteVertex& vertex, Texture* const texture)
+	{
+		if (m_size < m_capacity && texture != nullptr && texture->getArray() != nullptr)
+		{
+			if (!hasCapacity(texture->getArray())) return false;
+
+			m_textureArray = texture->getArray();
+			writeInstance(m_data + m_size * getInstanceSize(m_format), m_format, texture->getLayer(), vertex);
+			++m_size;
+			return true;
+		}
+		return false;
+	}
+
+	void RenderTextureArrayCommand::close()
+	{
+		if (m_range.mapped && m_renderable != nullptr)
+		{
+			m_renderable->findVertexBuffer("data")->commit(m_size * getInstanceSize(m_format));
+		}
+	}
+
+	RenderCommandResult RenderTextureArrayCommand::execute()
+	{
+		if (m_renderable == nullptr
+			|| m_program == nullptr
+			|| !m_program->isValid()
+			|| m_textureArray == nullptr
+			|| m_size == 0) return RenderCommandResult::Invalid;
+
+		m_renderable->bind();
+
+		VertexBuffer& data = *m_renderable->findVertexBuffer("data");
+		data.bind();
+		size_t dataOffset = 0;
+		if (!upload(data, m_range, m_size * getInstanceSize(m_format), dataOffset)) return RenderCommandResult::Invalid;
+		data.activateLayout(dataOffset);
+
+		m_program->bind();
+		// the sampler units are assigned by the program at link
+		m_textureArray->bind(std::max(m_program->getTextureUnit(textures_uniform), 0));
+		m_cameras->bind(m_camera);
 
 		const int primitiveType = GL_TRIANGLES;
 		const int offset = 0;
@@ -220,7 +574,57 @@ namespace graphics
 		const int numInstances = static_cast<int>(m_size);
 		const int indexType = GL_UNSIGNED_INT;
 
+		beginPass(m_pass);
+		glDrawElementsInstanced(primitiveType, count, indexType, offset, numInstances);
+		endPass(m_pass);
+		return RenderCommandResult::OK;
+	}
+
+	// RenderSpriteLayerCommand
+	RenderSpriteLayerCommand::RenderSpriteLayerCommand(Renderable* const renderable, ShaderProgram* const program, CameraBuffer* const cameras, const uint32_t camera, SpriteLayer* const layer)
+		: RenderCommand()
+		, m_renderable(renderable)
+		, m_program(program)
+		, m_layer(layer)
+		, m_cameras(cameras)
+		, m_camera(camera)
+	{
+	}
+
+	RenderCommandResult RenderSpriteLayerCommand::execute()
+	{
+		if (m_renderable == nullptr
+			|| m_program == nullptr
+			|| !m_program->isValid()
+			|| m_layer == nullptr
+			|| m_layer->empty()) return RenderCommandResult::Invalid;
+
+		m_renderable->bind();
+
+		// point the instance attributes to the data of the layer
+		VertexBuffer* const data = m_layer->upload();
+		data->activateLayout();
+
+		m_program->bind();
+		const auto& textures = m_layer->getTextures();
+		for (size_t i = 0; i < m_layer->getNumOfTextures(); ++i)
+		{
+			if (textures[i] == nullptr) continue;
+
+			textures[i]->bind(i);
+		}
+		m_cameras->bind(m_camera);
+
+		const int primitiveType = GL_TRIANGLES;
+		const int offset = 0;
+		const int count = 6;
+		const int numInstances = static_cast<int>(m_layer->size());
+		const int indexType = GL_UNSIGNED_INT;
+
+		const bool premultiplied = m_layer->isPremultiplied();
+		beginPass(RenderPass::Default, premultiplied);
 		glDrawElementsInstanced(primitiveType, count, indexType, offset, numInstances);
+		endPass(RenderPass::Default, premultiplied);
 		return RenderCommandResult::OK;
 	}
 }
\ No newline at end of file
@@ -0,0 +1,83 @@
+#include <vdtgraphics/render_queue.h>
+
+#include <algorithm>
+#include <array>
+
+namespace graphics
+{
+	RenderQueue::RenderQueue()
+		: m_items()
+		, m_buffer()
+	{
+	}
+
+	uint64_t RenderQueue::makeKey(const int layer, const uint8_t pipeline, const uint8_t blend, const uint32_t textureSet)
+	{
+		// bias the layer so that negative layers are sorted before the positive ones,
+		// the ones out of range are kept at the ends rather than wrapped around
+		const int clampedLayer = std::min(std::max(layer, -0x8000), 0x7fff);
+		const uint64_t biasedLayer = static_cast<uint64_t>(clampedLayer + 0x8000);
+		return (biasedLayer << 48)
+			| (static_cast<uint64_t>(pipeline) << 40)
+			| (static_cast<uint64_t>(blend) << 32)
+			| static_cast<uint64_t>(textureSet);
+	}
+
+	uint8_t RenderQueue::getPipeline(const uint64_t key)
+	{
+		return static_cast<uint8_t>(key >> 40);
+	}
+
+	void RenderQueue::push(const uint64_t key, const uint32_t index)
+	{
+		m_items.push_back({ key, index });
+	}
+
+	const std::vector<RenderQueue::Item>& RenderQueue::sort()
+	{
+		static constexpr size_t num_passes = sizeof(uint64_t);
+		static constexpr size_t num_buckets = 256;
+
+		if (m_items.size() < 2) return m_items;
+
+		// build the histograms of every byte at once
+		std::array<std::array<size_t, num_buckets>, num_passes> histograms{};
+		for (const Item& item : m_items)
+		{
+			for (size_t pass = 0; pass < num_passes; ++pass)
+			{
+				++histograms[pass][(item.key >> (pass * 8)) & 0xFF];
+			}
+		}
+
+		m_buffer.resize(m_items.size());
+		for (size_t pass = 0; pass < num_passes; ++pass)
+		{
+			std::array<size_t, num_buckets>& histogram = histograms[pass];
+
+			// skip the bytes shared by all the keys, usually layer and blend state
+			const size_t firstBucket = (m_items.front().key >> (pass * 8)) & 0xFF;
+			if (histogram[firstBucket] == m_items.size()) continue;
+
+			size_t offset = 0;
+			for (size_t& count : histogram)
+			{
+				const size_t bucketSize = count;
+				count = offset;
+				offset += bucketSize;
+			}
+
+			for (const Item& item : m_items)
+			{
+				m_buffer[histogram[(item.key >> (pass * 8)) & 0xFF]++] = item;
+			}
+			m_items.swap(m_buffer);
+		}
+		return m_items;
+	}
+
+	void RenderQueue::clear()
+	{
+		m_items.clear();
+	}
+}
@@ -2,6 +2,7 @@
 
 #include <glad/glad.h>
 
+#include <vdtgraphics/gl_state_cache.h>
 #include <vdtgraphics/texture.h>
 
 namespace graphics
@@ -12,7 +13,7 @@ namespace graphics
 		, m_color(color)
 	{
 		glGenFramebuffers(1, &m_id);
-		glBindFramebuffer(GL_FRAMEBUFFER, m_id);
+		GLStateCache::get().bindFramebuffer(m_id);
 
 		// create the color buffer
 		m_texture = std::make_unique<Texture>(nullptr, width, height, 3);
@@ -36,11 +37,12 @@ namespace graphics
 			m_state = State::Ready;
 		}
 
-		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		GLStateCache::get().bindFramebuffer(0);
 	}
 
 	RenderTarget::~RenderTarget()
 	{
+		GLStateCache::get().onFramebufferDeleted(m_id);
 		glDeleteFramebuffers(1, &m_id);
 	}
 
@@ -1,10 +1,10 @@
 #include <vdtgraphics/renderable.h>
 
+#include <vdtgraphics/gl_state_cache.h>
 #include <vdtgraphics/index_buffer.h>
 #include <vdtgraphics/vertex_buffer.h>
 
 #include <glad/glad.h>
-
 namespace graphics
 {
 	Renderable::Renderable()
@@ -23,7 +23,7 @@ namespace graphics
 
 	void Renderable::bind(const bool forceBinding)
 	{
-		glBindVertexArray(m_id);
+		GLStateCache::get().bindVertexArray(m_id);
 		if (!m_binded || forceBinding)
 		{
 			for (auto& pair : m_vertexBuffers)
@@ -41,11 +41,12 @@ namespace graphics
 
 	void Renderable::unbind()
 	{
-		glBindVertexArray(0);
+		GLStateCache::get().bindVertexArray(0);
 	}
 
 	void Renderable::free()
 	{
+		GLStateCache::get().onVertexArrayDeleted(m_id);
 		glDeleteVertexArrays(1, &m_id);
 		for (auto& pair : m_vertexBuffers)
 		{
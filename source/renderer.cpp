@@ -1,11 +1,15 @@
 #include <vdtgraphics/renderer.h>
 
+#include <algorithm>
+
 #include <glad/glad.h>
 
 #include <vdtgraphics/context.h>
 #include <vdtgraphics/font.h>
+#include <vdtgraphics/gl_state_cache.h>
 #include <vdtgraphics/image.h>
 #include <vdtgraphics/index_buffer.h>
+#include <vdtgraphics/program_cache.h>
 #include <vdtgraphics/renderable.h>
 #include <vdtgraphics/render_command.h>
 #include <vdtgraphics/render_commands.h>
@@ -13,12 +17,41 @@
 #include <vdtgraphics/shader.h>
 #include <vdtgraphics/shader_library.h>
 #include <vdtgraphics/shader_program.h>
+#include <vdtgraphics/spatial_sprite_index.h>
+#include <vdtgraphics/sprite_layer.h>
 #include <vdtgraphics/texture.h>
+#include <vdtgraphics/texture_array.h>
 #include <vdtgraphics/vertex_buffer.h>
 
 namespace graphics
 {
-	bool Renderer::init(Context* const context)
+	namespace
+	{
+		// the sources of the pipeline program in the library
+		bool readSources(const ShaderLibrary& library, const Renderer::Pipeline pipeline, std::string& name, std::map<Shader::Type, std::string>& sources)
+		{
+			static const std::string* const names[] = {
+				&ShaderLibrary::names::ColorShader,
+				&ShaderLibrary::names::PolygonBatchShader,
+				&ShaderLibrary::names::ShapeShader,
+				&ShaderLibrary::names::TextShader,
+				&ShaderLibrary::names::TextCompactShader,
+				&ShaderLibrary::names::SpriteBatchShader,
+				&ShaderLibrary::names::SpriteBatchCompactShader,
+				&ShaderLibrary::names::SpriteArrayShader,
+				&ShaderLibrary::names::SpriteArrayCompactShader,
+				&ShaderLibrary::names::TextureShader
+			};
+			static_assert(sizeof(names) / sizeof(names[0]) == static_cast<size_t>(Renderer::Pipeline::Count), "missing pipeline shader");
+
+			name = *names[static_cast<size_t>(pipeline)];
+			auto it = library.getShaders().find(name);
+			return it != library.getShaders().end()
+				&& Shader::Reader::parse(it->second, sources);
+		}
+	}
+
+	bool Renderer::init(Context* const context, ProgramCache* const programCache)
 	{
 		if (context == nullptr || context->getState() != Context::State::Initialized)
 		{
@@ -26,70 +59,95 @@ namespace graphics
 		}
 
 		m_shaderLibrary = std::make_unique<ShaderLibrary>();
-
-		// color
+		// the programs are compiled by the first draws using them, see prewarm
+		m_programCache = programCache;
+		m_cameraBuffer = std::make_unique<CameraBuffer>();
 		{
-			m_colorProgram = createProgram(ShaderLibrary::names::ColorShader);
+			int viewport[4]{};
+			glGetIntegerv(GL_VIEWPORT, viewport);
+			m_viewport[0] = static_cast<float>(viewport[2]);
+			m_viewport[1] = static_cast<float>(viewport[3]);
 		}
+
 		// shapes
-		m_shapeProgram = createProgram(ShaderLibrary::names::PolygonBatchShader);
 		// fill
 		{
 			m_shapeFillRenderable = std::make_unique<Renderable>();
-			VertexBuffer& vb = *m_shapeFillRenderable->addVertexBuffer(Renderable::names::MainBuffer, Vertex::size * 10000 * sizeof(float), BufferUsageMode::Static);
+			VertexBuffer& vb = *m_shapeFillRenderable->addVertexBuffer(Renderable::names::MainBuffer, Vertex::size * shape_batch_capacity * streaming_batches * sizeof(float), BufferUsageMode::Ring);
 			VertexBufferLayout& layout = vb.layout;
 			layout.push(VertexBufferElement("position", VertexBufferElement::Type::Float, 3));
 			layout.push(VertexBufferElement("color", VertexBufferElement::Type::Float, 4));
+			m_streamingBuffers.push_back(&vb);
 		}
 		// stroke
 		{
 			m_shapeStrokeRenderable = std::make_unique<Renderable>();
-			VertexBuffer& vb = *m_shapeStrokeRenderable->addVertexBuffer(Renderable::names::MainBuffer, Vertex::size * 10000 * sizeof(float), BufferUsageMode::Static);
+			VertexBuffer& vb = *m_shapeStrokeRenderable->addVertexBuffer(Renderable::names::MainBuffer, Vertex::size * shape_batch_capacity * streaming_batches * sizeof(float), BufferUsageMode::Ring);
 			VertexBufferLayout& layout = vb.layout;
 			layout.push(VertexBufferElement("position", VertexBufferElement::Type::Float, 3));
 			layout.push(VertexBufferElement("color", VertexBufferElement::Type::Float, 4));
+			m_streamingBuffers.push_back(&vb);
 		}
-		// text
+		// strokes, as indexed triangle strips
+		{
+			m_shapeStripRenderable = std::make_unique<Renderable>();
+			VertexBuffer& vb = *m_shapeStripRenderable->addVertexBuffer(Renderable::names::MainBuffer, Vertex::size * shape_strip_batch_capacity * streaming_batches * sizeof(float), BufferUsageMode::Ring);
+			VertexBufferLayout& layout = vb.layout;
+			layout.push(VertexBufferElement("position", VertexBufferElement::Type::Float, 3));
+			layout.push(VertexBufferElement("color", VertexBufferElement::Type::Float, 4));
+			m_streamingBuffers.push_back(&vb);
+			m_shapeStripRenderable->addIndexBuffer(Renderable::names::MainBuffer, 2 * shape_strip_batch_capacity * streaming_batches * sizeof(uint32_t), BufferUsageMode::Stream);
+		}
+		// shapes drawn by their distance function
 		{
-			m_textProgram = createProgram(ShaderLibrary::names::TextShader);
-
 			float vertices[] =
 			{
-				 0.5f, -0.5f, 0.0f, 1.0f, 1.0f,
-				 0.5f,  0.5f, 0.0f, 1.0f, 0.0f,
-				-0.5f,  0.5f, 0.0f, 0.0f, 0.0f,
-				-0.5f, -0.5f, 0.0f, 0.0f, 1.0f
+				 0.5f, -0.5f,
+				 0.5f,  0.5f,
+				-0.5f,  0.5f,
+				-0.5f, -0.5f
 			};
 
 			unsigned int indices[] = {
 				0, 1, 3, 1, 2, 3
 			};
 
-			m_textRenderable = std::make_unique<Renderable>();
-			VertexBuffer& vb = *m_textRenderable->addVertexBuffer(Renderable::names::MainBuffer, sizeof(vertices), BufferUsageMode::Static);
+			m_shapeInstanceRenderable = std::make_unique<Renderable>();
+			VertexBuffer& vb = *m_shapeInstanceRenderable->addVertexBuffer(Renderable::names::MainBuffer, sizeof(vertices), BufferUsageMode::Static);
 			vb.fillData(vertices, sizeof(vertices));
-			VertexBufferLayout& layout = vb.layout;
-			layout.push(VertexBufferElement("position", VertexBufferElement::Type::Float, 3));
-			layout.push(VertexBufferElement("coords", VertexBufferElement::Type::Float, 2));
-			IndexBuffer& ib = *m_textRenderable->addIndexBuffer(Renderable::names::MainBuffer, sizeof(indices), BufferUsageMode::Static);
+			vb.layout.push(VertexBufferElement("position", VertexBufferElement::Type::Float, 2));
+			IndexBuffer& ib = *m_shapeInstanceRenderable->addIndexBuffer(Renderable::names::MainBuffer, sizeof(indices), BufferUsageMode::Static);
 			ib.fillData(indices, sizeof(indices));
 
-			VertexBuffer& dataBuffer = *m_textRenderable->addVertexBuffer("data", SpriteVertex::size * 10000 * sizeof(float), BufferUsageMode::Stream);
-			dataBuffer.layout.push(VertexBufferElement("texture", VertexBufferElement::Type::Float, 1, true, true));
-			dataBuffer.layout.push(VertexBufferElement("crop", VertexBufferElement::Type::Float, 4, true, true));
-			dataBuffer.layout.push(VertexBufferElement("color", VertexBufferElement::Type::Float, 4, true, true));
-			dataBuffer.layout.push(VertexBufferElement("transform", VertexBufferElement::Type::Float, 4, true, true));
-			dataBuffer.layout.push(VertexBufferElement("transform", VertexBufferElement::Type::Float, 4, true, true));
-			dataBuffer.layout.push(VertexBufferElement("transform", VertexBufferElement::Type::Float, 4, true, true));
-			dataBuffer.layout.push(VertexBufferElement("transform", VertexBufferElement::Type::Float, 4, true, true));
-			dataBuffer.layout.startingIndex = 2;
+			VertexBuffer& dataBuffer = *m_shapeInstanceRenderable->addVertexBuffer("data", ShapeInstance::size * sizeof(float) * sprite_batch_capacity * streaming_batches, BufferUsageMode::Ring);
+			dataBuffer.layout.push(VertexBufferElement("position", VertexBufferElement::Type::Float, 3, true, true));
+			dataBuffer.layout.push(VertexBufferElement("extent", VertexBufferElement::Type::Float, 2, true, true));
+			dataBuffer.layout.push(VertexBufferElement("rotation", VertexBufferElement::Type::Float, 1, true, true));
+			dataBuffer.layout.push(VertexBufferElement("radius", VertexBufferElement::Type::Float, 1, true, true));
+			dataBuffer.layout.push(VertexBufferElement("strokeWidth", VertexBufferElement::Type::Float, 1, true, true));
+			dataBuffer.layout.push(VertexBufferElement("fillColor", VertexBufferElement::Type::UnsignedByte, 4, true, true));
+			dataBuffer.layout.push(VertexBufferElement("strokeColor", VertexBufferElement::Type::UnsignedByte, 4, true, true));
+			dataBuffer.layout.push(VertexBufferElement("type", VertexBufferElement::Type::UnsignedInteger, 1, false, true));
+			dataBuffer.layout.startingIndex = 1;
+			m_streamingBuffers.push_back(&dataBuffer);
 
-			m_textRenderable->bind();
+			m_shapeInstanceRenderable->bind();
 		}
-		// textures
+		// text
 		{
-			m_spriteProgram = createProgram(ShaderLibrary::names::SpriteBatchShader);
+			const std::vector<float> vertices =
+			{
+				 0.5f, -0.5f, 0.0f, 1.0f, 1.0f,
+				 0.5f,  0.5f, 0.0f, 1.0f, 0.0f,
+				-0.5f,  0.5f, 0.0f, 0.0f, 0.0f,
+				-0.5f, -0.5f, 0.0f, 0.0f, 1.0f
+			};
 
+			m_textRenderable = createSpriteRenderable(vertices, SpriteFormat::Standard);
+			m_compactTextRenderable = createSpriteRenderable(vertices, SpriteFormat::Compact);
+		}
+		// textures
+		{
 			std::vector<float> vertices;
 			if (Image::flip_vertically)
 			{
@@ -110,53 +168,72 @@ namespace graphics
 				};
 			}
 
-			unsigned int indices[] = {
-				0, 1, 3, 1, 2, 3
-			};
+			m_textureRenderable = createSpriteRenderable(vertices, SpriteFormat::Standard);
+			m_compactTextureRenderable = createSpriteRenderable(vertices, SpriteFormat::Compact);
 
-			m_textureRenderable = std::make_unique<Renderable>();
-			VertexBuffer& vb = *m_textureRenderable->addVertexBuffer(Renderable::names::MainBuffer, vertices.size() * sizeof(float), BufferUsageMode::Static);
-			vb.fillData(&vertices[0], vertices.size() * sizeof(float));
-			VertexBufferLayout& layout = vb.layout;
-			layout.push(VertexBufferElement("position", VertexBufferElement::Type::Float, 3));
-			layout.push(VertexBufferElement("coords", VertexBufferElement::Type::Float, 2));
-			IndexBuffer& ib = *m_textureRenderable->addIndexBuffer(Renderable::names::MainBuffer, sizeof(indices), BufferUsageMode::Static);
-			ib.fillData(indices, sizeof(indices));
+			// texture arrays
+			m_textureArrayRenderable = createSpriteRenderable(vertices, SpriteFormat::Standard);
+			m_compactTextureArrayRenderable = createSpriteRenderable(vertices, SpriteFormat::Compact);
+		}
+		return true;
+	}
 
-			VertexBuffer& dataBuffer = *m_textureRenderable->addVertexBuffer("data", SpriteVertex::size * 10000 * sizeof(float), BufferUsageMode::Stream);
-			dataBuffer.layout.push(VertexBufferElement("texture", VertexBufferElement::Type::Float, 1, true, true));
-			dataBuffer.layout.push(VertexBufferElement("crop", VertexBufferElement::Type::Float, 4, true, true));
-			dataBuffer.layout.push(VertexBufferElement("color", VertexBufferElement::Type::Float, 4, true, true));
-			dataBuffer.layout.push(VertexBufferElement("transform", VertexBufferElement::Type::Float, 4, true, true));
-			dataBuffer.layout.push(VertexBufferElement("transform", VertexBufferElement::Type::Float, 4, true, true));
-			dataBuffer.layout.push(VertexBufferElement("transform", VertexBufferElement::Type::Float, 4, true, true));
-			dataBuffer.layout.push(VertexBufferElement("transform", VertexBufferElement::Type::Float, 4, true, true));
-			dataBuffer.layout.startingIndex = 2;
+	void Renderer::uninit()
+	{
+	}
 
-			m_textureRenderable->bind();
+	void Renderer::prewarm(const std::initializer_list<Pipeline>& pipelines)
+	{
+		for (const Pipeline pipeline : pipelines)
+		{
+			getProgram(pipeline);
 		}
-		// texture
+	}
+
+	void Renderer::prewarm()
+	{
+		for (size_t i = 0; i < static_cast<size_t>(Pipeline::Count); ++i)
 		{
-			m_textureProgram = createProgram(ShaderLibrary::names::TextureShader);
+			getProgram(static_cast<Pipeline>(i));
 		}
-		return true;
 	}
 
-	void Renderer::uninit()
+	bool Renderer::isPrewarmed()
 	{
+		finishPrograms();
+		return m_linkingPrograms.empty();
 	}
 
 	void Renderer::clear(const Color& color)
 	{
-		stats.drawCalls = 0;
+		stats = Stats();
+		getPolygonTriangulator().resetStats();
+		m_opaqueSprites.clear();
+		m_translucentSprites.clear();
+		if (m_cameraBuffer)
+		{
+			m_cameraBuffer->clear();
+		}
+		m_camera = CameraBuffer::invalid_index;
 		m_commands.clear();
+		m_ownedCommands.clear();
+		closeBatches();
+		m_commandList.clear();
+		{
+			std::lock_guard<std::mutex> lock(m_commandListsMutex);
+			m_commandLists.clear();
+		}
+		m_frameAllocator.reset();
 		glClearColor(color.red, color.green, color.blue, color.alpha);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 	}
 
 	void Renderer::setViewport(const int width, const int height)
 	{
-		glViewport(0, 0, width, height);
+		GLStateCache::get().setViewport(0, 0, width, height);
+		m_viewport[0] = static_cast<float>(width);
+		m_viewport[1] = static_cast<float>(height);
+		m_camera = CameraBuffer::invalid_index;
 	}
 
 	void Renderer::setWireframeMode(const bool enabled)
@@ -171,13 +248,44 @@ namespace graphics
 		}
 	}
 
+	void Renderer::setSortingEnabled(const bool enabled)
+	{
+		if (m_sortingEnabled && !enabled)
+		{
+			// keep the order of the draws already queued
+			resolveQueue();
+		}
+		m_sortingEnabled = enabled;
+	}
+
+	void Renderer::setOpaquePassEnabled(const bool enabled)
+	{
+		if (m_opaquePassEnabled && !enabled)
+		{
+			resolveQueue();
+			drawPasses();
+		}
+		m_opaquePassEnabled = enabled;
+	}
+
+	void Renderer::setSpriteFormat(const SpriteFormat format)
+	{
+		if (m_spriteFormat == format) return;
+
+		// queued draws must be batched with the format they were submitted with
+		resolveQueue();
+		drawPasses();
+		m_spriteFormat = format;
+		closeBatches();
+	}
+
 	void Renderer::setRenderTarget(RenderTarget* const renderTarget)
 	{
 		if (renderTarget == nullptr || !renderTarget->isValid())
 		{
 			// flush before switching target
 			flush();
-			glBindFramebuffer(GL_FRAMEBUFFER, 0);
+			GLStateCache::get().bindFramebuffer(0);
 			return;
 		}
 
@@ -186,7 +294,7 @@ namespace graphics
 			flush();
 		}
 
-		glBindFramebuffer(GL_FRAMEBUFFER, renderTarget->id());
+		GLStateCache::get().bindFramebuffer(renderTarget->id());
 		setViewport(renderTarget->getWidth(), renderTarget->getHeight());
 		clear(renderTarget->getColor());
 		m_renderTarget = renderTarget;
@@ -194,239 +302,731 @@ namespace graphics
 
 	void Renderer::setProjectionMatrix(const math::matrix4& m)
 	{
+		// queued draws must be batched with the matrix they were submitted with
+		resolveQueue();
+		drawPasses();
 		m_projectionMatrix = m;
 		m_viewProjectionMatrix = m_projectionMatrix * m_viewMatrix;
+		m_culler.setViewProjectionMatrix(m_viewProjectionMatrix);
+		m_camera = CameraBuffer::invalid_index;
+		// batches store the matrix they were created with
+		closeBatches();
 	}
 
 	void Renderer::setViewMatrix(const math::matrix4& m)
 	{
+		resolveQueue();
+		drawPasses();
 		m_viewMatrix = m;
 		m_viewProjectionMatrix = m_projectionMatrix * m_viewMatrix;
+		m_culler.setViewProjectionMatrix(m_viewProjectionMatrix);
+		m_camera = CameraBuffer::invalid_index;
+		closeBatches();
+	}
+
+	void Renderer::setTime(const float time)
+	{
+		m_time = time;
+		m_camera = CameraBuffer::invalid_index;
 	}
 
 	void Renderer::submit(std::unique_ptr<RenderCommand> command)
 	{
-		m_commands.push_back(std::move(command));
+		m_commands.push_back(command.get());
+		m_ownedCommands.push_back(std::move(command));
 	}
 
-	void Renderer::flush()
+	void Renderer::submit(const CommandList& commandList)
+	{
+		std::lock_guard<std::mutex> lock(m_commandListsMutex);
+		m_commandLists.push_back(&commandList);
+	}
+
+	void Renderer::submit(SpriteLayer& layer)
+	{
+		// keep the order with the batches submitted before and after the layer
+		drawPasses();
+		closeBatches();
+
+		const bool compact = layer.getFormat() == SpriteFormat::Compact;
+		m_commands.push_back(m_frameAllocator.create<RenderSpriteLayerCommand>(
+			compact ? m_compactTextureRenderable.get() : m_textureRenderable.get(),
+			getProgram(compact ? Pipeline::SpriteCompact : Pipeline::Sprite),
+			m_cameraBuffer.get(),
+			getCamera(),
+			&layer
+		));
+	}
+
+	void Renderer::submit(const SpatialSpriteIndex& index)
 	{
-		for (const auto& command : m_commands)
+		m_spriteHandles.clear();
+		if (m_cullingEnabled)
 		{
-			if (command->execute() == RenderCommandResult::OK)
+			index.query(m_culler, m_spriteHandles);
+			// the sprites of the cells out of the view are dropped without a test
+			stats.culledDraws += static_cast<int>(index.size() - m_spriteHandles.size());
+		}
+		else
+		{
+			index.query(VisibilityCuller(), m_spriteHandles);
+		}
+
+		for (const SpatialSpriteIndex::Handle handle : m_spriteHandles)
+		{
+			// already tested against the view
+			if (m_sortingEnabled)
 			{
-				++stats.drawCalls;
+				m_commandList.setLayer(m_layer);
+				m_commandList.pushSprite(index.getVertex(handle), index.getTexture(handle));
+			}
+			else
+			{
+				batchSprite(index.getVertex(handle), index.getTexture(handle));
 			}
 		}
-		m_commands.clear();
 	}
 
-	std::unique_ptr<ShaderProgram> Renderer::createProgram(const std::string& name)
+	void Renderer::flush()
 	{
-		std::map<Shader::Type, std::string> sources;
-		auto it = m_shaderLibrary->getShaders().find(name);
-		if (it != m_shaderLibrary->getShaders().end()
-			&& Shader::Reader::parse(it->second, sources))
+		stats.polygonCacheHits = static_cast<int>(getPolygonTriangulator().getHits());
+		stats.polygonCacheMisses = static_cast<int>(getPolygonTriangulator().getMisses());
+
+		resolveQueue();
+		drawPasses();
+		executeCommands();
+		// nothing refers to the frame data anymore
+		m_frameAllocator.reset();
+	}
+
+	ShaderProgram* Renderer::getProgram(const Pipeline pipeline)
+	{
+		std::unique_ptr<ShaderProgram>& program = m_programs[static_cast<size_t>(pipeline)];
+		if (program == nullptr)
 		{
-			Shader vs(Shader::Type::Vertex, sources.find(Shader::Type::Vertex)->second);
-			Shader fs(Shader::Type::Fragment, sources.find(Shader::Type::Fragment)->second);
-			return std::make_unique<ShaderProgram>(std::initializer_list<Shader*>{ &vs, & fs });
+			program = createProgram(pipeline);
 		}
-		return nullptr;
+		return program.get();
 	}
 
-	void Renderer::submitDrawCircle(const ShapeRenderStyle style, const math::vec3& position, float radius, const Color& color)
+	std::unique_ptr<ShaderProgram> Renderer::createProgram(const Pipeline pipeline)
 	{
-		static const unsigned int s_triangles = 20; // number of triangles
-		static const float s_twoPi = 2.0f * math::pi;
-		static const float s_delta = s_twoPi / s_triangles;
-
-		std::vector<Vertex> vertices;
-		vertices.reserve((style == ShapeRenderStyle::fill ? 3 : 2) * s_triangles);
+		std::string name;
+		std::map<Shader::Type, std::string> sources;
+		if (!readSources(*m_shaderLibrary, pipeline, name, sources)) return nullptr;
 
-		for (int i = 0; i < s_triangles; ++i)
+		std::unique_ptr<ShaderProgram> program = m_programCache != nullptr
+			? m_programCache->find(name, sources)
+			: nullptr;
+		if (program == nullptr)
 		{
-			const float angle = i * s_delta;
-			const float nextAngle = (i + 1) * s_delta;
+			// the link status is read once the program is bound or finished
+			program = ProgramCache::compile(sources, m_programCache != nullptr && ProgramCache::isSupported(), true);
+			if (program == nullptr) return nullptr;
+			m_linkingPrograms.push_back(pipeline);
+		}
+		program->bindUniformBlock(CameraBuffer::block_name, CameraBuffer::binding_point);
+		return program;
+	}
 
-			if (style == ShapeRenderStyle::fill)
+	void Renderer::finishPrograms()
+	{
+		for (auto it = m_linkingPrograms.begin(); it != m_linkingPrograms.end();)
+		{
+			ShaderProgram& program = *m_programs[static_cast<size_t>(*it)];
+			if (!program.isReady())
 			{
-				vertices.push_back({ position, color });
-				vertices.push_back({ position + math::vec3(radius * std::sin(angle), radius * std::cos(angle), 0.f), color });
-				vertices.push_back({ position + math::vec3(radius * std::sin(nextAngle), radius * std::cos(nextAngle), 0.f), color });
+				++it;
+				continue;
 			}
-			else
+
+			// the binary can be read only once linked
+			if (program.finish() == ShaderProgram::State::Linked && m_programCache != nullptr)
 			{
-				vertices.push_back({ position + math::vec3(radius * std::sin(angle), radius * std::cos(angle), 0.f), color });
-				vertices.push_back({ position + math::vec3(radius * std::sin(nextAngle), radius * std::cos(nextAngle), 0.f), color });
+				std::string name;
+				std::map<Shader::Type, std::string> sources;
+				if (readSources(*m_shaderLibrary, *it, name, sources))
+				{
+					m_programCache->store(name, sources, program);
+				}
 			}
+			it = m_linkingPrograms.erase(it);
 		}
-		submitDrawShape(style, vertices);
 	}
 
-	void Renderer::submitDrawLine(const math::vec3& point1, const Color& color1, const math::vec3& point2, const Color& color2)
+	std::unique_ptr<Renderable> Renderer::createSpriteRenderable(const std::vector<float>& vertices, const SpriteFormat format)
 	{
-		std::vector<Vertex> vertices = {
-			{ point1, color1 },
-			{ point2, color2 }
+		unsigned int indices[] = {
+			0, 1, 3, 1, 2, 3
 		};
-		submitDrawShape(ShapeRenderStyle::stroke, vertices);
+
+		std::unique_ptr<Renderable> renderable = std::make_unique<Renderable>();
+		VertexBuffer& vb = *renderable->addVertexBuffer(Renderable::names::MainBuffer, vertices.size() * sizeof(float), BufferUsageMode::Static);
+		vb.fillData(const_cast<float*>(&vertices[0]), vertices.size() * sizeof(float));
+		VertexBufferLayout& layout = vb.layout;
+		layout.push(VertexBufferElement("position", VertexBufferElement::Type::Float, 3));
+		layout.push(VertexBufferElement("coords", VertexBufferElement::Type::Float, 2));
+		IndexBuffer& ib = *renderable->addIndexBuffer(Renderable::names::MainBuffer, sizeof(indices), BufferUsageMode::Static);
+		ib.fillData(indices, sizeof(indices));
+
+		VertexBuffer& dataBuffer = *renderable->addVertexBuffer("data", getInstanceSize(format) * sprite_batch_capacity * streaming_batches, BufferUsageMode::Ring);
+		setInstanceLayout(format, dataBuffer.layout);
+		m_streamingBuffers.push_back(&dataBuffer);
+
+		renderable->bind();
+		return renderable;
 	}
 
-	void Renderer::submitDrawShape(const ShapeRenderStyle style, const std::vector<Vertex>& vertices)
+	RenderShapeCommand* const Renderer::getShapeCommand(const ShapeRenderStyle style, const size_t numOfVertices)
 	{
-		RenderShapeCommand* command = nullptr;
+		RenderShapeCommand*& command = style == ShapeRenderStyle::fill ? m_batches.shapeFill : m_batches.shapeStroke;
+		if (command == nullptr || !command->hasCapacity(numOfVertices))
+		{
+			if (command != nullptr)
+			{
+				command->close();
+			}
+
+			Renderable* const renderable = style == ShapeRenderStyle::fill ? m_shapeFillRenderable.get() : m_shapeStrokeRenderable.get();
+			const VertexBuffer::Range range = reserve(*renderable->findVertexBuffer(Renderable::names::MainBuffer), shape_batch_capacity * Vertex::size * sizeof(float));
+			command = m_frameAllocator.create<RenderShapeCommand>(
+				renderable,
+				getProgram(Pipeline::Shape),
+				m_cameraBuffer.get(),
+				getCamera(),
+				style,
+				shape_batch_capacity,
+				range
+			);
+			m_commands.push_back(command);
+		}
+		return command;
+	}
 
-		for (int i = static_cast<int>(m_commands.size()) - 1; i >= 0; --i)
+	RenderShapeInstanceCommand* const Renderer::getShapeInstanceCommand()
+	{
+		RenderShapeInstanceCommand*& command = m_batches.shapeInstance;
+		if (command == nullptr || !command->hasCapacity(1))
 		{
-			command = dynamic_cast<RenderShapeCommand*>(m_commands[i].get());
-			if (command != nullptr && command->getStyle() == style)
+			if (command != nullptr)
 			{
-				break;
+				command->close();
 			}
-			command = nullptr;
+
+			const VertexBuffer::Range range = reserve(*m_shapeInstanceRenderable->findVertexBuffer("data"), sprite_batch_capacity * ShapeInstance::size * sizeof(float));
+			command = m_frameAllocator.create<RenderShapeInstanceCommand>(
+				m_shapeInstanceRenderable.get(),
+				getProgram(Pipeline::ShapeInstance),
+				m_cameraBuffer.get(),
+				getCamera(),
+				sprite_batch_capacity,
+				range
+			);
+			m_commands.push_back(command);
 		}
+		return command;
+	}
 
-		if (command == nullptr || !command->hasCapacity(vertices.size()))
+	RenderShapeStripCommand* const Renderer::getShapeStripCommand(const size_t numOfVertices, const size_t numOfIndices)
+	{
+		static_assert(shape_strip_batch_capacity >= PolylineTessellator::max_strip_vertices
+			&& 2 * shape_strip_batch_capacity >= PolylineTessellator::max_strip_indices + 2,
+			"a polyline strip must fit in a batch");
+
+		RenderShapeStripCommand*& command = m_batches.shapeStrip;
+		if (command == nullptr || !command->hasCapacity(numOfVertices, numOfIndices))
 		{
-			command = new RenderShapeCommand(
-				style == ShapeRenderStyle::fill ? m_shapeFillRenderable.get() : m_shapeStrokeRenderable.get(),
-				m_shapeProgram.get(),
-				m_viewProjectionMatrix,
-				style,
-				1000
+			if (command != nullptr)
+			{
+				command->close();
+			}
+
+			const VertexBuffer::Range range = reserve(*m_shapeStripRenderable->findVertexBuffer(Renderable::names::MainBuffer), shape_strip_batch_capacity * Vertex::size * sizeof(float));
+			command = m_frameAllocator.create<RenderShapeStripCommand>(
+				m_shapeStripRenderable.get(),
+				getProgram(Pipeline::Shape),
+				m_cameraBuffer.get(),
+				getCamera(),
+				shape_strip_batch_capacity,
+				range,
+				m_frameAllocator.allocate<uint32_t>(2 * shape_strip_batch_capacity)
+			);
+			m_commands.push_back(command);
+		}
+		return command;
+	}
+
+	RenderTextCommand* const Renderer::getTextCommand(Font* const font, const size_t numOfGlyphs)
+	{
+		RenderTextCommand*& command = m_batches.text;
+		if (command == nullptr || !command->hasCapacity(numOfGlyphs) || !command->hasCapacity(font))
+		{
+			if (command != nullptr)
+			{
+				command->close();
+			}
+
+			const bool compact = m_spriteFormat == SpriteFormat::Compact;
+			Renderable* const renderable = compact ? m_compactTextRenderable.get() : m_textRenderable.get();
+			const VertexBuffer::Range range = reserve(*renderable->findVertexBuffer("data"), sprite_batch_capacity * getInstanceSize(m_spriteFormat));
+			command = m_frameAllocator.create<RenderTextCommand>(
+				renderable,
+				getProgram(compact ? Pipeline::TextCompact : Pipeline::Text),
+				m_cameraBuffer.get(),
+				getCamera(),
+				m_spriteFormat,
+				sprite_batch_capacity,
+				range
+			);
+			m_commands.push_back(command);
+		}
+		return command;
+	}
+
+	RenderTextureCommand* const Renderer::getTextureCommand(Texture* const texture)
+	{
+		RenderTextureCommand*& command = m_batches.texture;
+		if (command == nullptr || !command->hasCapacity(1) || !command->hasCapacity(texture))
+		{
+			if (command != nullptr)
+			{
+				command->close();
+			}
+
+			const bool compact = m_spriteFormat == SpriteFormat::Compact;
+			Renderable* const renderable = compact ? m_compactTextureRenderable.get() : m_textureRenderable.get();
+			const VertexBuffer::Range range = reserve(*renderable->findVertexBuffer("data"), sprite_batch_capacity * getInstanceSize(m_spriteFormat));
+			command = m_frameAllocator.create<RenderTextureCommand>(
+				renderable,
+				getProgram(compact ? Pipeline::SpriteCompact : Pipeline::Sprite),
+				m_cameraBuffer.get(),
+				getCamera(),
+				m_spriteFormat,
+				sprite_batch_capacity,
+				range,
+				m_pass
 			);
-			m_commands.push_back(std::unique_ptr<RenderShapeCommand>(command));
+			m_commands.push_back(command);
 		}
+		return command;
+	}
 
-		for (const auto& vertex : vertices)
+	RenderTextureArrayCommand* const Renderer::getTextureArrayCommand(TextureArray* const textureArray)
+	{
+		RenderTextureArrayCommand*& command = m_batches.textureArray;
+		if (command == nullptr || !command->hasCapacity(1) || !command->hasCapacity(textureArray))
 		{
-			command->push(vertex);
+			if (command != nullptr)
+			{
+				command->close();
+			}
+
+			const bool compact = m_spriteFormat == SpriteFormat::Compact;
+			Renderable* const renderable = compact ? m_compactTextureArrayRenderable.get() : m_textureArrayRenderable.get();
+			const VertexBuffer::Range range = reserve(*renderable->findVertexBuffer("data"), sprite_batch_capacity * getInstanceSize(m_spriteFormat));
+			command = m_frameAllocator.create<RenderTextureArrayCommand>(
+				renderable,
+				getProgram(compact ? Pipeline::SpriteArrayCompact : Pipeline::SpriteArray),
+				m_cameraBuffer.get(),
+				getCamera(),
+				m_spriteFormat,
+				sprite_batch_capacity,
+				range,
+				m_pass
+			);
+			m_commands.push_back(command);
 		}
+		return command;
 	}
 
-	void Renderer::submitDrawRect(const ShapeRenderStyle style, const math::vec3& position, float width, float height, const Color& color)
+	uint32_t Renderer::getCamera()
 	{
-		const float w = width / 2;
-		const float h = height / 2;
+		if (m_camera == CameraBuffer::invalid_index)
+		{
+			CameraBuffer::Block block;
+			block.view = m_viewMatrix;
+			block.projection = m_projectionMatrix;
+			block.viewProjection = m_viewProjectionMatrix;
+			block.viewport[0] = m_viewport[0];
+			block.viewport[1] = m_viewport[1];
+			block.time = m_time;
+			block.padding = 0.f;
+			m_camera = m_cameraBuffer->push(block);
+		}
+		return m_camera;
+	}
 
-		if (style == ShapeRenderStyle::fill)
+	void Renderer::batchShape(const ShapeRenderStyle style, const Vertex* const vertices, const size_t numOfVertices)
+	{
+		// split on whole primitives
+		const size_t primitiveSize = style == ShapeRenderStyle::fill ? 3 : 2;
+		const size_t chunkSize = shape_batch_capacity - shape_batch_capacity % primitiveSize;
+		for (size_t offset = 0; offset < numOfVertices; offset += chunkSize)
 		{
-			std::vector<Vertex> vertices = {
-				{ position + math::vec3(w, h, 0.f), color },
-				{ position + math::vec3(-w, h, 0.f), color },
-				{ position + math::vec3(-w, -h, 0.f), color },
-				{ position + math::vec3(-w, -h, 0.f), color },
-				{ position + math::vec3(w, -h, 0.f), color },
-				{ position + math::vec3(w, h, 0.f), color }
-			};
-			submitDrawShape(style, vertices);
+			const size_t count = std::min(chunkSize, numOfVertices - offset);
+			RenderShapeCommand* const command = getShapeCommand(style, count);
+			for (size_t i = offset; i < offset + count; ++i)
+			{
+				command->push(vertices[i]);
+			}
+		}
+	}
+
+	void Renderer::batchSprite(const SpriteVertex& vertex, Texture* const texture)
+	{
+		if (m_opaquePassEnabled && m_pass == RenderPass::Default)
+		{
+			const bool opaque = texture->isOpaque() && vertex.color.alpha >= 1.f;
+			(opaque ? m_opaqueSprites : m_translucentSprites).push_back({ getDepth(vertex), vertex, texture });
+			return;
+		}
+
+		// the layers of an array don't compete for the texture units
+		if (texture->getArray() != nullptr)
+		{
+			getTextureArrayCommand(texture->getArray())->push(vertex, texture);
 		}
 		else
 		{
-			std::vector<Vertex> vertices = {
-				{ position + math::vec3(w, h, 0.f), color },
-				{ position + math::vec3(-w, h, 0.f), color },
-				{ position + math::vec3(-w, h, 0.f), color },
-				{ position + math::vec3(-w, -h, 0.f), color },
-				{ position + math::vec3(-w, -h, 0.f), color },
-				{ position + math::vec3(w, -h, 0.f), color },
-				{ position + math::vec3(w, -h, 0.f), color },
-				{ position + math::vec3(w, h, 0.f), color }
-			};
-			submitDrawShape(style, vertices);
+			getTextureCommand(texture)->push(vertex, texture);
 		}
 	}
 
-	void Renderer::submitDrawText(Font* const font, const std::string& text, const math::vec3& position, const float scale, const Color& color)
+	void Renderer::drawPasses()
 	{
-		if (text.empty() || font == nullptr) return;
+		if (m_pass != RenderPass::Default
+			|| (m_opaqueSprites.empty() && m_translucentSprites.empty())) return;
 
-		RenderTextCommand* command = nullptr;
+		stats.opaqueSprites += static_cast<int>(m_opaqueSprites.size());
+		stats.translucentSprites += static_cast<int>(m_translucentSprites.size());
 
-		for (int i = static_cast<int>(m_commands.size()) - 1; i >= 0; --i)
+		const auto& draw = [this](const RenderPass pass, const std::vector<PassSprite>& sprites)
 		{
-			command = dynamic_cast<RenderTextCommand*>(m_commands[i].get());
-			if (command != nullptr && command->hasCapacity(font))
+			// the nearest depth is the smallest one, equal depths keep the submission order
+			m_passOrder.resize(sprites.size());
+			for (size_t i = 0; i < sprites.size(); ++i)
 			{
-				break;
+				m_passOrder[i] = static_cast<uint32_t>(i);
 			}
-			command = nullptr;
-		}
+			std::stable_sort(m_passOrder.begin(), m_passOrder.end(),
+				[&sprites, pass](const uint32_t a, const uint32_t b)
+				{
+					return pass == RenderPass::Opaque
+						? sprites[a].depth < sprites[b].depth
+						: sprites[a].depth > sprites[b].depth;
+				}
+			);
 
-		if (command == nullptr || !command->hasCapacity(1))
+			closeBatches();
+			m_pass = pass;
+			for (const uint32_t index : m_passOrder)
+			{
+				batchSprite(sprites[index].vertex, sprites[index].texture);
+			}
+			closeBatches();
+			m_pass = RenderPass::Default;
+		};
+
+		draw(RenderPass::Opaque, m_opaqueSprites);
+		draw(RenderPass::Translucent, m_translucentSprites);
+		m_opaqueSprites.clear();
+		m_translucentSprites.clear();
+	}
+
+	float Renderer::getDepth(const SpriteVertex& vertex) const
+	{
+		// the matrices are stored by columns
+		const float* const m = m_viewProjectionMatrix.data;
+		const float* const t = vertex.transform.data;
+		const float z = m[2] * t[12] + m[6] * t[13] + m[10] * t[14] + m[14];
+		const float w = m[3] * t[12] + m[7] * t[13] + m[11] * t[14] + m[15];
+		return w != 0.f ? z / w : z;
+	}
+
+	VertexBuffer::Range Renderer::reserve(VertexBuffer& buffer, const size_t size)
+	{
+		VertexBuffer::Range range;
+		if (buffer.isPersistent())
 		{
-			command = new RenderTextCommand(
-				m_textRenderable.get(),
-				m_textProgram.get(),
-				m_viewProjectionMatrix,
-				10000
-			);
-			m_commands.push_back(std::unique_ptr<RenderTextCommand>(command));
+			if (buffer.reserve(size, range))
+			{
+				return range;
+			}
+
+			// the buffer is full of this frame data, draw it to make room
+			executeCommands();
+			if (buffer.reserve(size, range))
+			{
+				return range;
+			}
 		}
 
-		float x = position.x;
-		for (const char c : text)
-		{
-			const auto& it = font->data.find(c);
-			if (it == font->data.end()) continue;
+		// copied into the buffer on execution
+		range.data = m_frameAllocator.allocate<float>(size / sizeof(float));
+		range.size = size;
+		return range;
+	}
 
-			const Glyph& glyph = it->second;
-			const float x_pos = x + glyph.bearing.x * scale;
-			const float y_pos = position.y + (glyph.size.y - glyph.bearing.y) * scale;
-			command->push({ math::matrix4::scale(math::vec3(glyph.size.x, glyph.size.y, 1.f) * scale) * math::matrix4::translate(math::vec3(x_pos, y_pos, position.z)), color, glyph.rect }, font);
+	void Renderer::closeBatches()
+	{
+		if (m_batches.shapeFill) m_batches.shapeFill->close();
+		if (m_batches.shapeStroke) m_batches.shapeStroke->close();
+		if (m_batches.shapeInstance) m_batches.shapeInstance->close();
+		if (m_batches.shapeStrip) m_batches.shapeStrip->close();
+		if (m_batches.text) m_batches.text->close();
+		if (m_batches.texture) m_batches.texture->close();
+		if (m_batches.textureArray) m_batches.textureArray->close();
+		m_batches = Batches();
+	}
 
-			x += scale * 0.25f + glyph.advance * scale;
+	void Renderer::executeCommands()
+	{
+		closeBatches();
+		if (m_cameraBuffer)
+		{
+			m_cameraBuffer->upload();
 		}
+		for (RenderCommand* const command : m_commands)
+		{
+			if (command->execute() == RenderCommandResult::OK)
+			{
+				++stats.drawCalls;
+			}
+		}
+		m_commands.clear();
+		m_ownedCommands.clear();
+
+		for (VertexBuffer* const buffer : m_streamingBuffers)
+		{
+			buffer->fence();
+		}
+		// the programs bound by the commands are linked by now
+		finishPrograms();
 	}
 
-	void Renderer::submitDrawTexture(Texture* const texture, const math::mat4& transform, const TextureRect& rect, const Color& color)
+	void Renderer::resolveQueue()
 	{
-		if (texture == nullptr) return;
+		std::lock_guard<std::mutex> lock(m_commandListsMutex);
+		if (m_commandList.empty() && m_commandLists.empty()) return;
+
+		// the merge must not depend on which thread submitted first,
+		// lists of the same order are taken in the order they were created
+		std::stable_sort(m_commandLists.begin(), m_commandLists.end(),
+			[](const CommandList* const a, const CommandList* const b)
+			{
+				if (a->getOrder() != b->getOrder()) return a->getOrder() < b->getOrder();
+				return a->getCreationIndex() < b->getCreationIndex();
+			}
+		);
+
+		if (m_sortingEnabled)
+		{
+			const auto& merge = [this](const CommandList& commandList)
+			{
+				// invisible draws are not even sorted
+				computeVisibility(commandList);
+				const std::vector<RenderQueue::Item>& items = commandList.getQueue().getItems();
+				for (size_t i = 0; i < items.size(); ++i)
+				{
+					if (!m_visibility[i]) continue;
+
+					m_mergeQueue.push(items[i].key, static_cast<uint32_t>(m_mergeItems.size()));
+					m_mergeItems.push_back(std::make_pair(&commandList, items[i].index));
+				}
+			};
 
-		RenderTextureCommand* command = nullptr;
+			merge(m_commandList);
+			for (const CommandList* const commandList : m_commandLists)
+			{
+				merge(*commandList);
+			}
 
-		for (int i = static_cast<int>(m_commands.size()) - 1; i >= 0; --i)
+			for (const RenderQueue::Item& item : m_mergeQueue.sort())
+			{
+				const auto& mergeItem = m_mergeItems[item.index];
+				resolve(*mergeItem.first, { item.key, mergeItem.second });
+			}
+			m_mergeQueue.clear();
+			m_mergeItems.clear();
+		}
+		else
 		{
-			command = dynamic_cast<RenderTextureCommand*>(m_commands[i].get());
-			if (command != nullptr && command->hasCapacity(texture))
+			for (const CommandList* const commandList : m_commandLists)
 			{
-				break;
+				computeVisibility(*commandList);
+				const std::vector<RenderQueue::Item>& items = commandList->getQueue().getItems();
+				for (size_t i = 0; i < items.size(); ++i)
+				{
+					if (m_visibility[i])
+					{
+						resolve(*commandList, items[i]);
+					}
+				}
 			}
-			command = nullptr;
 		}
 
-		if (command == nullptr || !command->hasCapacity(1))
+		m_commandList.clear();
+		m_commandLists.clear();
+	}
+
+	void Renderer::resolve(const CommandList& commandList, const RenderQueue::Item& item)
+	{
+		switch (static_cast<CommandList::Pipeline>(RenderQueue::getPipeline(item.key)))
+		{
+		case CommandList::Pipeline::ShapeFill:
+		case CommandList::Pipeline::ShapeStroke:
+		{
+			const CommandList::Shape& shape = commandList.getShapes()[item.index];
+			batchShape(shape.style, &commandList.getVertices()[shape.offset], shape.count);
+			break;
+		}
+		case CommandList::Pipeline::ShapeStrip:
 		{
-			command = new RenderTextureCommand(
-				m_textureRenderable.get(),
-				m_spriteProgram.get(),
-				m_viewProjectionMatrix,
-				10000
+			const CommandList::ShapeStrip& strip = commandList.getShapeStrips()[item.index];
+			getShapeStripCommand(strip.count, strip.indexCount)->push(
+				&commandList.getVertices()[strip.offset], strip.count,
+				&commandList.getIndices()[strip.indexOffset], strip.indexCount
 			);
-			m_commands.push_back(std::unique_ptr<RenderTextureCommand>(command));
+			break;
+		}
+		case CommandList::Pipeline::ShapeInstance:
+		{
+			getShapeInstanceCommand()->push(commandList.getShapeInstances()[item.index]);
+			break;
+		}
+		case CommandList::Pipeline::Text:
+		{
+			const CommandList::TextInstance& text = commandList.getTexts()[item.index];
+			getTextCommand(text.font, 1)->push(text.vertex, text.font);
+			break;
 		}
+		case CommandList::Pipeline::Texture:
+		default:
+		{
+			const CommandList::SpriteInstance& sprite = commandList.getSprites()[item.index];
+			batchSprite(sprite.vertex, sprite.texture);
+			break;
+		}
+		}
+	}
 
-		command->push({ transform, color, rect }, texture);
+	bool Renderer::cull(const VisibilityCuller::Bounds& bounds)
+	{
+		if (!m_cullingEnabled || m_culler.isVisible(bounds)) return false;
+
+		++stats.culledDraws;
+		return true;
 	}
 
-	void Renderer::submitDrawTexture(Texture* const texture, const math::vec3& position, const TextureRect& rect, const Color& color)
+	void Renderer::computeVisibility(const CommandList& commandList)
 	{
-		submitDrawTexture(texture, math::matrix4::translate(position), rect, color);
+		const std::vector<RenderQueue::Item>& items = commandList.getQueue().getItems();
+		if (!m_cullingEnabled)
+		{
+			m_visibility.assign(items.size(), 1);
+			return;
+		}
+
+		m_cullBounds.clear();
+		for (const RenderQueue::Item& item : items)
+		{
+			m_cullBounds.push_back(getBounds(commandList, item));
+		}
+		m_visibility.resize(items.size());
+		const size_t visible = m_culler.test(m_cullBounds.data(), m_cullBounds.size(), m_visibility.data());
+		stats.culledDraws += static_cast<int>(items.size() - visible);
 	}
 
-	void Renderer::submitDrawTexture(Texture* const texture, const math::vec3& position, const float rotation, const TextureRect& rect, const Color& color)
+	VisibilityCuller::Bounds Renderer::getBounds(const CommandList& commandList, const RenderQueue::Item& item)
 	{
-		submitDrawTexture(texture, math::matrix4::translate(position) * math::matrix4::rotate_z(rotation), rect, color);
+		switch (static_cast<CommandList::Pipeline>(RenderQueue::getPipeline(item.key)))
+		{
+		case CommandList::Pipeline::ShapeFill:
+		case CommandList::Pipeline::ShapeStroke:
+		{
+			const CommandList::Shape& shape = commandList.getShapes()[item.index];
+			return VisibilityCuller::getBounds(&commandList.getVertices()[shape.offset], shape.count);
+		}
+		case CommandList::Pipeline::ShapeStrip:
+		{
+			const CommandList::ShapeStrip& strip = commandList.getShapeStrips()[item.index];
+			return VisibilityCuller::getBounds(&commandList.getVertices()[strip.offset], strip.count);
+		}
+		case CommandList::Pipeline::ShapeInstance: return VisibilityCuller::getBounds(commandList.getShapeInstances()[item.index]);
+		case CommandList::Pipeline::Text: return VisibilityCuller::getBounds(commandList.getTexts()[item.index].vertex);
+		case CommandList::Pipeline::Texture:
+		default:
+			return VisibilityCuller::getBounds(commandList.getSprites()[item.index].vertex);
+		}
+	}
+
+	void Renderer::pushShape(const ShapeRenderStyle style, const Vertex* const vertices, const size_t numOfVertices)
+	{
+		if (m_sortingEnabled)
+		{
+			m_commandList.setLayer(m_layer);
+			m_commandList.pushShape(style, vertices, numOfVertices);
+			return;
+		}
+
+		if (cull(VisibilityCuller::getBounds(vertices, numOfVertices))) return;
+
+		batchShape(style, vertices, numOfVertices);
 	}
 
-	void Renderer::submitDrawTexture(Texture* const texture, const math::vec3& position, const math::vec3& scale, const TextureRect& rect, const Color& color)
+	void Renderer::pushShapeInstance(const ShapeInstance& shape)
 	{
-		submitDrawTexture(texture, math::matrix4::scale(scale) * math::matrix4::translate(position), rect, color);
+		if (m_sortingEnabled)
+		{
+			m_commandList.setLayer(m_layer);
+			m_commandList.pushShapeInstance(shape);
+			return;
+		}
+
+		if (cull(VisibilityCuller::getBounds(shape))) return;
+
+		getShapeInstanceCommand()->push(shape);
 	}
 
-	void Renderer::submitDrawTexture(Texture* const texture, const math::vec3& position, const float rotation, const math::vec3& scale, const TextureRect& rect, const Color& color)
+	void Renderer::pushShapeStrip(const Vertex* const vertices, const size_t numOfVertices, const uint32_t* const indices, const size_t numOfIndices)
 	{
-		submitDrawTexture(texture, math::matrix4::scale(scale) * math::matrix4::rotate_z(rotation) * math::matrix4::translate(position), rect, color);
+		if (m_sortingEnabled)
+		{
+			m_commandList.setLayer(m_layer);
+			m_commandList.pushShapeStrip(vertices, numOfVertices, indices, numOfIndices);
+			return;
+		}
+
+		if (cull(VisibilityCuller::getBounds(vertices, numOfVertices))) return;
+
+		getShapeStripCommand(numOfVertices, numOfIndices)->push(vertices, numOfVertices, indices, numOfIndices);
+	}
+
+	void Renderer::pushGlyph(const SpriteVertex& vertex, Font* const font)
+	{
+		if (m_sortingEnabled)
+		{
+			m_commandList.setLayer(m_layer);
+			m_commandList.pushGlyph(vertex, font);
+			return;
+		}
+
+		if (cull(VisibilityCuller::getBounds(vertex))) return;
+
+		getTextCommand(font, 1)->push(vertex, font);
+	}
+
+	void Renderer::pushSprite(const SpriteVertex& vertex, Texture* const texture)
+	{
+		if (m_sortingEnabled)
+		{
+			m_commandList.setLayer(m_layer);
+			m_commandList.pushSprite(vertex, texture);
+			return;
+		}
+
+		if (cull(VisibilityCuller::getBounds(vertex))) return;
+
+		batchSprite(vertex, texture);
 	}
 }
\ No newline at end of file
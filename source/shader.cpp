@@ -64,7 +64,7 @@ namespace graphics
 		return false;
 	}
 
-	Shader::Shader(const Type type, const std::string& source)
+	Shader::Shader(const Type type, const std::string& source, const bool deferred)
 		: m_id()
 		, m_type(type)
 		, m_state(State::Unknown)
@@ -75,6 +75,7 @@ namespace graphics
 		const char* source_pointer = source.c_str();
 		glShaderSource(m_id, 1, &source_pointer, NULL);
 		glCompileShader(m_id);
+		if (deferred) return;
 
 		int compile_state{};
 		glGetShaderiv(m_id, GL_COMPILE_STATUS, &compile_state);
@@ -1,7 +1,25 @@
 #include <vdtgraphics/shader_library.h>
 
+#include <vdtgraphics/camera_buffer.h>
+
 namespace graphics
 {
+	namespace
+	{
+		// the source with the camera block declared after the version of its vertex shader
+		std::string withCamera(const std::string& source)
+		{
+			const size_t vertex = source.find("#shader vertex");
+			const size_t version = source.find("#version", vertex != std::string::npos ? vertex : 0);
+			const size_t line = source.find('\n', version);
+			if (vertex == std::string::npos || version == std::string::npos || line == std::string::npos) return source;
+
+			std::string result = source;
+			result.insert(line + 1, CameraBuffer::block_source);
+			return result;
+		}
+	}
+
 	ShaderLibrary::ShaderLibrary()
 		: m_shaders()
 	{
@@ -43,7 +61,7 @@ namespace graphics
 			}		
 		)"
 		));
-		m_shaders.insert(std::make_pair(names::PolygonBatchShader, R"(
+		m_shaders.insert(std::make_pair(names::PolygonBatchShader, withCamera(R"(
 			#shader vertex
 
 			#version 330 core
@@ -54,15 +72,13 @@ namespace graphics
 			layout(location = 1) in vec4 a_color;
 
 			out vec4 v_color;
-
-			uniform mat4 u_matrix;
  
 			// all shaders have a main function
 			void main() {
  
 				// gl_Position is a special variable a vertex shader
 				// is responsible for setting
-				gl_Position = u_matrix * a_position;
+				gl_Position = u_viewProjection * a_position;
 				v_color = a_color;
 			}
 
@@ -81,9 +97,95 @@ namespace graphics
 				// Just set the output to a constant reddish-purple
 				outColor = v_color;
 			}		
-		)"
+		)")
 		));
-		m_shaders.insert(std::make_pair(names::SpriteBatchShader, R"(
+		m_shaders.insert(std::make_pair(names::ShapeShader, withCamera(R"(
+			#shader vertex
+
+			#version 330 core
+ 
+			// the corners of a unit quad
+			layout(location = 0) in vec2 a_position;
+			// the shape instance
+			layout(location = 1) in vec3 a_center;
+			layout(location = 2) in vec2 a_extent;
+			layout(location = 3) in float a_rotation;
+			layout(location = 4) in float a_radius;
+			layout(location = 5) in float a_strokeWidth;
+			layout(location = 6) in vec4 a_fillColor;
+			layout(location = 7) in vec4 a_strokeColor;
+			layout(location = 8) in uint a_type;
+
+			// position relative to the center, in world units
+			out vec2 v_position;
+			flat out vec2 v_extent;
+			flat out float v_radius;
+			flat out float v_strokeWidth;
+			flat out vec4 v_fillColor;
+			flat out vec4 v_strokeColor;
+			flat out uint v_type;
+ 
+			void main() {
+				v_position = a_position * a_extent;
+
+				float c = cos(a_rotation);
+				float s = sin(a_rotation);
+				vec2 position = vec2(c * v_position.x - s * v_position.y, s * v_position.x + c * v_position.y) + a_center.xy;
+				gl_Position = u_viewProjection * vec4(position, a_center.z, 1.0);
+
+				v_extent = a_extent;
+				v_radius = a_radius;
+				v_strokeWidth = a_strokeWidth;
+				v_fillColor = a_fillColor;
+				v_strokeColor = a_strokeColor;
+				v_type = a_type;
+			}
+
+			#shader fragment
+
+			#version 330 core
+			precision highp float;
+
+			in vec2 v_position;
+			flat in vec2 v_extent;
+			flat in float v_radius;
+			flat in float v_strokeWidth;
+			flat in vec4 v_fillColor;
+			flat in vec4 v_strokeColor;
+			flat in uint v_type;
+
+			out vec4 outColor;
+
+			// signed distance from the edge, negative inside
+			float shapeDistance(vec2 p) {
+				vec2 halfExtent = v_extent * 0.5;
+				uint type = v_type & 255u;
+				// circle
+				if (type == 0u) return length(p) - halfExtent.x;
+				// ellipse, approximated
+				if (type == 1u) return (length(p / halfExtent) - 1.0) * min(halfExtent.x, halfExtent.y);
+				// rect and rounded rect
+				float radius = type == 3u ? min(v_radius, min(halfExtent.x, halfExtent.y)) : 0.0;
+				vec2 q = abs(p) - halfExtent + radius;
+				return length(max(q, 0.0)) + min(max(q.x, q.y), 0.0) - radius;
+			}
+
+			void main() {
+				float d = shapeDistance(v_position);
+				// the size of a pixel in world units, the edges fade over one pixel
+				float pixel = max(fwidth(d), 1e-6);
+				float strokeWidth = (v_type & 256u) != 0u ? v_strokeWidth * pixel : v_strokeWidth;
+
+				float outer = clamp(-d / pixel, 0.0, 1.0);
+				float inner = clamp(-(d + strokeWidth) / pixel, 0.0, 1.0);
+				vec4 color = strokeWidth > 0.0 ? mix(v_strokeColor, v_fillColor, inner) : v_fillColor;
+				outColor = vec4(color.rgb, color.a * outer);
+
+				if (outColor.a <= 0.0) discard;
+			}
+		)")
+		));
+		m_shaders.insert(std::make_pair(names::SpriteBatchShader, withCamera(R"(
 			#shader vertex
 
 			#version 330 core
@@ -96,8 +198,6 @@ namespace graphics
 			layout(location = 3) in vec4 a_crop;
 			layout(location = 4) in vec4 a_color;
 			layout(location = 5) in mat4 a_transform;
-
-			uniform mat4 u_matrix;
  
 			// a varying to pass the texture coordinates to the fragment shader
 			out vec2 v_texcoord;
@@ -107,7 +207,7 @@ namespace graphics
  
 			void main() {
 				// Multiply the position by the matrix.
-				gl_Position = u_matrix * a_transform * a_position;
+				gl_Position = u_viewProjection * a_transform * a_position;
  
 				// Pass the texcoord to the fragment shader.
 				v_texcoord = a_texcoord;
@@ -168,9 +268,9 @@ namespace graphics
 			
 				if (outColor.a < 0.5) discard;
 			}
-		)"
+		)")
 		));
-		m_shaders.insert(std::make_pair(names::TextShader, R"(
+		m_shaders.insert(std::make_pair(names::SpriteArrayShader, withCamera(R"(
 			#shader vertex
 
 			#version 330 core
@@ -183,8 +283,117 @@ namespace graphics
 			layout(location = 3) in vec4 a_crop;
 			layout(location = 4) in vec4 a_color;
 			layout(location = 5) in mat4 a_transform;
+ 
+			// a varying to pass the texture coordinates to the fragment shader
+			out vec2 v_texcoord;
+			out float v_textureIndex;
+			out vec4 v_crop;
+			out vec4 v_color;
+ 
+			void main() {
+				// Multiply the position by the matrix.
+				gl_Position = u_viewProjection * a_transform * a_position;
+ 
+				// Pass the texcoord to the fragment shader.
+				v_texcoord = a_texcoord;
+				v_textureIndex = a_textureIndex;
+				v_crop = a_crop;
+				v_color = a_color;
+			}
+
+			#shader fragment
+
+			#version 330 core
+			precision highp float;
+ 
+			// Passed in from the vertex shader.
+			in vec2 v_texcoord;
+			in float v_textureIndex;
+			in vec4 v_crop;
+			in vec4 v_color;
+ 
+			// The layers of the texture array
+			uniform sampler2DArray u_textures;
+ 
+			out vec4 outColor;
+ 
+			void main() {
+				outColor = texture(u_textures, vec3(v_texcoord * v_crop.zw + v_crop.xy, v_textureIndex)) * v_color;
+
+				if (outColor.a < 0.5) discard;
+			}
+		)")
+		));
+		m_shaders.insert(std::make_pair(names::SpriteArrayCompactShader, withCamera(R"(
+			#shader vertex
 
-			uniform mat4 u_matrix;
+			#version 330 core
+ 
+			// an attribute is an input (in) to a vertex shader.
+			// It will receive data from a buffer
+			layout(location = 0) in vec4 a_position;
+			layout(location = 1) in vec2 a_texcoord;
+			layout(location = 2) in vec3 a_transform0;
+			layout(location = 3) in vec3 a_transform1;
+			layout(location = 4) in vec4 a_crop;
+			layout(location = 5) in vec4 a_color;
+			layout(location = 6) in uint a_textureIndex;
+			layout(location = 7) in float a_depth;
+ 
+			// a varying to pass the texture coordinates to the fragment shader
+			out vec2 v_texcoord;
+			out float v_textureIndex;
+			out vec4 v_crop;
+			out vec4 v_color;
+ 
+			void main() {
+				// Apply the 2D affine transform, then the matrix.
+				vec3 position = vec3(a_position.xy, 1.0);
+				gl_Position = u_viewProjection * vec4(dot(a_transform0, position), dot(a_transform1, position), a_depth, 1.0);
+ 
+				// Pass the texcoord to the fragment shader.
+				v_texcoord = a_texcoord;
+				v_textureIndex = float(a_textureIndex);
+				v_crop = a_crop;
+				v_color = a_color;
+			}
+
+			#shader fragment
+
+			#version 330 core
+			precision highp float;
+ 
+			// Passed in from the vertex shader.
+			in vec2 v_texcoord;
+			in float v_textureIndex;
+			in vec4 v_crop;
+			in vec4 v_color;
+ 
+			// The layers of the texture array
+			uniform sampler2DArray u_textures;
+ 
+			out vec4 outColor;
+ 
+			void main() {
+				outColor = texture(u_textures, vec3(v_texcoord * v_crop.zw + v_crop.xy, v_textureIndex)) * v_color;
+
+				if (outColor.a < 0.5) discard;
+			}
+		)")
+		));
+		m_shaders.insert(std::make_pair(names::TextShader, withCamera(R"(
+			#shader vertex
+
+			#version 330 core
+ 
+			// an attribute is an input (in) to a vertex shader.
+			// It will receive data from a buffer
+			layout(location = 0) in vec4 a_position;
+			layout(location = 1) in vec2 a_texcoord;
+			layout(location = 2) in float a_textureIndex;
+			layout(location = 3) in vec4 a_crop;
+			layout(location = 4) in vec4 a_color;
+			layout(location = 5) in mat4 a_transform;
  
 			// a varying to pass the texture coordinates to the fragment shader
 			out vec2 v_texcoord;
@@ -194,7 +403,7 @@ namespace graphics
  
 			void main() {
 				// Multiply the position by the matrix.
-				gl_Position = u_matrix * a_transform * a_position;
+				gl_Position = u_viewProjection * a_transform * a_position;
  
 				// Pass the texcoord to the fragment shader.
 				v_texcoord = a_texcoord;
@@ -254,7 +463,182 @@ namespace graphics
 
 				if (outColor.a < 0.5) discard;
 			}
-		)"
+		)")
+		));
+		m_shaders.insert(std::make_pair(names::SpriteBatchCompactShader, withCamera(R"(
+			#shader vertex
+
+			#version 330 core
+ 
+			// an attribute is an input (in) to a vertex shader.
+			// It will receive data from a buffer
+			layout(location = 0) in vec4 a_position;
+			layout(location = 1) in vec2 a_texcoord;
+			layout(location = 2) in vec3 a_transform0;
+			layout(location = 3) in vec3 a_transform1;
+			layout(location = 4) in vec4 a_crop;
+			layout(location = 5) in vec4 a_color;
+			layout(location = 6) in uint a_textureIndex;
+			layout(location = 7) in float a_depth;
+ 
+			// a varying to pass the texture coordinates to the fragment shader
+			out vec2 v_texcoord;
+			out float v_textureIndex;
+			out vec4 v_crop;
+			out vec4 v_color;
+ 
+			void main() {
+				// Apply the 2D affine transform, then the matrix.
+				vec3 position = vec3(a_position.xy, 1.0);
+				gl_Position = u_viewProjection * vec4(dot(a_transform0, position), dot(a_transform1, position), a_depth, 1.0);
+ 
+				// Pass the texcoord to the fragment shader.
+				v_texcoord = a_texcoord;
+				v_textureIndex = float(a_textureIndex);
+				v_crop = a_crop;
+				v_color = a_color;
+			}
+
+			#shader fragment
+
+			#version 330 core
+			precision highp float;
+ 
+			// Passed in from the vertex shader.
+			in vec2 v_texcoord;
+			in float v_textureIndex;
+			in vec4 v_crop;
+			in vec4 v_color;
+ 
+			// The textures
+			uniform sampler2D u_texture0;
+			uniform sampler2D u_texture1;
+			uniform sampler2D u_texture2;
+			uniform sampler2D u_texture3;
+			uniform sampler2D u_texture4;
+			uniform sampler2D u_texture5;
+			uniform sampler2D u_texture6;
+			uniform sampler2D u_texture7;
+			uniform sampler2D u_texture8;
+			uniform sampler2D u_texture9;
+			uniform sampler2D u_texture10;
+			uniform sampler2D u_texture11;
+			uniform sampler2D u_texture12;
+			uniform sampler2D u_texture13;
+			uniform sampler2D u_texture14;
+			uniform sampler2D u_texture15;
+ 
+			out vec4 outColor;
+ 
+			void main() {
+				if (v_textureIndex == 0) outColor = texture(u_texture0, v_texcoord * v_crop.zw + v_crop.xy) * v_color;
+				else if (v_textureIndex == 1) outColor = texture(u_texture1, v_texcoord * v_crop.zw + v_crop.xy) * v_color;
+				else if (v_textureIndex == 2) outColor = texture(u_texture2, v_texcoord * v_crop.zw + v_crop.xy) * v_color;
+				else if (v_textureIndex == 3) outColor = texture(u_texture3, v_texcoord * v_crop.zw + v_crop.xy) * v_color;
+				else if (v_textureIndex == 4) outColor = texture(u_texture4, v_texcoord * v_crop.zw + v_crop.xy) * v_color;
+				else if (v_textureIndex == 5) outColor = texture(u_texture5, v_texcoord * v_crop.zw + v_crop.xy) * v_color;
+				else if (v_textureIndex == 6) outColor = texture(u_texture6, v_texcoord * v_crop.zw + v_crop.xy) * v_color;
+				else if (v_textureIndex == 7) outColor = texture(u_texture7, v_texcoord * v_crop.zw + v_crop.xy) * v_color;
+				else if (v_textureIndex == 8) outColor = texture(u_texture8, v_texcoord * v_crop.zw + v_crop.xy) * v_color;
+				else if (v_textureIndex == 9) outColor = texture(u_texture9, v_texcoord * v_crop.zw + v_crop.xy) * v_color;
+				else if (v_textureIndex == 10) outColor = texture(u_texture10, v_texcoord * v_crop.zw + v_crop.xy) * v_color;
+				else if (v_textureIndex == 11) outColor = texture(u_texture11, v_texcoord * v_crop.zw + v_crop.xy) * v_color;
+				else if (v_textureIndex == 12) outColor = texture(u_texture12, v_texcoord * v_crop.zw + v_crop.xy) * v_color;
+				else if (v_textureIndex == 13) outColor = texture(u_texture13, v_texcoord * v_crop.zw + v_crop.xy) * v_color;
+				else if (v_textureIndex == 14) outColor = texture(u_texture14, v_texcoord * v_crop.zw + v_crop.xy) * v_color;
+				else if (v_textureIndex == 15) outColor = texture(u_texture15, v_texcoord * v_crop.zw + v_crop.xy) * v_color;	
+				else outColor = vec4(1, 1, 1, 1);
+			
+				if (outColor.a < 0.5) discard;
+			}
+		)")
+		));
+		m_shaders.insert(std::make_pair(names::TextCompactShader, withCamera(R"(
+			#shader vertex
+
+			#version 330 core
+ 
+			// an attribute is an input (in) to a vertex shader.
+			// It will receive data from a buffer
+			layout(location = 0) in vec4 a_position;
+			layout(location = 1) in vec2 a_texcoord;
+			layout(location = 2) in vec3 a_transform0;
+			layout(location = 3) in vec3 a_transform1;
+			layout(location = 4) in vec4 a_crop;
+			layout(location = 5) in vec4 a_color;
+			layout(location = 6) in uint a_textureIndex;
+			layout(location = 7) in float a_depth;
+ 
+			// a varying to pass the texture coordinates to the fragment shader
+			out vec2 v_texcoord;
+			out float v_textureIndex;
+			out vec4 v_crop;
+			out vec4 v_color;
+ 
+			void main() {
+				// Apply the 2D affine transform, then the matrix.
+				vec3 position = vec3(a_position.xy, 1.0);
+				gl_Position = u_viewProjection * vec4(dot(a_transform0, position), dot(a_transform1, position), a_depth, 1.0);
+ 
+				// Pass the texcoord to the fragment shader.
+				v_texcoord = a_texcoord;
+				v_textureIndex = float(a_textureIndex);
+				v_crop = a_crop;
+				v_color = a_color;
+			}
+
+			#shader fragment
+
+			#version 330 core
+			precision highp float;
+ 
+			// Passed in from the vertex shader.
+			in vec2 v_texcoord;
+			in float v_textureIndex;
+			in vec4 v_crop;
+			in vec4 v_color;
+ 
+			// The textures
+			uniform sampler2D u_texture0;
+			uniform sampler2D u_texture1;
+			uniform sampler2D u_texture2;
+			uniform sampler2D u_texture3;
+			uniform sampler2D u_texture4;
+			uniform sampler2D u_texture5;
+			uniform sampler2D u_texture6;
+			uniform sampler2D u_texture7;
+			uniform sampler2D u_texture8;
+			uniform sampler2D u_texture9;
+			uniform sampler2D u_texture10;
+			uniform sampler2D u_texture11;
+			uniform sampler2D u_texture12;
+			uniform sampler2D u_texture13;
+			uniform sampler2D u_texture14;
+			uniform sampler2D u_texture15;
+ 
+			out vec4 outColor;
+ 
+			void main() {
+				if (v_textureIndex == 0) outColor = vec4(1.0, 1.0, 1.0, texture(u_texture0, v_texcoord * v_crop.zw + v_crop.xy).r) * v_color;
+				else if (v_textureIndex == 1) outColor = vec4(1.0, 1.0, 1.0, texture(u_texture1, v_texcoord * v_crop.zw + v_crop.xy).r) * v_color;
+				else if (v_textureIndex == 2) outColor = vec4(1.0, 1.0, 1.0, texture(u_texture2, v_texcoord * v_crop.zw + v_crop.xy).r) * v_color;
+				else if (v_textureIndex == 3) outColor = vec4(1.0, 1.0, 1.0, texture(u_texture3, v_texcoord * v_crop.zw + v_crop.xy).r) * v_color;
+				else if (v_textureIndex == 4) outColor = vec4(1.0, 1.0, 1.0, texture(u_texture4, v_texcoord * v_crop.zw + v_crop.xy).r) * v_color;
+				else if (v_textureIndex == 5) outColor = vec4(1.0, 1.0, 1.0, texture(u_texture5, v_texcoord * v_crop.zw + v_crop.xy).r) * v_color;
+				else if (v_textureIndex == 6) outColor = vec4(1.0, 1.0, 1.0, texture(u_texture6, v_texcoord * v_crop.zw + v_crop.xy).r) * v_color;
+				else if (v_textureIndex == 7) outColor = vec4(1.0, 1.0, 1.0, texture(u_texture7, v_texcoord * v_crop.zw + v_crop.xy).r) * v_color;
+				else if (v_textureIndex == 8) outColor = vec4(1.0, 1.0, 1.0, texture(u_texture8, v_texcoord * v_crop.zw + v_crop.xy).r) * v_color;
+				else if (v_textureIndex == 9) outColor = vec4(1.0, 1.0, 1.0, texture(u_texture9, v_texcoord * v_crop.zw + v_crop.xy).r) * v_color;
+				else if (v_textureIndex == 10) outColor = vec4(1.0, 1.0, 1.0, texture(u_texture10, v_texcoord * v_crop.zw + v_crop.xy).r) * v_color;
+				else if (v_textureIndex == 11) outColor = vec4(1.0, 1.0, 1.0, texture(u_texture11, v_texcoord * v_crop.zw + v_crop.xy).r) * v_color;
+				else if (v_textureIndex == 12) outColor = vec4(1.0, 1.0, 1.0, texture(u_texture12, v_texcoord * v_crop.zw + v_crop.xy).r) * v_color;
+				else if (v_textureIndex == 13) outColor = vec4(1.0, 1.0, 1.0, texture(u_texture13, v_texcoord * v_crop.zw + v_crop.xy).r) * v_color;
+				else if (v_textureIndex == 14) outColor = vec4(1.0, 1.0, 1.0, texture(u_texture14, v_texcoord * v_crop.zw + v_crop.xy).r) * v_color;
+				else if (v_textureIndex == 15) outColor = vec4(1.0, 1.0, 1.0, texture(u_texture15, v_texcoord * v_crop.zw + v_crop.xy).r) * v_color;	
+
+				if (outColor.a < 0.5) discard;
+			}
+		)")
 		));
 		m_shaders.insert(std::make_pair(names::TextureShader, R"(
 			#shader vertex
@@ -302,7 +686,12 @@ namespace graphics
 
 	const std::string ShaderLibrary::names::ColorShader = "Color";
 	const std::string ShaderLibrary::names::PolygonBatchShader = "PolygonBatch";
+	const std::string ShaderLibrary::names::ShapeShader = "Shape";
 	const std::string ShaderLibrary::names::SpriteBatchShader = "SpriteBatch";
+	const std::string ShaderLibrary::names::SpriteBatchCompactShader = "SpriteBatchCompact";
+	const std::string ShaderLibrary::names::SpriteArrayShader = "SpriteArray";
+	const std::string ShaderLibrary::names::SpriteArrayCompactShader = "SpriteArrayCompact";
 	const std::string ShaderLibrary::names::TextShader = "Text";
+	const std::string ShaderLibrary::names::TextCompactShader = "TextCompact";
 	const std::string ShaderLibrary::names::TextureShader = "Texture";
 }
\ No newline at end of file
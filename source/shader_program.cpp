@@ -1,19 +1,73 @@
 #include <vdtgraphics/shader_program.h>
 #include <vdtgraphics/shader.h>
 
+#include <algorithm>
+#include <cassert>
+#include <cctype>
+
 #include <glad/glad.h>
 
+#include <vdtgraphics/context.h>
+#include <vdtgraphics/gl_state_cache.h>
+
 namespace graphics
 {
-	ShaderProgram::ShaderProgram(const std::initializer_list<Shader*>& shaders)
+	namespace
+	{
+		// KHR_parallel_shader_compile, not in the loader
+		constexpr GLenum GL_COMPLETION_STATUS_KHR = 0x91B1;
+
+		bool isSampler(const GLenum type)
+		{
+			switch (type)
+			{
+			case GL_SAMPLER_2D:
+			case GL_SAMPLER_2D_ARRAY:
+			case GL_SAMPLER_3D:
+			case GL_SAMPLER_CUBE:
+			case GL_INT_SAMPLER_2D:
+			case GL_UNSIGNED_INT_SAMPLER_2D:
+				return true;
+			default: return false;
+			}
+		}
+
+		// the GL types a handle of type T can set
+		template <typename T>
+		bool isOfType(GLenum type);
+
+		template <>
+		bool isOfType<bool>(const GLenum type) { return type == GL_BOOL; }
+
+		template <>
+		bool isOfType<int>(const GLenum type) { return type == GL_INT || isSampler(type); }
+
+		template <>
+		bool isOfType<float>(const GLenum type) { return type == GL_FLOAT; }
+
+		template <>
+		bool isOfType<math::mat4>(const GLenum type) { return type == GL_FLOAT_MAT4; }
+
+		template <>
+		bool isOfType<Color>(const GLenum type) { return type == GL_FLOAT_VEC4; }
+	}
+
+	ShaderProgram::ShaderProgram(const std::initializer_list<Shader*>& shaders, const bool retrievable, const bool deferred)
 		: m_id()
 		, m_state(State::Unknown)
 		, m_errorMessage()
-		, m_uniformLocations()
+		, m_uniforms()
+		, m_shaders()
+		, m_uniformBlocks()
 	{
 		// create the program
 		m_id = glCreateProgram();
 
+		if (retrievable && GLAD_GL_VERSION_4_1)
+		{
+			glProgramParameteri(m_id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+		}
+
 		// attach shaders
 		for (auto it = shaders.begin(); it != shaders.end(); ++it)
 		{
@@ -21,11 +75,83 @@ namespace graphics
 			if (shader)
 			{
 				glAttachShader(m_id, shader->id());
+				m_shaders.push_back(shader->id());
 			}
 		}
 
-		// link the program
+		// link the program, the shaders can be deleted meanwhile, GL keeps them until detached
 		glLinkProgram(m_id);
+		m_state = State::Linking;
+
+		if (!deferred)
+		{
+			finish();
+		}
+	}
+
+	ShaderProgram::ShaderProgram(const unsigned int binaryFormat, const void* const binary, const size_t size)
+		: m_id()
+		, m_state(State::Unknown)
+		, m_errorMessage()
+		, m_uniforms()
+		, m_shaders()
+		, m_uniformBlocks()
+	{
+		m_id = glCreateProgram();
+		if (GLAD_GL_VERSION_4_1)
+		{
+			glProgramBinary(m_id, binaryFormat, binary, static_cast<GLsizei>(size));
+		}
+
+		// a binary made by another driver or corrupted fails to link
+		m_state = State::Linking;
+		finish();
+	}
+
+	ShaderProgram::~ShaderProgram()
+	{
+		free();
+	}
+
+	void ShaderProgram::bind()
+	{
+		if (m_state == State::Linking)
+		{
+			finish();
+		}
+		GLStateCache::get().useProgram(m_id);
+	}
+
+	void ShaderProgram::unbind()
+	{
+		GLStateCache::get().useProgram(0);
+	}
+
+	void ShaderProgram::free()
+	{
+		if (m_id != 0)
+		{
+			GLStateCache::get().onProgramDeleted(m_id);
+			glDeleteProgram(m_id);
+			m_id = 0;
+		}
+		m_uniforms.clear();
+		m_shaders.clear();
+		m_uniformBlocks.clear();
+	}
+
+	bool ShaderProgram::isReady() const
+	{
+		if (m_state != State::Linking || !isParallelCompileSupported()) return true;
+
+		int completed = GL_FALSE;
+		glGetProgramiv(m_id, GL_COMPLETION_STATUS_KHR, &completed);
+		return completed == GL_TRUE;
+	}
+
+	ShaderProgram::State ShaderProgram::finish()
+	{
+		if (m_state != State::Linking) return m_state;
 
 		int link_status{};
 		glGetProgramiv(m_id, GL_LINK_STATUS, &link_status);
@@ -37,43 +163,34 @@ namespace graphics
 			glGetProgramInfoLog(m_id, 1024, NULL, log);
 			m_errorMessage = std::string{ log };
 
-			// delete the program
+			// delete the program, the name may be given to another one
+			GLStateCache::get().onProgramDeleted(m_id);
 			glDeleteProgram(m_id);
+			m_id = 0;
 		}
 		else
 		{
 			// detach shaders
-			for (auto it = shaders.begin(); it != shaders.end(); ++it)
+			for (const unsigned int shader : m_shaders)
 			{
-				auto shader = *it;
-				if (shader)
-				{
-					glDetachShader(m_id, shader->id());
-				}
+				glDetachShader(m_id, shader);
 			}
 			m_state = State::Linked;
+			resolveUniforms();
+			for (const auto& block : m_uniformBlocks)
+			{
+				bindUniformBlock(block.first, block.second);
+			}
 		}
+		m_shaders.clear();
+		m_uniformBlocks.clear();
+		return m_state;
 	}
 
-	ShaderProgram::~ShaderProgram()
-	{
-		free();
-	}
-
-	void ShaderProgram::bind()
-	{
-		glUseProgram(m_id);
-	}
-
-	void ShaderProgram::unbind()
-	{
-		glUseProgram(0);
-	}
-
-	void ShaderProgram::free()
+	bool ShaderProgram::isParallelCompileSupported()
 	{
-		glDeleteProgram(m_id);
-		m_uniformLocations.clear();
+		return Context::hasExtension("GL_KHR_parallel_shader_compile")
+			|| Context::hasExtension("GL_ARB_parallel_shader_compile");
 	}
 
 	void ShaderProgram::set(const std::string& name, const bool value)
@@ -101,18 +218,221 @@ namespace graphics
 		glUniform4f(getUniformLocation(name), f1, f2, f3, f4);
 	}
 
-	int ShaderProgram::getUniformLocation(const std::string& name) const
+	bool ShaderProgram::bindUniformBlock(const std::string& name, const unsigned int bindingPoint)
+	{
+		if (m_state == State::Linking)
+		{
+			m_uniformBlocks.push_back(std::make_pair(name, bindingPoint));
+			return true;
+		}
+
+		const unsigned int index = glGetUniformBlockIndex(m_id, name.c_str());
+		if (index == GL_INVALID_INDEX) return false;
+
+		glUniformBlockBinding(m_id, index, bindingPoint);
+		return true;
+	}
+
+	bool ShaderProgram::getBinary(unsigned int& binaryFormat, std::vector<uint8_t>& binary) const
+	{
+		if (m_state != State::Linked || !GLAD_GL_VERSION_4_1) return false;
+
+		int length = 0;
+		glGetProgramiv(m_id, GL_PROGRAM_BINARY_LENGTH, &length);
+		if (length <= 0) return false;
+
+		binary.resize(static_cast<size_t>(length));
+		GLenum format = 0;
+		glGetProgramBinary(m_id, length, &length, &format, binary.data());
+		binary.resize(static_cast<size_t>(length));
+		binaryFormat = format;
+		return length > 0;
+	}
+
+	template <typename T>
+	UniformHandle<T> ShaderProgram::getUniform(const UniformName name)
+	{
+		finish();
+		const Uniform* const uniform = findUniform(name);
+		if (uniform == nullptr || !isOfType<T>(uniform->type)) return {};
+		return { uniform->location };
+	}
+
+	template UniformHandle<bool> ShaderProgram::getUniform<bool>(UniformName name);
+	template UniformHandle<int> ShaderProgram::getUniform<int>(UniformName name);
+	template UniformHandle<float> ShaderProgram::getUniform<float>(UniformName name);
+	template UniformHandle<math::mat4> ShaderProgram::getUniform<math::mat4>(UniformName name);
+	template UniformHandle<Color> ShaderProgram::getUniform<Color>(UniformName name);
+
+	int ShaderProgram::getTextureUnit(const UniformName name)
+	{
+		finish();
+		const Uniform* const uniform = findUniform(name);
+		return uniform != nullptr ? uniform->unit : -1;
+	}
+
+	void ShaderProgram::set(const UniformHandle<bool> handle, const bool value)
 	{
-		if (m_uniformLocations.find(name) != m_uniformLocations.end())
+		glUniform1i(handle.location, static_cast<int>(value));
+	}
+
+	void ShaderProgram::set(const UniformHandle<int> handle, const int value)
+	{
+		glUniform1i(handle.location, value);
+	}
+
+	void ShaderProgram::set(const UniformHandle<float> handle, const float value)
+	{
+		glUniform1f(handle.location, value);
+	}
+
+	void ShaderProgram::set(const UniformHandle<math::mat4> handle, const math::mat4& matrix)
+	{
+		glUniformMatrix4fv(handle.location, 1, GL_FALSE, matrix.data);
+	}
+
+	void ShaderProgram::set(const UniformHandle<Color> handle, const Color& color)
+	{
+		glUniform4fv(handle.location, 1, color.data);
+	}
+
+	void ShaderProgram::resolveUniforms()
+	{
+		int numOfUniforms = 0;
+		int maxNameLength = 0;
+		glGetProgramiv(m_id, GL_ACTIVE_UNIFORMS, &numOfUniforms);
+		glGetProgramiv(m_id, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+
+		std::vector<char> buffer(static_cast<size_t>(std::max(maxNameLength, 1)));
+		// samplers and the size of their arrays, units are assigned once all are known
+		std::vector<std::pair<Uniform, int>> samplers;
+		std::vector<bool> usedUnits;
+		const auto& reserveUnits = [&usedUnits](const int unit, const int count)
+		{
+			if (usedUnits.size() < static_cast<size_t>(unit + count))
+			{
+				usedUnits.resize(static_cast<size_t>(unit + count), false);
+			}
+			std::fill(usedUnits.begin() + unit, usedUnits.begin() + unit + count, true);
+		};
+
+		for (int i = 0; i < numOfUniforms; ++i)
 		{
-			return m_uniformLocations[name];
+			GLsizei length = 0;
+			GLint size = 0;
+			GLenum type = 0;
+			glGetActiveUniform(m_id, static_cast<GLuint>(i), static_cast<GLsizei>(buffer.size()), &length, &size, &type, buffer.data());
+			std::string name(buffer.data(), static_cast<size_t>(length));
+
+			// members of the uniform blocks have no location
+			const int location = glGetUniformLocation(m_id, name.c_str());
+			if (location < 0) continue;
+
+			// arrays are reported by their first element
+			const size_t bracket = name.find('[');
+			if (bracket != std::string::npos)
+			{
+				name.erase(bracket);
+			}
+
+			Uniform uniform{ UniformName::hash(name.c_str()), name, location, type, -1 };
+			if (isSampler(type))
+			{
+				// u_texture3 is bound to the unit 3
+				size_t digits = name.size();
+				while (digits > 0 && std::isdigit(static_cast<unsigned char>(name[digits - 1])))
+				{
+					--digits;
+				}
+				if (digits < name.size() && name.size() - digits <= 2)
+				{
+					uniform.unit = std::stoi(name.substr(digits));
+					reserveUnits(uniform.unit, size);
+				}
+				samplers.push_back(std::make_pair(uniform, size));
+			}
+			else
+			{
+				m_uniforms.push_back(uniform);
+			}
 		}
 
-		int location = glGetUniformLocation(m_id, name.c_str());
-		if (location >= 0)
+		if (!samplers.empty())
 		{
-			m_uniformLocations[name] = location;
+			// the samplers never change unit, they are set once here
+			GLStateCache::get().useProgram(m_id);
+
+			std::vector<int> units;
+			for (auto& sampler : samplers)
+			{
+				Uniform& uniform = sampler.first;
+				const int count = sampler.second;
+				if (uniform.unit < 0)
+				{
+					// the first free units
+					int unit = 0;
+					while (std::find(usedUnits.begin() + std::min<size_t>(unit, usedUnits.size()),
+						usedUnits.begin() + std::min<size_t>(unit + count, usedUnits.size()), true)
+						!= usedUnits.begin() + std::min<size_t>(unit + count, usedUnits.size()))
+					{
+						++unit;
+					}
+					uniform.unit = unit;
+					reserveUnits(unit, count);
+				}
+
+				units.resize(static_cast<size_t>(count));
+				for (int i = 0; i < count; ++i)
+				{
+					units[i] = uniform.unit + i;
+				}
+				glUniform1iv(uniform.location, count, units.data());
+				m_uniforms.push_back(uniform);
+			}
 		}
-		return location;
+
+		std::sort(m_uniforms.begin(), m_uniforms.end(),
+			[](const Uniform& a, const Uniform& b)
+			{
+				return a.hash < b.hash;
+			}
+		);
+
+		// uniforms sharing a hash can't be told apart by a handle, they are
+		// left to the lookups by name
+		for (size_t i = 1; i < m_uniforms.size(); ++i)
+		{
+			if (m_uniforms[i].hash != m_uniforms[i - 1].hash) continue;
+
+			assert(false && "two uniforms of the program share a hash");
+			const uint32_t hash = m_uniforms[i].hash;
+			m_uniforms.erase(std::remove_if(m_uniforms.begin(), m_uniforms.end(),
+				[hash](const Uniform& uniform)
+				{
+					return uniform.hash == hash;
+				}
+			), m_uniforms.end());
+			i = 0;
+		}
+	}
+
+	const ShaderProgram::Uniform* const ShaderProgram::findUniform(const UniformName name) const
+	{
+		const auto& it = std::lower_bound(m_uniforms.begin(), m_uniforms.end(), name.getHash(),
+			[](const Uniform& uniform, const uint32_t hash)
+			{
+				return uniform.hash < hash;
+			}
+		);
+		return it != m_uniforms.end() && it->hash == name.getHash() ? &*it : nullptr;
+	}
+
+	int ShaderProgram::getUniformLocation(const std::string& name)
+	{
+		finish();
+		// the elements of arrays, and the names colliding with a hash, are resolved by the driver
+		const Uniform* const uniform = findUniform(name);
+		if (uniform != nullptr && uniform->name == name) return uniform->location;
+		return m_id != 0 ? glGetUniformLocation(m_id, name.c_str()) : -1;
 	}
 }
\ No newline at end of file
@@ -0,0 +1,215 @@
+#include <vdtgraphics/spatial_sprite_index.h>
+
+#include <cmath>
+
+#include <vdtmath/transform.h>
+
+namespace graphics
+{
+	namespace
+	{
+		uint64_t getCellKey(const int32_t x, const int32_t y)
+		{
+			return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(y);
+		}
+	}
+
+	SpatialSpriteIndex::SpatialSpriteIndex(const float cellSize)
+		: m_cellSize(cellSize > 0.f ? cellSize : 1.f)
+		, m_sprites()
+		, m_freeHandles()
+		, m_size(0)
+		, m_cells()
+		, m_oversized()
+	{
+
+	}
+
+	SpatialSpriteIndex::Handle SpatialSpriteIndex::add(Texture* const texture, const math::mat4& transform, const TextureRect& rect, const Color& color)
+	{
+		if (texture == nullptr) return invalid_handle;
+
+		Handle handle;
+		if (!m_freeHandles.empty())
+		{
+			handle = m_freeHandles.back();
+			m_freeHandles.pop_back();
+		}
+		else
+		{
+			handle = static_cast<Handle>(m_sprites.size());
+			m_sprites.emplace_back();
+		}
+
+		Sprite& sprite = m_sprites[handle];
+		sprite.vertex = { transform, color, rect };
+		sprite.texture = texture;
+		sprite.bounds = VisibilityCuller::getBounds(sprite.vertex);
+		sprite.used = true;
+		insert(handle);
+		++m_size;
+		return handle;
+	}
+
+	SpatialSpriteIndex::Handle SpatialSpriteIndex::add(Texture* const texture, const math::vec3& position, const TextureRect& rect, const Color& color)
+	{
+		return add(texture, math::matrix4::translate(position), rect, color);
+	}
+
+	bool SpatialSpriteIndex::update(const Handle handle, const math::mat4& transform)
+	{
+		if (!contains(handle)) return false;
+
+		Sprite& sprite = m_sprites[handle];
+		sprite.vertex.transform = transform;
+		sprite.bounds = VisibilityCuller::getBounds(sprite.vertex);
+
+		// moving within the cell is free
+		uint64_t cell;
+		const bool oversized = !getCell(sprite.bounds, cell);
+		if (oversized != sprite.oversized || (!oversized && cell != sprite.cell))
+		{
+			erase(handle);
+			insert(handle);
+		}
+		return true;
+	}
+
+	bool SpatialSpriteIndex::update(const Handle handle, const math::mat4& transform, const TextureRect& rect, const Color& color)
+	{
+		if (!update(handle, transform)) return false;
+
+		Sprite& sprite = m_sprites[handle];
+		sprite.vertex.rect = rect;
+		sprite.vertex.color = color;
+		return true;
+	}
+
+	bool SpatialSpriteIndex::remove(const Handle handle)
+	{
+		if (!contains(handle)) return false;
+
+		erase(handle);
+		m_sprites[handle].used = false;
+		m_sprites[handle].texture = nullptr;
+		m_freeHandles.push_back(handle);
+		--m_size;
+		return true;
+	}
+
+	bool SpatialSpriteIndex::contains(const Handle handle) const
+	{
+		return handle < m_sprites.size() && m_sprites[handle].used;
+	}
+
+	void SpatialSpriteIndex::clear()
+	{
+		m_sprites.clear();
+		m_freeHandles.clear();
+		m_size = 0;
+		m_cells.clear();
+		m_oversized.clear();
+	}
+
+	void SpatialSpriteIndex::query(const math::mat4& viewProjectionMatrix, std::vector<Handle>& handles) const
+	{
+		VisibilityCuller culler;
+		culler.setViewProjectionMatrix(viewProjectionMatrix);
+		query(culler, handles);
+	}
+
+	void SpatialSpriteIndex::query(const VisibilityCuller& culler, std::vector<Handle>& handles) const
+	{
+		math::vec2 min, max;
+		bool bounded = culler.getVisibleArea(min, max);
+
+		// sprites overflow their cell by up to a cell
+		int64_t minX = 0, minY = 0, maxX = 0, maxY = 0;
+		if (bounded)
+		{
+			minX = static_cast<int64_t>(std::floor(min.x / m_cellSize)) - 1;
+			minY = static_cast<int64_t>(std::floor(min.y / m_cellSize)) - 1;
+			maxX = static_cast<int64_t>(std::floor(max.x / m_cellSize)) + 1;
+			maxY = static_cast<int64_t>(std::floor(max.y / m_cellSize)) + 1;
+			// when the view covers more cells than the ones in use, walk the used ones
+			const double numOfCells = static_cast<double>(maxX - minX + 1) * static_cast<double>(maxY - minY + 1);
+			bounded = numOfCells <= static_cast<double>(m_cells.size());
+		}
+
+		if (bounded)
+		{
+			for (int64_t y = minY; y <= maxY; ++y)
+			{
+				for (int64_t x = minX; x <= maxX; ++x)
+				{
+					const auto it = m_cells.find(getCellKey(static_cast<int32_t>(x), static_cast<int32_t>(y)));
+					if (it != m_cells.end())
+					{
+						queryCell(it->second, culler, handles);
+					}
+				}
+			}
+		}
+		else
+		{
+			for (const auto& pair : m_cells)
+			{
+				queryCell(pair.second, culler, handles);
+			}
+		}
+
+		queryCell(m_oversized, culler, handles);
+	}
+
+	bool SpatialSpriteIndex::getCell(const VisibilityCuller::Bounds& bounds, uint64_t& cell) const
+	{
+		const float x = std::floor(bounds.center.x / m_cellSize);
+		const float y = std::floor(bounds.center.y / m_cellSize);
+		const float limit = 2147483520.f;
+		if (bounds.extent.x > m_cellSize || bounds.extent.y > m_cellSize
+			|| !(std::abs(x) < limit) || !(std::abs(y) < limit))
+		{
+			return false;
+		}
+		cell = getCellKey(static_cast<int32_t>(x), static_cast<int32_t>(y));
+		return true;
+	}
+
+	void SpatialSpriteIndex::insert(const Handle handle)
+	{
+		Sprite& sprite = m_sprites[handle];
+		sprite.cell = 0;
+		sprite.oversized = !getCell(sprite.bounds, sprite.cell);
+		std::vector<Handle>& sprites = sprite.oversized ? m_oversized : m_cells[sprite.cell];
+		sprite.slot = static_cast<uint32_t>(sprites.size());
+		sprites.push_back(handle);
+	}
+
+	void SpatialSpriteIndex::erase(const Handle handle)
+	{
+		const Sprite& sprite = m_sprites[handle];
+		std::vector<Handle>& sprites = sprite.oversized ? m_oversized : m_cells[sprite.cell];
+
+		// the last sprite of the cell takes the place of the removed one
+		const Handle last = sprites.back();
+		sprites[sprite.slot] = last;
+		m_sprites[last].slot = sprite.slot;
+		sprites.pop_back();
+
+		if (sprites.empty() && !sprite.oversized)
+		{
+			m_cells.erase(sprite.cell);
+		}
+	}
+
+	void SpatialSpriteIndex::queryCell(const std::vector<Handle>& sprites, const VisibilityCuller& culler, std::vector<Handle>& handles) const
+	{
+		for (const Handle handle : sprites)
+		{
+			if (culler.isVisible(m_sprites[handle].bounds))
+			{
+				handles.push_back(handle);
+			}
+		}
+	}
+}
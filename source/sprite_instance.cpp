@@ -0,0 +1,148 @@
+#include <vdtgraphics/sprite_instance.h>
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VDTGRAPHICS_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace graphics
+{
+	size_t getInstanceSize(const SpriteFormat format)
+	{
+		switch (format)
+		{
+		case SpriteFormat::Compact: return sizeof(CompactSpriteInstance);
+		case SpriteFormat::Standard:
+		default:
+			// texture index, crop, color and transform
+			return (SpriteVertex::size + 1) * sizeof(float);
+		}
+	}
+
+	void setInstanceLayout(const SpriteFormat format, VertexBufferLayout& layout)
+	{
+		layout.clear();
+		if (format == SpriteFormat::Compact)
+		{
+			layout.push(VertexBufferElement("transform", VertexBufferElement::Type::Float, 3, true, true));
+			layout.push(VertexBufferElement("transform", VertexBufferElement::Type::Float, 3, true, true));
+			layout.push(VertexBufferElement("crop", VertexBufferElement::Type::UnsignedShort, 4, true, true));
+			layout.push(VertexBufferElement("color", VertexBufferElement::Type::UnsignedByte, 4, true, true));
+			layout.push(VertexBufferElement("texture", VertexBufferElement::Type::UnsignedShort, 1, false, true));
+			layout.push(VertexBufferElement("depth", VertexBufferElement::Type::HalfFloat, 1, true, true));
+		}
+		else
+		{
+			layout.push(VertexBufferElement("texture", VertexBufferElement::Type::Float, 1, true, true));
+			layout.push(VertexBufferElement("crop", VertexBufferElement::Type::Float, 4, true, true));
+			layout.push(VertexBufferElement("color", VertexBufferElement::Type::Float, 4, true, true));
+			layout.push(VertexBufferElement("transform", VertexBufferElement::Type::Float, 4, true, true));
+			layout.push(VertexBufferElement("transform", VertexBufferElement::Type::Float, 4, true, true));
+			layout.push(VertexBufferElement("transform", VertexBufferElement::Type::Float, 4, true, true));
+			layout.push(VertexBufferElement("transform", VertexBufferElement::Type::Float, 4, true, true));
+		}
+		layout.startingIndex = 2;
+	}
+
+	void writeInstance(void* const data, const SpriteFormat format, const size_t textureIndex, const SpriteVertex& vertex, const bool premultiply)
+	{
+		if (premultiply)
+		{
+			SpriteVertex premultiplied = vertex;
+			premultiplied.color.red *= vertex.color.alpha;
+			premultiplied.color.green *= vertex.color.alpha;
+			premultiplied.color.blue *= vertex.color.alpha;
+			writeInstance(data, format, textureIndex, premultiplied);
+			return;
+		}
+
+		if (format == SpriteFormat::Compact)
+		{
+			packInstance(vertex, static_cast<uint16_t>(textureIndex), *static_cast<CompactSpriteInstance*>(data));
+			return;
+		}
+
+		float* const instance = static_cast<float*>(data);
+		instance[0] = static_cast<float>(textureIndex);
+		std::copy(vertex.rect.data, vertex.rect.data + 4, instance + 1);
+		std::copy(vertex.color.data, vertex.color.data + 4, instance + 5);
+		std::copy(vertex.transform.data, vertex.transform.data + vertex.transform.length, instance + 9);
+	}
+
+	void packInstance(const SpriteVertex& vertex, const uint16_t textureIndex, CompactSpriteInstance& instance)
+	{
+		// the matrix is stored by columns, keep the x, y and translation ones
+		const float* const matrix = vertex.transform.data;
+		instance.transform[0] = matrix[0];
+		instance.transform[1] = matrix[4];
+		instance.transform[2] = matrix[12];
+		instance.transform[3] = matrix[1];
+		instance.transform[4] = matrix[5];
+		instance.transform[5] = matrix[13];
+
+#ifdef VDTGRAPHICS_SSE2
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 one = _mm_set1_ps(1.0f);
+
+		// crop, unsigned 16 bits saturation is emulated on the signed one
+		const __m128 crop = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(vertex.rect.data), zero), one);
+		__m128i crop32 = _mm_cvtps_epi32(_mm_mul_ps(crop, _mm_set1_ps(65535.0f)));
+		crop32 = _mm_sub_epi32(crop32, _mm_set1_epi32(32768));
+		const __m128i crop16 = _mm_xor_si128(_mm_packs_epi32(crop32, crop32), _mm_set1_epi16(static_cast<short>(0x8000)));
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(instance.crop), crop16);
+
+		// color
+		const __m128 color = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(vertex.color.data), zero), one);
+		const __m128i color32 = _mm_cvtps_epi32(_mm_mul_ps(color, _mm_set1_ps(255.0f)));
+		const __m128i color16 = _mm_packs_epi32(color32, color32);
+		const int color8 = _mm_cvtsi128_si32(_mm_packus_epi16(color16, color16));
+		std::memcpy(instance.color, &color8, sizeof(instance.color));
+#else
+		for (size_t i = 0; i < 4; ++i)
+		{
+			const float crop = std::min(std::max(vertex.rect.data[i], 0.0f), 1.0f);
+			instance.crop[i] = static_cast<uint16_t>(crop * 65535.0f + 0.5f);
+			const float color = std::min(std::max(vertex.color.data[i], 0.0f), 1.0f);
+			instance.color[i] = static_cast<uint8_t>(color * 255.0f + 0.5f);
+		}
+#endif
+
+		instance.textureIndex = textureIndex;
+		instance.depth = toHalfFloat(matrix[14]);
+	}
+
+	uint16_t toHalfFloat(const float value)
+	{
+		uint32_t bits = 0;
+		std::memcpy(&bits, &value, sizeof(bits));
+
+		const uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+		const int exponent = static_cast<int>((bits >> 23) & 0xff) - 127 + 15;
+		uint32_t mantissa = bits & 0x7fffff;
+
+		// NaN
+		if ((bits & 0x7fffffff) > 0x7f800000) return sign | 0x7e00;
+		// infinity or too big
+		if (exponent >= 31) return sign | 0x7c00;
+
+		if (exponent <= 0)
+		{
+			// too small even for a denormal
+			if (exponent < -10) return sign;
+
+			mantissa |= 0x800000;
+			const int shift = 14 - exponent;
+			uint16_t half = static_cast<uint16_t>(mantissa >> shift);
+			if ((mantissa >> (shift - 1)) & 1) ++half;
+			return sign | half;
+		}
+
+		uint16_t half = static_cast<uint16_t>(sign | (exponent << 10) | (mantissa >> 13));
+		// round to nearest, a carry correctly moves into the exponent
+		if (mantissa & 0x1000) ++half;
+		return half;
+	}
+}
@@ -0,0 +1,256 @@
+#include <vdtgraphics/sprite_layer.h>
+
+#include <algorithm>
+
+#include <vdtgraphics/texture.h>
+#include <vdtgraphics/vertex_buffer.h>
+
+namespace graphics
+{
+	SpriteLayer::SpriteLayer(const size_t capacity, const SpriteFormat format)
+		: m_format(format)
+		, m_capacity(std::max<size_t>(capacity, 1))
+		, m_data()
+		, m_sprites()
+		, m_handles()
+		, m_indices()
+		, m_freeHandles()
+		, m_dirtyRanges()
+		, m_textures()
+		, m_textureReferences()
+		, m_numOfTextures(0)
+		, m_buffer()
+		, m_uploadedBytes(0)
+	{
+		m_data.reserve(m_capacity * getInstanceSize(m_format));
+		m_sprites.reserve(m_capacity);
+		m_handles.reserve(m_capacity);
+	}
+
+	SpriteLayer::~SpriteLayer() = default;
+
+	SpriteLayer::Handle SpriteLayer::add(Texture* const texture, const math::mat4& transform, const TextureRect& rect, const Color& color)
+	{
+		// the layer samples plain textures, not the layers of an array
+		if (texture == nullptr || texture->getArray() != nullptr) return invalid_handle;
+		// and draws them with a single blend function
+		const bool hasTextures = std::any_of(m_textures.begin(), m_textures.begin() + m_numOfTextures, [](Texture* const used) { return used != nullptr; });
+		if (hasTextures && texture->isPremultiplied() != isPremultiplied()) return invalid_handle;
+
+		const size_t textureIndex = findTexture(texture);
+		if (textureIndex >= max_texture_units) return invalid_handle;
+		++m_textureReferences[textureIndex];
+
+		Handle handle = invalid_handle;
+		if (m_freeHandles.empty())
+		{
+			handle = static_cast<Handle>(m_indices.size());
+			m_indices.push_back(0);
+		}
+		else
+		{
+			handle = m_freeHandles.back();
+			m_freeHandles.pop_back();
+		}
+
+		const size_t index = m_sprites.size();
+		m_indices[handle] = static_cast<uint32_t>(index);
+		m_handles.push_back(handle);
+		m_sprites.push_back({ { transform, color, rect }, textureIndex });
+		m_data.resize(m_data.size() + getInstanceSize(m_format));
+		write(index);
+		return handle;
+	}
+
+	SpriteLayer::Handle SpriteLayer::add(Texture* const texture, const math::vec3& position, const TextureRect& rect, const Color& color)
+	{
+		return add(texture, math::matrix4::translate(position), rect, color);
+	}
+
+	bool SpriteLayer::update(const Handle handle, const math::mat4& transform)
+	{
+		if (!contains(handle)) return false;
+
+		const size_t index = m_indices[handle];
+		m_sprites[index].vertex.transform = transform;
+		write(index);
+		return true;
+	}
+
+	bool SpriteLayer::update(const Handle handle, const math::mat4& transform, const TextureRect& rect, const Color& color)
+	{
+		if (!contains(handle)) return false;
+
+		const size_t index = m_indices[handle];
+		m_sprites[index].vertex = { transform, color, rect };
+		write(index);
+		return true;
+	}
+
+	bool SpriteLayer::remove(const Handle handle)
+	{
+		if (!contains(handle)) return false;
+
+		const size_t index = m_indices[handle];
+		releaseTexture(m_sprites[index].textureIndex);
+
+		// keep the instances contiguous moving the last one in the hole
+		const size_t last = m_sprites.size() - 1;
+		if (index != last)
+		{
+			const size_t instanceSize = getInstanceSize(m_format);
+			std::copy(m_data.begin() + last * instanceSize, m_data.end(), m_data.begin() + index * instanceSize);
+			m_sprites[index] = m_sprites[last];
+			m_handles[index] = m_handles[last];
+			m_indices[m_handles[index]] = static_cast<uint32_t>(index);
+			setDirty(index);
+		}
+
+		m_sprites.pop_back();
+		m_handles.pop_back();
+		m_data.resize(m_data.size() - getInstanceSize(m_format));
+		m_indices[handle] = invalid_handle;
+		m_freeHandles.push_back(handle);
+		return true;
+	}
+
+	bool SpriteLayer::contains(const Handle handle) const
+	{
+		return handle < m_indices.size() && m_indices[handle] != invalid_handle;
+	}
+
+	void SpriteLayer::clear()
+	{
+		m_data.clear();
+		m_sprites.clear();
+		m_handles.clear();
+		m_indices.clear();
+		m_freeHandles.clear();
+		m_dirtyRanges.clear();
+		m_textures.fill(nullptr);
+		m_textureReferences.fill(0);
+		m_numOfTextures = 0;
+	}
+
+	VertexBuffer* const SpriteLayer::upload()
+	{
+		m_uploadedBytes = 0;
+		const size_t instanceSize = getInstanceSize(m_format);
+
+		if (m_buffer == nullptr || m_sprites.size() > m_capacity)
+		{
+			// grow the storage and upload everything
+			while (m_capacity < m_sprites.size())
+			{
+				m_capacity *= 2;
+			}
+
+			if (m_buffer != nullptr)
+			{
+				m_buffer->free();
+			}
+			m_buffer = std::make_unique<VertexBuffer>(m_capacity * instanceSize, BufferUsageMode::Dynamic);
+			setInstanceLayout(m_format, m_buffer->layout);
+			m_dirtyRanges.clear();
+			m_dirtyRanges.push_back(std::make_pair(0, m_sprites.size()));
+		}
+
+		m_buffer->bind();
+		if (m_dirtyRanges.empty()) return m_buffer.get();
+
+		// merge the overlapping and adjacent ranges, then upload each span once
+		std::sort(m_dirtyRanges.begin(), m_dirtyRanges.end());
+		size_t begin = m_dirtyRanges.front().first;
+		size_t end = m_dirtyRanges.front().second;
+		const auto& flushRange = [this, instanceSize](const size_t first, const size_t last)
+		{
+			// removed instances don't need to be uploaded
+			const size_t count = std::min(last, m_sprites.size()) - std::min(first, m_sprites.size());
+			if (count == 0) return;
+
+			m_buffer->fillSubData(&m_data[first * instanceSize], count * instanceSize, static_cast<int>(first * instanceSize));
+			m_uploadedBytes += count * instanceSize;
+		};
+
+		for (const auto& range : m_dirtyRanges)
+		{
+			if (range.first <= end)
+			{
+				end = std::max(end, range.second);
+				continue;
+			}
+
+			flushRange(begin, end);
+			begin = range.first;
+			end = range.second;
+		}
+		flushRange(begin, end);
+
+		m_dirtyRanges.clear();
+		return m_buffer.get();
+	}
+
+	void SpriteLayer::write(const size_t index)
+	{
+		const Sprite& sprite = m_sprites[index];
+		const bool premultiply = m_textures[sprite.textureIndex]->isPremultiplied();
+		writeInstance(&m_data[index * getInstanceSize(m_format)], m_format, sprite.textureIndex, sprite.vertex, premultiply);
+		setDirty(index);
+	}
+
+	void SpriteLayer::setDirty(const size_t index)
+	{
+		// consecutive changes extend the last range
+		if (!m_dirtyRanges.empty())
+		{
+			std::pair<size_t, size_t>& range = m_dirtyRanges.back();
+			if (index >= range.first && index <= range.second)
+			{
+				range.second = std::max(range.second, index + 1);
+				return;
+			}
+		}
+		m_dirtyRanges.push_back(std::make_pair(index, index + 1));
+	}
+
+	bool SpriteLayer::isPremultiplied() const
+	{
+		for (size_t i = 0; i < m_numOfTextures; ++i)
+		{
+			if (m_textures[i] != nullptr) return m_textures[i]->isPremultiplied();
+		}
+		return false;
+	}
+
+	size_t SpriteLayer::findTexture(Texture* const texture)
+	{
+		size_t freeSlot = max_texture_units;
+		for (size_t i = 0; i < m_numOfTextures; ++i)
+		{
+			if (m_textures[i] == texture) return i;
+			if (m_textures[i] == nullptr && freeSlot == max_texture_units)
+			{
+				freeSlot = i;
+			}
+		}
+
+		if (freeSlot == max_texture_units && m_numOfTextures < max_texture_units)
+		{
+			freeSlot = m_numOfTextures++;
+		}
+
+		if (freeSlot < max_texture_units)
+		{
+			m_textures[freeSlot] = texture;
+		}
+		return freeSlot;
+	}
+
+	void SpriteLayer::releaseTexture(const size_t textureIndex)
+	{
+		if (--m_textureReferences[textureIndex] == 0)
+		{
+			m_textures[textureIndex] = nullptr;
+		}
+	}
+}
@@ -1,14 +1,56 @@
 #include <vdtgraphics/texture.h>
 
+#include <algorithm>
+
 #include <glad/glad.h>
 
+#include <vdtgraphics/gl_state_cache.h>
+#include <vdtgraphics/texture_array.h>
+#include <vdtgraphics/texture_codec.h>
+
 namespace graphics
 {
+	namespace
+	{
+		// immutable storage takes a sized format, the compressed ones already are
+		unsigned int toInternalFormat(const unsigned int format)
+		{
+			switch (format)
+			{
+			case GL_RED: return GL_R8;
+			case GL_RG: return GL_RG8;
+			case GL_RGB: return GL_RGB8;
+			case GL_RGBA: return GL_RGBA8;
+			default: return format;
+			}
+		}
+
+		// 0 levels is the whole chain if there is data to generate it from, a single level otherwise
+		unsigned int countLevels(const unsigned int levels, const unsigned int width, const unsigned int height, const bool hasData)
+		{
+			const unsigned int maxNumOfLevels = Texture::getMaxNumOfLevels(width, height);
+			if (levels == 0) return hasData ? maxNumOfLevels : 1;
+			return std::min(levels, maxNumOfLevels);
+		}
+
+		// on the bound texture
+		void setParameters(const Texture::Options& options)
+		{
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, options.wrapS);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, options.wrapT);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, options.filterMin);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, options.filterMax);
+		}
+	}
+
 	Texture::Options::Options()
 		: wrapS(GL_REPEAT)
 		, wrapT(GL_REPEAT)
 		, filterMin(GL_LINEAR)
 		, filterMax(GL_LINEAR)
+		, opacity(Opacity::Auto)
+		, immutable(false)
+		, levels(0)
 	{
 
 	}
@@ -18,30 +60,45 @@ namespace graphics
 		: m_id()
 		, m_width(width)
 		, m_height(height)
-		, m_format(channels)
+		, m_format(toFormat(channels))
+		, m_levels(countLevels(options.levels, width, height, data != nullptr))
+		, m_immutable(false)
+		, m_opaque(options.opacity == Opacity::Auto
+			? Image::isOpaque(data, width, height, channels)
+			: options.opacity == Opacity::Opaque)
+		, m_premultiplied(false)
+		, m_array(nullptr)
+		, m_layer(0)
 	{
 		// generate the texture
 		glGenTextures(1, &m_id);
-		glBindTexture(GL_TEXTURE_2D, m_id);
+		GLStateCache::get().bindTexture(GL_TEXTURE_2D, m_id);
 
 		/* set the texture wrapping/filtering options (on the currently bound texture object) */
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, options.wrapS);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, options.wrapT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, options.filterMin);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, options.filterMax);
-
-		if (channels == 1)
-			m_format = GL_RED;
-		else if (channels == 3)
-			m_format = GL_RGB;
-		else if (channels == 4)
-			m_format = GL_RGBA;
+		setParameters(options);
 
 		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-		glTexImage2D(GL_TEXTURE_2D, 0, m_format, width, height,
-			0, m_format, GL_UNSIGNED_BYTE, data
-		);
-		if (data != nullptr)
+		if (allocateStorage(options))
+		{
+			if (data != nullptr)
+			{
+				glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, m_format, GL_UNSIGNED_BYTE, data);
+			}
+		}
+		else
+		{
+			glTexImage2D(GL_TEXTURE_2D, 0, m_format, width, height,
+				0, m_format, GL_UNSIGNED_BYTE, data
+			);
+			// without data the other levels are left empty, otherwise generated
+			for (unsigned int i = 1; data == nullptr && i < m_levels; ++i)
+			{
+				glTexImage2D(GL_TEXTURE_2D, i, m_format, std::max(width >> i, 1u), std::max(height >> i, 1u),
+					0, m_format, GL_UNSIGNED_BYTE, nullptr
+				);
+			}
+		}
+		if (data != nullptr && m_levels > 1)
 		{
 			glGenerateMipmap(GL_TEXTURE_2D);
 		}
@@ -52,6 +109,126 @@ namespace graphics
 	{
 	}
 
+	Texture::Texture(const CompressedImage& image, const Options& options)
+		: m_id()
+		, m_width(image.width)
+		, m_height(image.height)
+		, m_format(CompressedImage::getGLFormat(image.format))
+		// the chain may stop before 1x1
+		, m_levels(static_cast<unsigned int>(std::max<size_t>(image.levels.size(), 1)))
+		, m_immutable(false)
+		, m_opaque(options.opacity == Opacity::Auto
+			? !CompressedImage::hasAlpha(image.format)
+			: options.opacity == Opacity::Opaque)
+		, m_premultiplied(false)
+		, m_array(nullptr)
+		, m_layer(0)
+	{
+		glGenTextures(1, &m_id);
+		GLStateCache::get().bindTexture(GL_TEXTURE_2D, m_id);
+		setParameters(options);
+
+		const int numOfLevels = static_cast<int>(image.levels.size());
+		if (CompressedImage::isSupported(image.format))
+		{
+			const bool immutable = allocateStorage(options);
+			for (int i = 0; i < numOfLevels; ++i)
+			{
+				const CompressedImage::Level& level = image.levels[i];
+				if (immutable)
+				{
+					glCompressedTexSubImage2D(GL_TEXTURE_2D, i, 0, 0, level.width, level.height,
+						m_format, static_cast<GLsizei>(level.size), image.getLevelData(i)
+					);
+				}
+				else
+				{
+					glCompressedTexImage2D(GL_TEXTURE_2D, i, m_format, level.width, level.height,
+						0, static_cast<GLsizei>(level.size), image.getLevelData(i)
+					);
+				}
+			}
+			return;
+		}
+
+		// decoded on the CPU, the texture takes the memory of RGBA
+		m_format = GL_RGBA;
+		const bool immutable = allocateStorage(options);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		for (int i = 0; i < numOfLevels; ++i)
+		{
+			const CompressedImage::Level& level = image.levels[i];
+			const std::shared_ptr<unsigned char> pixels = TextureCodec::decode(image, i);
+			if (immutable)
+			{
+				glTexSubImage2D(GL_TEXTURE_2D, i, 0, 0, level.width, level.height, m_format, GL_UNSIGNED_BYTE, pixels.get());
+			}
+			else
+			{
+				glTexImage2D(GL_TEXTURE_2D, i, m_format, level.width, level.height,
+					0, m_format, GL_UNSIGNED_BYTE, pixels.get()
+				);
+			}
+			if (i == 0 && options.opacity == Opacity::Auto)
+			{
+				m_opaque = Image::isOpaque(pixels.get(), level.width, level.height, 4);
+			}
+		}
+	}
+
+	Texture::Texture(const TextureFile& file, const Options& options)
+		: m_id()
+		, m_width(file.getWidth())
+		, m_height(file.getHeight())
+		, m_format(toFormat(file.getChannels()))
+		, m_levels(static_cast<unsigned int>(std::max<size_t>(file.getNumOfLevels(), 1)))
+		, m_immutable(false)
+		, m_opaque(options.opacity == Opacity::Auto
+			? file.isOpaque()
+			: options.opacity == Opacity::Opaque)
+		, m_premultiplied(file.isPremultiplied())
+		, m_array(nullptr)
+		, m_layer(0)
+	{
+		glGenTextures(1, &m_id);
+		GLStateCache::get().bindTexture(GL_TEXTURE_2D, m_id);
+		setParameters(options);
+
+		const bool immutable = allocateStorage(options);
+		const int numOfLevels = static_cast<int>(file.getNumOfLevels());
+
+		// the driver reads the mapped pages, faulting them in once
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		for (int i = 0; i < numOfLevels; ++i)
+		{
+			const Image level = file.getLevel(i);
+			if (immutable)
+			{
+				glTexSubImage2D(GL_TEXTURE_2D, i, 0, 0, level.width, level.height, m_format, GL_UNSIGNED_BYTE, level.data.get());
+			}
+			else
+			{
+				glTexImage2D(GL_TEXTURE_2D, i, m_format, level.width, level.height,
+					0, m_format, GL_UNSIGNED_BYTE, level.data.get()
+				);
+			}
+		}
+	}
+
+	Texture::Texture(TextureArray* const array, const unsigned int layer)
+		: m_id(array->id())
+		, m_width(array->getWidth())
+		, m_height(array->getHeight())
+		, m_format(array->getFormat())
+		, m_levels(1)
+		, m_immutable(false)
+		, m_opaque(false)
+		, m_premultiplied(false)
+		, m_array(array)
+		, m_layer(layer)
+	{
+	}
+
 	Texture::~Texture()
 	{
 		free();
@@ -59,31 +236,127 @@ namespace graphics
 
 	void Texture::fillSubData(const int offsetX, const int offsetY, const int width, const int height, unsigned char* const data)
 	{
+		if (m_array != nullptr)
+		{
+			m_array->fillSubData(m_layer, offsetX, offsetY, width, height, data);
+			return;
+		}
+
+		if (isCompressed()) return;
+
+		GLStateCache::get().bindTexture(GL_TEXTURE_2D, m_id);
 		glTexSubImage2D(GL_TEXTURE_2D, 0, offsetX, offsetY, width, height, m_format, GL_UNSIGNED_BYTE, data);
 	}
 
 	void Texture::resize(const int width, const int height)
 	{
+		// all the layers of an array share the same size
+		if (m_array != nullptr || m_immutable || isCompressed()) return;
+
 		m_width = width;
 		m_height = height;
+		// the old levels would leave the texture incomplete
+		m_levels = 1;
+		GLStateCache::get().bindTexture(GL_TEXTURE_2D, m_id);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
 		glTexImage2D(GL_TEXTURE_2D, 0, m_format, width, height,
 			0, m_format, GL_UNSIGNED_BYTE, nullptr
 		);
 	}
 
+	void Texture::setOptions(const Options& options)
+	{
+		if (options.opacity != Opacity::Auto)
+		{
+			m_opaque = options.opacity == Opacity::Opaque;
+		}
+
+		// the parameters of a layer belong to its array
+		if (m_array != nullptr) return;
+
+		GLStateCache::get().bindTexture(GL_TEXTURE_2D, m_id);
+		setParameters(options);
+	}
+
+	bool Texture::isCompressed() const
+	{
+		switch (m_format)
+		{
+		case GL_RED:
+		case GL_RG:
+		case GL_RGB:
+		case GL_RGBA:
+			return false;
+		default:
+			return true;
+		}
+	}
+
+	unsigned int Texture::getMaxNumOfLevels(const unsigned int width, const unsigned int height)
+	{
+		unsigned int numOfLevels = 1;
+		for (unsigned int size = std::max(width, height); size > 1; size >>= 1)
+		{
+			++numOfLevels;
+		}
+		return numOfLevels;
+	}
+
+	unsigned int Texture::toFormat(const unsigned int channels)
+	{
+		if (channels == 1) return GL_RED;
+		if (channels == 2) return GL_RG;
+		if (channels == 3) return GL_RGB;
+		return GL_RGBA;
+	}
+
+	size_t Texture::getPixelSize(const unsigned int format)
+	{
+		switch (format)
+		{
+		case GL_RED: return 1;
+		case GL_RG: return 2;
+		case GL_RGB: return 3;
+		case GL_RGBA:
+		default: return 4;
+		}
+	}
+
 	void Texture::bind(const unsigned int slot)
 	{
-		glActiveTexture(GL_TEXTURE0 + slot);
-		glBindTexture(GL_TEXTURE_2D, m_id);
+		if (m_array != nullptr)
+		{
+			m_array->bind(slot);
+			return;
+		}
+
+		GLStateCache::get().bindTexture(slot, GL_TEXTURE_2D, m_id);
 	}
 
 	void Texture::unbind()
 	{
-		glBindTexture(GL_TEXTURE_2D, 0);
+		GLStateCache::get().bindTexture(GL_TEXTURE_2D, 0);
+	}
+
+	bool Texture::allocateStorage(const Options& options)
+	{
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<int>(m_levels) - 1);
+
+		// glTexStorage2D is core since 4.2, and not loaded by older contexts
+		m_immutable = options.immutable && glTexStorage2D != nullptr;
+		if (m_immutable)
+		{
+			glTexStorage2D(GL_TEXTURE_2D, static_cast<GLsizei>(m_levels), toInternalFormat(m_format), m_width, m_height);
+		}
+		return m_immutable;
 	}
 
 	void Texture::free()
 	{
+		// the storage of a layer belongs to its array
+		if (m_array != nullptr) return;
+
+		GLStateCache::get().onTextureDeleted(m_id);
 		glDeleteTextures(1, &m_id);
 	}
 }
\ No newline at end of file
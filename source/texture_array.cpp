@@ -0,0 +1,114 @@
+#include <vdtgraphics/texture_array.h>
+
+#include <glad/glad.h>
+
+#include <vdtgraphics/gl_state_cache.h>
+
+namespace graphics
+{
+	TextureArray::TextureArray(const unsigned int width, const unsigned int height, const unsigned int channels,
+		const unsigned int capacity, const Texture::Options& options /* = Options */)
+		: m_id()
+		, m_width(width)
+		, m_height(height)
+		, m_format(Texture::toFormat(channels))
+		, m_capacity(capacity)
+		, m_layers()
+		, m_dirty(false)
+	{
+		glGenTextures(1, &m_id);
+		GLStateCache::get().bindTexture(GL_TEXTURE_2D_ARRAY, m_id);
+
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, options.wrapS);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, options.wrapT);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, options.filterMin);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, options.filterMax);
+
+		glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, m_format, width, height, capacity,
+			0, m_format, GL_UNSIGNED_BYTE, nullptr
+		);
+
+		m_layers.reserve(capacity);
+	}
+
+	TextureArray::~TextureArray()
+	{
+		free();
+	}
+
+	bool TextureArray::isCompatible(const unsigned int width, const unsigned int height, const unsigned int channels) const
+	{
+		return width == m_width && height == m_height && Texture::toFormat(channels) == m_format;
+	}
+
+	bool TextureArray::isCompatible(const Image& image) const
+	{
+		return isCompatible(image.width, image.height, image.channels);
+	}
+
+	Texture* const TextureArray::add(const unsigned char* const data, const unsigned int width, const unsigned int height, const unsigned int channels)
+	{
+		if (!isValid() || m_layers.size() >= m_capacity || !isCompatible(width, height, channels))
+		{
+			return nullptr;
+		}
+
+		const unsigned int layer = static_cast<unsigned int>(m_layers.size());
+		m_layers.push_back(std::unique_ptr<Texture>(new Texture(this, layer)));
+		if (data != nullptr)
+		{
+			fillSubData(layer, 0, 0, width, height, data);
+			m_layers.back()->m_opaque = Image::isOpaque(data, width, height, channels);
+		}
+		return m_layers.back().get();
+	}
+
+	Texture* const TextureArray::add(const Image& image)
+	{
+		return add(image.data.get(), image.width, image.height, image.channels);
+	}
+
+	Texture* const TextureArray::getLayer(const size_t layer) const
+	{
+		return layer < m_layers.size() ? m_layers[layer].get() : nullptr;
+	}
+
+	void TextureArray::fillSubData(const unsigned int layer, const int offsetX, const int offsetY, const int width, const int height, const unsigned char* const data)
+	{
+		GLStateCache::get().bindTexture(GL_TEXTURE_2D_ARRAY, m_id);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, offsetX, offsetY, layer, width, height, 1,
+			m_format, GL_UNSIGNED_BYTE, data
+		);
+		m_dirty = true;
+	}
+
+	void TextureArray::generateMipmaps()
+	{
+		if (!m_dirty) return;
+
+		GLStateCache::get().bindTexture(GL_TEXTURE_2D_ARRAY, m_id);
+		glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+		m_dirty = false;
+	}
+
+	void TextureArray::bind(const unsigned int slot)
+	{
+		// on the active unit, before the unit of the slot is bound
+		generateMipmaps();
+		GLStateCache::get().bindTexture(slot, GL_TEXTURE_2D_ARRAY, m_id);
+	}
+
+	void TextureArray::unbind()
+	{
+		GLStateCache::get().bindTexture(GL_TEXTURE_2D_ARRAY, 0);
+	}
+
+	void TextureArray::free()
+	{
+		m_layers.clear();
+		GLStateCache::get().onTextureDeleted(m_id);
+		glDeleteTextures(1, &m_id);
+		m_id = 0;
+	}
+}
@@ -0,0 +1,208 @@
+#include <vdtgraphics/texture_atlas.h>
+
+#include <algorithm>
+#include <limits>
+
+namespace graphics
+{
+	TextureAtlas::TextureAtlas(const unsigned int pageWidth, const unsigned int pageHeight,
+		const unsigned int padding, const Texture::Options& options /* = Options */)
+		: m_pageWidth(pageWidth)
+		, m_pageHeight(pageHeight)
+		, m_padding(padding)
+		, m_options(options)
+		, m_pages()
+	{
+	}
+
+	bool TextureAtlas::insert(const unsigned char* const data, const unsigned int width, const unsigned int height, const unsigned int channels, Region& region)
+	{
+		const unsigned int cellWidth = width + 2 * m_padding;
+		const unsigned int cellHeight = height + 2 * m_padding;
+		if (data == nullptr || width == 0 || height == 0 || channels == 0 || channels > 4
+			|| cellWidth > m_pageWidth || cellHeight > m_pageHeight)
+		{
+			return false;
+		}
+
+		// the first page with room, so that holes left in the old pages get filled
+		Page* page = nullptr;
+		size_t pageIndex = 0;
+		size_t index = 0;
+		unsigned int x = 0, y = 0;
+		for (; pageIndex < m_pages.size(); ++pageIndex)
+		{
+			if (findPosition(m_pages[pageIndex], cellWidth, cellHeight, index, x, y))
+			{
+				page = &m_pages[pageIndex];
+				break;
+			}
+		}
+
+		if (page == nullptr)
+		{
+			page = &addPage();
+			if (!findPosition(*page, cellWidth, cellHeight, index, x, y)) return false;
+		}
+
+		addSkylineLevel(*page, index, x, y, cellWidth, cellHeight);
+		page->usedArea += static_cast<size_t>(width) * height;
+
+		// copy the image as RGBA, repeating its edges in the padding against bleeding
+		std::vector<unsigned char> pixels(static_cast<size_t>(cellWidth) * cellHeight * 4);
+		for (unsigned int j = 0; j < cellHeight; ++j)
+		{
+			const unsigned int sourceY = static_cast<unsigned int>(std::min(std::max(static_cast<int>(j) - static_cast<int>(m_padding), 0), static_cast<int>(height) - 1));
+			for (unsigned int i = 0; i < cellWidth; ++i)
+			{
+				const unsigned int sourceX = static_cast<unsigned int>(std::min(std::max(static_cast<int>(i) - static_cast<int>(m_padding), 0), static_cast<int>(width) - 1));
+				const unsigned char* const source = data + (static_cast<size_t>(sourceY) * width + sourceX) * channels;
+				unsigned char* const destination = &pixels[(static_cast<size_t>(j) * cellWidth + i) * 4];
+				switch (channels)
+				{
+				case 1:
+					destination[0] = destination[1] = destination[2] = source[0];
+					destination[3] = 255;
+					break;
+				case 2:
+					destination[0] = destination[1] = destination[2] = source[0];
+					destination[3] = source[1];
+					break;
+				case 3:
+					std::copy(source, source + 3, destination);
+					destination[3] = 255;
+					break;
+				default:
+					std::copy(source, source + 4, destination);
+					break;
+				}
+			}
+		}
+
+		page->texture->bind();
+		page->texture->fillSubData(x, y, cellWidth, cellHeight, &pixels[0]);
+
+		region.texture = page->texture.get();
+		region.rect = TextureRect(
+			static_cast<float>(x + m_padding) / m_pageWidth,
+			static_cast<float>(y + m_padding) / m_pageHeight,
+			static_cast<float>(width) / m_pageWidth,
+			static_cast<float>(height) / m_pageHeight
+		);
+		region.page = pageIndex;
+		return true;
+	}
+
+	bool TextureAtlas::insert(const Image& image, Region& region)
+	{
+		return insert(image.data.get(), image.width, image.height, image.channels, region);
+	}
+
+	Texture* const TextureAtlas::getPage(const size_t page) const
+	{
+		return page < m_pages.size() ? m_pages[page].texture.get() : nullptr;
+	}
+
+	float TextureAtlas::getOccupancy(const size_t page) const
+	{
+		if (page >= m_pages.size()) return 0.f;
+		return static_cast<float>(m_pages[page].usedArea) / (static_cast<float>(m_pageWidth) * m_pageHeight);
+	}
+
+	float TextureAtlas::getOccupancy() const
+	{
+		if (m_pages.empty()) return 0.f;
+
+		size_t usedArea = 0;
+		for (const Page& page : m_pages)
+		{
+			usedArea += page.usedArea;
+		}
+		return static_cast<float>(usedArea) / (static_cast<float>(m_pageWidth) * m_pageHeight * m_pages.size());
+	}
+
+	void TextureAtlas::clear()
+	{
+		m_pages.clear();
+	}
+
+	bool TextureAtlas::findPosition(const Page& page, const unsigned int width, const unsigned int height, size_t& index, unsigned int& x, unsigned int& y) const
+	{
+		unsigned int bestBottom = std::numeric_limits<unsigned int>::max();
+		unsigned int bestWidth = std::numeric_limits<unsigned int>::max();
+		bool found = false;
+
+		for (size_t i = 0; i < page.skyline.size(); ++i)
+		{
+			const SkylineNode& node = page.skyline[i];
+			if (node.x + width > m_pageWidth) break;
+
+			// the rect rests on the highest node below it
+			unsigned int top = 0;
+			unsigned int covered = 0;
+			for (size_t j = i; covered < width; ++j)
+			{
+				top = std::max(top, page.skyline[j].y);
+				covered += page.skyline[j].width;
+			}
+			if (top + height > m_pageHeight) continue;
+
+			if (top + height < bestBottom || (top + height == bestBottom && node.width < bestWidth))
+			{
+				bestBottom = top + height;
+				bestWidth = node.width;
+				index = i;
+				x = node.x;
+				y = top;
+				found = true;
+			}
+		}
+		return found;
+	}
+
+	void TextureAtlas::addSkylineLevel(Page& page, const size_t index, const unsigned int x, const unsigned int y, const unsigned int width, const unsigned int height)
+	{
+		std::vector<SkylineNode>& skyline = page.skyline;
+		skyline.insert(skyline.begin() + index, { x, y + height, width });
+
+		// the nodes below the new level shrink or disappear
+		for (size_t i = index + 1; i < skyline.size();)
+		{
+			const SkylineNode& previous = skyline[i - 1];
+			const unsigned int previousEnd = previous.x + previous.width;
+			if (skyline[i].x >= previousEnd) break;
+
+			const unsigned int shrink = previousEnd - skyline[i].x;
+			if (skyline[i].width <= shrink)
+			{
+				skyline.erase(skyline.begin() + i);
+				continue;
+			}
+			skyline[i].x += shrink;
+			skyline[i].width -= shrink;
+			break;
+		}
+
+		// merge the neighbours at the same height
+		for (size_t i = 0; i + 1 < skyline.size();)
+		{
+			if (skyline[i].y == skyline[i + 1].y)
+			{
+				skyline[i].width += skyline[i + 1].width;
+				skyline.erase(skyline.begin() + i + 1);
+				continue;
+			}
+			++i;
+		}
+	}
+
+	TextureAtlas::Page& TextureAtlas::addPage()
+	{
+		Page page;
+		page.texture = std::make_shared<Texture>(nullptr, m_pageWidth, m_pageHeight, 4, m_options);
+		page.skyline.push_back({ 0, 0, m_pageWidth });
+		page.usedArea = 0;
+		m_pages.push_back(std::move(page));
+		return m_pages.back();
+	}
+}
@@ -0,0 +1,1161 @@
+#include <vdtgraphics/texture_codec.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VDTGRAPHICS_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace graphics
+{
+	namespace
+	{
+		typedef CompressedImage::Format Format;
+
+		constexpr int block_pixels = 16;
+
+		int clamp255(const int value)
+		{
+			return std::min(std::max(value, 0), 255);
+		}
+
+		int quantize(const float value, const int maximum)
+		{
+			return std::min(std::max(static_cast<int>(std::lround(value * maximum / 255.0f)), 0), maximum);
+		}
+
+		// bits to 8 bits, replicating the high ones
+		int expand(const int value, const int bits)
+		{
+			return (value << (8 - bits)) | (value >> (2 * bits - 8));
+		}
+
+		// the channels of the pixels side by side, the layout of the distance search
+		struct Planes
+		{
+			alignas(16) float channels[4][block_pixels];
+		};
+
+		Planes toPlanes(const unsigned char* const pixels)
+		{
+			Planes planes;
+			for (int i = 0; i < block_pixels; ++i)
+			{
+				for (int c = 0; c < 4; ++c)
+				{
+					planes.channels[c][i] = pixels[i * 4 + c];
+				}
+			}
+			return planes;
+		}
+
+		// the nearest entry of the palette to each pixel, over the first numOfChannels channels.
+		// Returns the sum of the squared errors, the error of each pixel is written if asked
+		float selectIndices(const Planes& planes, const int numOfChannels, const float(*palette)[4], const int paletteSize,
+			uint8_t* const indices, float* const errors = nullptr)
+		{
+			float total = 0.0f;
+#ifdef VDTGRAPHICS_SSE2
+			for (int group = 0; group < block_pixels; group += 4)
+			{
+				__m128 best = _mm_set1_ps(FLT_MAX);
+				__m128i bestIndex = _mm_setzero_si128();
+				for (int entry = 0; entry < paletteSize; ++entry)
+				{
+					__m128 distance = _mm_setzero_ps();
+					for (int c = 0; c < numOfChannels; ++c)
+					{
+						const __m128 difference = _mm_sub_ps(_mm_load_ps(planes.channels[c] + group), _mm_set1_ps(palette[entry][c]));
+						distance = _mm_add_ps(distance, _mm_mul_ps(difference, difference));
+					}
+					const __m128i closer = _mm_castps_si128(_mm_cmplt_ps(distance, best));
+					best = _mm_min_ps(distance, best);
+					bestIndex = _mm_or_si128(_mm_andnot_si128(closer, bestIndex), _mm_and_si128(closer, _mm_set1_epi32(entry)));
+				}
+
+				alignas(16) int32_t lanes[4];
+				alignas(16) float distances[4];
+				_mm_store_si128(reinterpret_cast<__m128i*>(lanes), bestIndex);
+				_mm_store_ps(distances, best);
+				for (int i = 0; i < 4; ++i)
+				{
+					indices[group + i] = static_cast<uint8_t>(lanes[i]);
+					total += distances[i];
+					if (errors != nullptr) errors[group + i] = distances[i];
+				}
+			}
+#else
+			for (int i = 0; i < block_pixels; ++i)
+			{
+				float best = FLT_MAX;
+				for (int entry = 0; entry < paletteSize; ++entry)
+				{
+					float distance = 0.0f;
+					for (int c = 0; c < numOfChannels; ++c)
+					{
+						const float difference = planes.channels[c][i] - palette[entry][c];
+						distance += difference * difference;
+					}
+					if (distance < best)
+					{
+						best = distance;
+						indices[i] = static_cast<uint8_t>(entry);
+					}
+				}
+				total += best;
+				if (errors != nullptr) errors[i] = best;
+			}
+#endif
+			return total;
+		}
+
+		// the extremes of the pixels along their principal axis
+		void findEndpoints(const Planes& planes, const int numOfChannels, float* const low, float* const high)
+		{
+			float mean[4]{};
+			for (int c = 0; c < numOfChannels; ++c)
+			{
+				for (int i = 0; i < block_pixels; ++i) mean[c] += planes.channels[c][i];
+				mean[c] /= block_pixels;
+			}
+
+			float covariance[4][4]{};
+			for (int i = 0; i < block_pixels; ++i)
+			{
+				for (int a = 0; a < numOfChannels; ++a)
+				{
+					for (int b = 0; b < numOfChannels; ++b)
+					{
+						covariance[a][b] += (planes.channels[a][i] - mean[a]) * (planes.channels[b][i] - mean[b]);
+					}
+				}
+			}
+
+			// power iteration, a few steps are enough for the endpoints
+			float axis[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+			for (int step = 0; step < 8; ++step)
+			{
+				float next[4]{};
+				float length = 0.0f;
+				for (int a = 0; a < numOfChannels; ++a)
+				{
+					for (int b = 0; b < numOfChannels; ++b) next[a] += covariance[a][b] * axis[b];
+					length = std::max(length, std::abs(next[a]));
+				}
+				if (length == 0.0f) break;
+				for (int a = 0; a < numOfChannels; ++a) axis[a] = next[a] / length;
+			}
+
+			float lengthSquared = 0.0f;
+			for (int c = 0; c < numOfChannels; ++c) lengthSquared += axis[c] * axis[c];
+
+			float minimum = 0.0f, maximum = 0.0f;
+			for (int i = 0; i < block_pixels && lengthSquared > 0.0f; ++i)
+			{
+				float projection = 0.0f;
+				for (int c = 0; c < numOfChannels; ++c) projection += (planes.channels[c][i] - mean[c]) * axis[c];
+				minimum = std::min(minimum, projection);
+				maximum = std::max(maximum, projection);
+			}
+
+			for (int c = 0; c < numOfChannels; ++c)
+			{
+				const float direction = lengthSquared > 0.0f ? axis[c] / lengthSquared : 0.0f;
+				low[c] = std::min(std::max(mean[c] + minimum * direction, 0.0f), 255.0f);
+				high[c] = std::min(std::max(mean[c] + maximum * direction, 0.0f), 255.0f);
+			}
+		}
+
+		// least squares endpoints of the pixels given the weight of their indices,
+		// the first endpoint has weight 0. False if the indices select a single weight
+		bool refineEndpoints(const Planes& planes, const int numOfChannels, const uint8_t* const indices, const float* const weights,
+			float* const first, float* const second)
+		{
+			float a = 0.0f, b = 0.0f, c = 0.0f;
+			float sums0[4]{}, sums1[4]{};
+			for (int i = 0; i < block_pixels; ++i)
+			{
+				const float weight = weights[indices[i]];
+				a += (1.0f - weight) * (1.0f - weight);
+				b += (1.0f - weight) * weight;
+				c += weight * weight;
+				for (int channel = 0; channel < numOfChannels; ++channel)
+				{
+					sums0[channel] += (1.0f - weight) * planes.channels[channel][i];
+					sums1[channel] += weight * planes.channels[channel][i];
+				}
+			}
+
+			const float determinant = a * c - b * b;
+			if (std::abs(determinant) < 1e-6f) return false;
+
+			for (int channel = 0; channel < numOfChannels; ++channel)
+			{
+				first[channel] = std::min(std::max((c * sums0[channel] - b * sums1[channel]) / determinant, 0.0f), 255.0f);
+				second[channel] = std::min(std::max((a * sums1[channel] - b * sums0[channel]) / determinant, 0.0f), 255.0f);
+			}
+			return true;
+		}
+
+		// packs the bits of BC7, from the lowest of the first byte
+		class BitWriter
+		{
+		public:
+			BitWriter(unsigned char* const data) : m_data(data), m_position(0) { std::memset(data, 0, 16); }
+
+			void write(const uint32_t value, const int count)
+			{
+				for (int i = 0; i < count; ++i, ++m_position)
+				{
+					m_data[m_position / 8] |= static_cast<unsigned char>(((value >> i) & 1) << (m_position % 8));
+				}
+			}
+
+		private:
+			unsigned char* m_data;
+			int m_position;
+		};
+
+		class BitReader
+		{
+		public:
+			BitReader(const unsigned char* const data) : m_data(data), m_position(0) {}
+
+			uint32_t read(const int count)
+			{
+				uint32_t value = 0;
+				for (int i = 0; i < count; ++i, ++m_position)
+				{
+					value |= static_cast<uint32_t>((m_data[m_position / 8] >> (m_position % 8)) & 1) << i;
+				}
+				return value;
+			}
+
+		private:
+			const unsigned char* m_data;
+			int m_position;
+		};
+
+		// ETC and EAC blocks are big endian
+		uint64_t readBigEndian(const unsigned char* const data)
+		{
+			uint64_t value = 0;
+			for (int i = 0; i < 8; ++i) value = (value << 8) | data[i];
+			return value;
+		}
+
+		void writeBigEndian(const uint64_t value, unsigned char* const data)
+		{
+			for (int i = 0; i < 8; ++i) data[i] = static_cast<unsigned char>(value >> (56 - 8 * i));
+		}
+
+		uint32_t bits(const uint64_t value, const int high, const int low)
+		{
+			return static_cast<uint32_t>((value >> low) & ((1ull << (high - low + 1)) - 1));
+		}
+
+		// BC1 and the color of BC3
+
+		uint16_t to565(const float* const color)
+		{
+			return static_cast<uint16_t>((quantize(color[0], 31) << 11) | (quantize(color[1], 63) << 5) | quantize(color[2], 31));
+		}
+
+		void from565(const uint16_t value, int* const color)
+		{
+			color[0] = expand((value >> 11) & 31, 5);
+			color[1] = expand((value >> 5) & 63, 6);
+			color[2] = expand(value & 31, 5);
+		}
+
+		void encodeColorBlock(const Planes& planes, unsigned char* const block)
+		{
+			float first[4], second[4];
+			findEndpoints(planes, 3, second, first);
+
+			// the endpoints are fit again to the indices they select, the best ones are kept
+			constexpr float weights[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+			float bestError = FLT_MAX;
+			uint16_t color0 = 0, color1 = 0;
+			uint32_t packed = 0;
+			for (int iteration = 0; iteration < 3; ++iteration)
+			{
+				// the four colors mode needs the first endpoint greater
+				uint16_t candidate0 = to565(first), candidate1 = to565(second);
+				if (candidate0 < candidate1) std::swap(candidate0, candidate1);
+
+				int endpoint0[3], endpoint1[3];
+				from565(candidate0, endpoint0);
+				from565(candidate1, endpoint1);
+
+				float palette[4][4]{};
+				for (int c = 0; c < 3; ++c)
+				{
+					palette[0][c] = static_cast<float>(endpoint0[c]);
+					palette[1][c] = static_cast<float>(endpoint1[c]);
+					palette[2][c] = static_cast<float>((2 * endpoint0[c] + endpoint1[c]) / 3);
+					palette[3][c] = static_cast<float>((endpoint0[c] + 2 * endpoint1[c]) / 3);
+				}
+
+				uint8_t indices[block_pixels];
+				const float error = selectIndices(planes, 3, palette, 4, indices);
+				if (error >= bestError) break;
+
+				bestError = error;
+				color0 = candidate0;
+				color1 = candidate1;
+				packed = 0;
+				// equal endpoints are read in the three colors mode, only the first index is the same color
+				for (int i = 0; i < block_pixels && color0 != color1; ++i) packed |= static_cast<uint32_t>(indices[i]) << (2 * i);
+
+				if (error == 0.0f || color0 == color1 || !refineEndpoints(planes, 3, indices, weights, first, second)) break;
+			}
+
+			block[0] = static_cast<unsigned char>(color0);
+			block[1] = static_cast<unsigned char>(color0 >> 8);
+			block[2] = static_cast<unsigned char>(color1);
+			block[3] = static_cast<unsigned char>(color1 >> 8);
+			for (int i = 0; i < 4; ++i) block[4 + i] = static_cast<unsigned char>(packed >> (8 * i));
+		}
+
+		// BC3 colors always use four colors. The black of the three colors
+		// blocks stays opaque, the textures are created as RGB
+		void decodeColorBlock(const unsigned char* const block, const bool fourColors, unsigned char* const pixels)
+		{
+			const uint16_t color0 = static_cast<uint16_t>(block[0] | (block[1] << 8));
+			const uint16_t color1 = static_cast<uint16_t>(block[2] | (block[3] << 8));
+			int palette[4][4];
+			from565(color0, palette[0]);
+			from565(color1, palette[1]);
+			palette[0][3] = palette[1][3] = palette[2][3] = palette[3][3] = 255;
+			for (int c = 0; c < 3; ++c)
+			{
+				if (fourColors || color0 > color1)
+				{
+					palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+					palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+				}
+				else
+				{
+					palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+					palette[3][c] = 0;
+				}
+			}
+
+			const uint32_t packed = block[4] | (block[5] << 8) | (block[6] << 16) | (static_cast<uint32_t>(block[7]) << 24);
+			for (int i = 0; i < block_pixels; ++i)
+			{
+				const int index = (packed >> (2 * i)) & 3;
+				for (int c = 0; c < 4; ++c) pixels[i * 4 + c] = static_cast<unsigned char>(palette[index][c]);
+			}
+		}
+
+		// the alpha of BC3
+
+		void encodeAlphaBlock(const Planes& planes, unsigned char* const block)
+		{
+			const float* const alpha = planes.channels[3];
+			const int alpha0 = static_cast<int>(*std::max_element(alpha, alpha + block_pixels));
+			const int alpha1 = static_cast<int>(*std::min_element(alpha, alpha + block_pixels));
+
+			uint64_t packed = 0;
+			if (alpha0 != alpha1)
+			{
+				// the eight alphas mode, the first endpoint greater
+				float palette[8][4]{};
+				palette[0][0] = static_cast<float>(alpha0);
+				palette[1][0] = static_cast<float>(alpha1);
+				for (int i = 1; i < 7; ++i)
+				{
+					palette[i + 1][0] = static_cast<float>(((7 - i) * alpha0 + i * alpha1) / 7);
+				}
+
+				// the search runs on the alpha plane only
+				Planes alphaPlanes;
+				std::copy(alpha, alpha + block_pixels, alphaPlanes.channels[0]);
+
+				uint8_t indices[block_pixels];
+				selectIndices(alphaPlanes, 1, palette, 8, indices);
+				for (int i = 0; i < block_pixels; ++i) packed |= static_cast<uint64_t>(indices[i]) << (3 * i);
+			}
+
+			block[0] = static_cast<unsigned char>(alpha0);
+			block[1] = static_cast<unsigned char>(alpha1);
+			for (int i = 0; i < 6; ++i) block[2 + i] = static_cast<unsigned char>(packed >> (8 * i));
+		}
+
+		void decodeAlphaBlock(const unsigned char* const block, unsigned char* const pixels)
+		{
+			const int alpha0 = block[0], alpha1 = block[1];
+			int palette[8] = { alpha0, alpha1 };
+			if (alpha0 > alpha1)
+			{
+				for (int i = 1; i < 7; ++i) palette[i + 1] = ((7 - i) * alpha0 + i * alpha1) / 7;
+			}
+			else
+			{
+				for (int i = 1; i < 5; ++i) palette[i + 1] = ((5 - i) * alpha0 + i * alpha1) / 5;
+				palette[6] = 0;
+				palette[7] = 255;
+			}
+
+			uint64_t packed = 0;
+			for (int i = 0; i < 6; ++i) packed |= static_cast<uint64_t>(block[2 + i]) << (8 * i);
+			for (int i = 0; i < block_pixels; ++i)
+			{
+				pixels[i * 4 + 3] = static_cast<unsigned char>(palette[(packed >> (3 * i)) & 7]);
+			}
+		}
+
+		// BC7
+
+		constexpr int bc7_weights2[4] = { 0, 21, 43, 64 };
+		constexpr int bc7_weights3[8] = { 0, 9, 18, 27, 37, 46, 55, 64 };
+		constexpr int bc7_weights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+		int interpolate(const int endpoint0, const int endpoint1, const int weight)
+		{
+			return ((64 - weight) * endpoint0 + weight * endpoint1 + 32) >> 6;
+		}
+
+		// 7 bits per channel and a bit shared by the channels of the endpoint.
+		// Opaque endpoints keep the bit set, the alpha is exactly 255
+		void quantizeEndpoint(const float* const endpoint, const bool opaque, int* const quantized, int& parity)
+		{
+			float bestError = FLT_MAX;
+			for (int bit = opaque ? 1 : 0; bit < 2; ++bit)
+			{
+				int candidate[4];
+				float error = 0.0f;
+				for (int c = 0; c < 4; ++c)
+				{
+					candidate[c] = std::min(std::max(static_cast<int>(std::lround((endpoint[c] - bit) / 2.0f)), 0), 127);
+					const float difference = static_cast<float>((candidate[c] << 1) | bit) - endpoint[c];
+					error += difference * difference;
+				}
+				if (error < bestError)
+				{
+					bestError = error;
+					parity = bit;
+					std::copy(candidate, candidate + 4, quantized);
+				}
+			}
+			if (opaque) quantized[3] = 127;
+		}
+
+		// mode 6, a single subset with 4 bits indices. Returns the error
+		float encodeBC7Mode6(const Planes& planes, unsigned char* const block)
+		{
+			float low[4], high[4];
+			findEndpoints(planes, 4, low, high);
+
+			// the parity bit is shared with the color, an opaque block must not lose its alpha to it
+			const float* const alpha = planes.channels[3];
+			const bool opaque = std::all_of(alpha, alpha + block_pixels, [](const float value) { return value >= 255.0f; });
+
+			float weights[16];
+			for (int i = 0; i < 16; ++i) weights[i] = bc7_weights4[i] / 64.0f;
+
+			// the endpoints are fit again to the indices they select, the best ones are kept
+			float bestError = FLT_MAX;
+			int endpoints[2][4], parities[2];
+			uint8_t indices[block_pixels];
+			for (int iteration = 0; iteration < 3; ++iteration)
+			{
+				int candidates[2][4], candidateParities[2];
+				quantizeEndpoint(low, opaque, candidates[0], candidateParities[0]);
+				quantizeEndpoint(high, opaque, candidates[1], candidateParities[1]);
+
+				float palette[16][4];
+				for (int i = 0; i < 16; ++i)
+				{
+					for (int c = 0; c < 4; ++c)
+					{
+						palette[i][c] = static_cast<float>(interpolate((candidates[0][c] << 1) | candidateParities[0],
+							(candidates[1][c] << 1) | candidateParities[1], bc7_weights4[i]));
+					}
+				}
+
+				uint8_t candidateIndices[block_pixels];
+				const float error = selectIndices(planes, 4, palette, 16, candidateIndices);
+				if (error >= bestError) break;
+
+				bestError = error;
+				std::copy(&candidates[0][0], &candidates[0][0] + 8, &endpoints[0][0]);
+				std::copy(candidateParities, candidateParities + 2, parities);
+				std::copy(candidateIndices, candidateIndices + block_pixels, indices);
+
+				if (error == 0.0f || !refineEndpoints(planes, 4, candidateIndices, weights, low, high)) break;
+			}
+
+			// the high bit of the first index is implicitly 0
+			if (indices[0] >= 8)
+			{
+				std::swap(endpoints[0], endpoints[1]);
+				std::swap(parities[0], parities[1]);
+				for (uint8_t& index : indices) index = static_cast<uint8_t>(15 - index);
+			}
+
+			BitWriter writer(block);
+			writer.write(1 << 6, 7);
+			for (int c = 0; c < 4; ++c)
+			{
+				writer.write(endpoints[0][c], 7);
+				writer.write(endpoints[1][c], 7);
+			}
+			writer.write(parities[0], 1);
+			writer.write(parities[1], 1);
+			writer.write(indices[0], 3);
+			for (int i = 1; i < block_pixels; ++i) writer.write(indices[i], 4);
+			return bestError;
+		}
+
+		// mode 5, the color and the alpha with their own 2 bits indices. Returns the error
+		float encodeBC7Mode5(const Planes& planes, unsigned char* const block)
+		{
+			float low[4], high[4];
+			findEndpoints(planes, 3, low, high);
+
+			float weights[4];
+			for (int i = 0; i < 4; ++i) weights[i] = bc7_weights2[i] / 64.0f;
+
+			// the endpoints are fit again to the indices they select, the best ones are kept
+			float bestError = FLT_MAX;
+			int endpoints[2][3];
+			uint8_t colorIndices[block_pixels];
+			for (int iteration = 0; iteration < 3; ++iteration)
+			{
+				int candidates[2][3];
+				float palette[4][4]{};
+				for (int c = 0; c < 3; ++c)
+				{
+					candidates[0][c] = quantize(low[c], 127);
+					candidates[1][c] = quantize(high[c], 127);
+					for (int i = 0; i < 4; ++i)
+					{
+						palette[i][c] = static_cast<float>(interpolate(expand(candidates[0][c], 7), expand(candidates[1][c], 7), bc7_weights2[i]));
+					}
+				}
+
+				uint8_t candidateIndices[block_pixels];
+				const float error = selectIndices(planes, 3, palette, 4, candidateIndices);
+				if (error >= bestError) break;
+
+				bestError = error;
+				std::copy(&candidates[0][0], &candidates[0][0] + 6, &endpoints[0][0]);
+				std::copy(candidateIndices, candidateIndices + block_pixels, colorIndices);
+
+				if (error == 0.0f || !refineEndpoints(planes, 3, candidateIndices, weights, low, high)) break;
+			}
+
+			// the search runs on the alpha plane only
+			const float* const alpha = planes.channels[3];
+			int alphas[2] = {
+				static_cast<int>(*std::min_element(alpha, alpha + block_pixels)),
+				static_cast<int>(*std::max_element(alpha, alpha + block_pixels))
+			};
+			Planes alphaPlanes;
+			std::copy(alpha, alpha + block_pixels, alphaPlanes.channels[0]);
+			float alphaPalette[4][4]{};
+			for (int i = 0; i < 4; ++i) alphaPalette[i][0] = static_cast<float>(interpolate(alphas[0], alphas[1], bc7_weights2[i]));
+			uint8_t alphaIndices[block_pixels];
+			bestError += selectIndices(alphaPlanes, 1, alphaPalette, 4, alphaIndices);
+
+			// the high bit of the first indices is implicitly 0
+			if (colorIndices[0] >= 2)
+			{
+				std::swap(endpoints[0], endpoints[1]);
+				for (uint8_t& index : colorIndices) index = static_cast<uint8_t>(3 - index);
+			}
+			if (alphaIndices[0] >= 2)
+			{
+				std::swap(alphas[0], alphas[1]);
+				for (uint8_t& index : alphaIndices) index = static_cast<uint8_t>(3 - index);
+			}
+
+			BitWriter writer(block);
+			writer.write(1 << 5, 6);
+			// no rotation
+			writer.write(0, 2);
+			for (int c = 0; c < 3; ++c)
+			{
+				writer.write(endpoints[0][c], 7);
+				writer.write(endpoints[1][c], 7);
+			}
+			writer.write(alphas[0], 8);
+			writer.write(alphas[1], 8);
+			writer.write(colorIndices[0], 1);
+			for (int i = 1; i < block_pixels; ++i) writer.write(colorIndices[i], 2);
+			writer.write(alphaIndices[0], 1);
+			for (int i = 1; i < block_pixels; ++i) writer.write(alphaIndices[i], 2);
+			return bestError;
+		}
+
+		// the mode of the two with the lower error
+		void encodeBC7Block(const Planes& planes, unsigned char* const block)
+		{
+			unsigned char mode5[16];
+			const float mode5Error = encodeBC7Mode5(planes, mode5);
+			if (encodeBC7Mode6(planes, block) > mode5Error)
+			{
+				std::copy(mode5, mode5 + 16, block);
+			}
+		}
+
+		// reads the indices of a subset, the first one has a bit less
+		void readIndices(BitReader& reader, const int numOfBits, int* const indices)
+		{
+			indices[0] = reader.read(numOfBits - 1);
+			for (int i = 1; i < block_pixels; ++i) indices[i] = reader.read(numOfBits);
+		}
+
+		bool decodeBC7Block(const unsigned char* const block, unsigned char* const pixels)
+		{
+			int mode = 0;
+			while (mode < 8 && ((block[0] >> mode) & 1) == 0) ++mode;
+
+			BitReader reader(block);
+			reader.read(mode + 1);
+
+			int endpoints[2][4];
+			int colorIndices[block_pixels], alphaIndices[block_pixels];
+			const int* colorWeights;
+			const int* alphaWeights;
+			int rotation = 0;
+
+			switch (mode)
+			{
+			case 4:
+			case 5:
+			{
+				rotation = reader.read(2);
+				const bool swapIndices = mode == 4 && reader.read(1) == 1;
+				const int colorBits = mode == 4 ? 5 : 7;
+				const int alphaBits = mode == 4 ? 6 : 8;
+				for (int c = 0; c < 3; ++c)
+				{
+					endpoints[0][c] = expand(reader.read(colorBits), colorBits);
+					endpoints[1][c] = expand(reader.read(colorBits), colorBits);
+				}
+				endpoints[0][3] = expand(reader.read(alphaBits), alphaBits);
+				endpoints[1][3] = expand(reader.read(alphaBits), alphaBits);
+
+				// mode 4 reads the 2 bits indices first, used by the color unless swapped
+				const int secondaryBits = mode == 4 ? 3 : 2;
+				int* const primary = swapIndices ? alphaIndices : colorIndices;
+				int* const secondary = swapIndices ? colorIndices : alphaIndices;
+				readIndices(reader, 2, primary);
+				readIndices(reader, secondaryBits, secondary);
+
+				const int* const secondaryWeights = secondaryBits == 3 ? bc7_weights3 : bc7_weights2;
+				colorWeights = swapIndices ? secondaryWeights : bc7_weights2;
+				alphaWeights = swapIndices ? bc7_weights2 : secondaryWeights;
+				break;
+			}
+			case 6:
+			{
+				int quantized[2][4];
+				for (int c = 0; c < 4; ++c)
+				{
+					quantized[0][c] = reader.read(7);
+					quantized[1][c] = reader.read(7);
+				}
+				const int parity0 = reader.read(1), parity1 = reader.read(1);
+				for (int c = 0; c < 4; ++c)
+				{
+					endpoints[0][c] = (quantized[0][c] << 1) | parity0;
+					endpoints[1][c] = (quantized[1][c] << 1) | parity1;
+				}
+				readIndices(reader, 4, colorIndices);
+				std::copy(colorIndices, colorIndices + block_pixels, alphaIndices);
+				colorWeights = alphaWeights = bc7_weights4;
+				break;
+			}
+			default:
+				// the partitioned modes need the partition tables
+				return false;
+			}
+
+			for (int i = 0; i < block_pixels; ++i)
+			{
+				unsigned char* const pixel = pixels + i * 4;
+				for (int c = 0; c < 3; ++c)
+				{
+					pixel[c] = static_cast<unsigned char>(interpolate(endpoints[0][c], endpoints[1][c], colorWeights[colorIndices[i]]));
+				}
+				pixel[3] = static_cast<unsigned char>(interpolate(endpoints[0][3], endpoints[1][3], alphaWeights[alphaIndices[i]]));
+				if (rotation > 0) std::swap(pixel[3], pixel[rotation - 1]);
+			}
+			return true;
+		}
+
+		// ETC2
+
+		constexpr int etc_modifiers[8][2] = { { 2, 8 }, { 5, 17 }, { 9, 29 }, { 13, 42 }, { 18, 60 }, { 24, 80 }, { 33, 106 }, { 47, 183 } };
+		constexpr int etc_distances[8] = { 3, 6, 11, 16, 23, 32, 41, 64 };
+		constexpr int eac_modifiers[16][8] = {
+			{ -3, -6, -9, -15, 2, 5, 8, 14 }, { -3, -7, -10, -13, 2, 6, 9, 12 }, { -2, -5, -8, -13, 1, 4, 7, 12 }, { -2, -4, -6, -13, 1, 3, 5, 12 },
+			{ -3, -6, -8, -12, 2, 5, 7, 11 }, { -3, -7, -9, -11, 2, 6, 8, 10 }, { -4, -7, -8, -11, 3, 6, 7, 10 }, { -3, -5, -8, -11, 2, 4, 7, 10 },
+			{ -2, -6, -8, -10, 1, 5, 7, 9 }, { -2, -5, -8, -10, 1, 4, 7, 9 }, { -2, -4, -8, -10, 1, 3, 7, 9 }, { -2, -5, -7, -10, 1, 4, 6, 9 },
+			{ -3, -4, -7, -10, 2, 3, 6, 9 }, { -1, -2, -3, -10, 0, 1, 2, 9 }, { -4, -6, -8, -9, 3, 5, 7, 8 }, { -3, -5, -7, -9, 2, 4, 6, 8 }
+		};
+
+		// the pixels of ETC blocks are column major
+		int toColumnMajor(const int pixel)
+		{
+			return (pixel % 4) * 4 + pixel / 4;
+		}
+
+		// the subblock of a pixel, halves side by side or, flipped, one above the other
+		int getSubblock(const int pixel, const bool flip)
+		{
+			return flip ? (pixel / 4) / 2 : (pixel % 4) / 2;
+		}
+
+		// the four colors of a subblock: base + small, base + large, base - small, base - large
+		void makeSubblockPalette(const int* const base, const int table, float(*palette)[4])
+		{
+			const int modifiers[4] = { etc_modifiers[table][0], etc_modifiers[table][1], -etc_modifiers[table][0], -etc_modifiers[table][1] };
+			for (int i = 0; i < 4; ++i)
+			{
+				for (int c = 0; c < 3; ++c) palette[i][c] = static_cast<float>(clamp255(base[c] + modifiers[i]));
+				palette[i][3] = 0.0f;
+			}
+		}
+
+		// individual and differential modes, the ones decoded the same by ETC1
+		void encodeETC2Block(const Planes& planes, unsigned char* const block)
+		{
+			float bestError = FLT_MAX;
+			uint64_t best = 0;
+			for (int flip = 0; flip < 2; ++flip)
+			{
+				float averages[2][3]{};
+				for (int i = 0; i < block_pixels; ++i)
+				{
+					for (int c = 0; c < 3; ++c) averages[getSubblock(i, flip)][c] += planes.channels[c][i] / 8.0f;
+				}
+
+				// the differential mode has more precision if the bases are close
+				int quantized[2][3];
+				bool differential = true;
+				for (int c = 0; c < 3; ++c)
+				{
+					quantized[0][c] = quantize(averages[0][c], 31);
+					quantized[1][c] = quantize(averages[1][c], 31);
+					const int delta = quantized[1][c] - quantized[0][c];
+					differential = differential && delta >= -4 && delta <= 3;
+				}
+
+				int bases[2][3];
+				for (int s = 0; s < 2; ++s)
+				{
+					for (int c = 0; c < 3; ++c)
+					{
+						if (!differential) quantized[s][c] = quantize(averages[s][c], 15);
+						bases[s][c] = expand(quantized[s][c], differential ? 5 : 4);
+					}
+				}
+
+				float error = 0.0f;
+				int tables[2];
+				uint8_t indices[block_pixels];
+				for (int s = 0; s < 2; ++s)
+				{
+					float bestSubblockError = FLT_MAX;
+					for (int table = 0; table < 8; ++table)
+					{
+						float palette[4][4];
+						makeSubblockPalette(bases[s], table, palette);
+
+						uint8_t candidates[block_pixels];
+						float errors[block_pixels];
+						selectIndices(planes, 3, palette, 4, candidates, errors);
+
+						float subblockError = 0.0f;
+						for (int i = 0; i < block_pixels; ++i)
+						{
+							if (getSubblock(i, flip) == s) subblockError += errors[i];
+						}
+						if (subblockError < bestSubblockError)
+						{
+							bestSubblockError = subblockError;
+							tables[s] = table;
+							for (int i = 0; i < block_pixels; ++i)
+							{
+								if (getSubblock(i, flip) == s) indices[i] = candidates[i];
+							}
+						}
+					}
+					error += bestSubblockError;
+				}
+				if (error >= bestError) continue;
+
+				bestError = error;
+				uint64_t packed = 0;
+				for (int c = 0; c < 3; ++c)
+				{
+					const int shift = 56 - 8 * c;
+					if (differential)
+					{
+						packed |= static_cast<uint64_t>(quantized[0][c]) << (shift + 3);
+						packed |= static_cast<uint64_t>((quantized[1][c] - quantized[0][c]) & 7) << shift;
+					}
+					else
+					{
+						packed |= static_cast<uint64_t>(quantized[0][c]) << (shift + 4);
+						packed |= static_cast<uint64_t>(quantized[1][c]) << shift;
+					}
+				}
+				packed |= static_cast<uint64_t>(tables[0]) << 37;
+				packed |= static_cast<uint64_t>(tables[1]) << 34;
+				packed |= static_cast<uint64_t>(differential) << 33;
+				packed |= static_cast<uint64_t>(flip) << 32;
+				for (int i = 0; i < block_pixels; ++i)
+				{
+					const int j = toColumnMajor(i);
+					packed |= static_cast<uint64_t>(indices[i] >> 1) << (16 + j);
+					packed |= static_cast<uint64_t>(indices[i] & 1) << j;
+				}
+				best = packed;
+			}
+			writeBigEndian(best, block);
+		}
+
+		void decodeETC2Block(const unsigned char* const block, unsigned char* const pixels)
+		{
+			const uint64_t packed = readBigEndian(block);
+			const bool flip = bits(packed, 32, 32) != 0;
+
+			// 2 bits index of each pixel, column major
+			auto getIndex = [packed](const int pixel)
+			{
+				const int j = toColumnMajor(pixel);
+				return static_cast<int>((bits(packed, 16 + j, 16 + j) << 1) | bits(packed, j, j));
+			};
+			auto writePixel = [pixels](const int pixel, const int* const color)
+			{
+				for (int c = 0; c < 3; ++c) pixels[pixel * 4 + c] = static_cast<unsigned char>(clamp255(color[c]));
+				pixels[pixel * 4 + 3] = 255;
+			};
+
+			int bases[2][3];
+			if (bits(packed, 33, 33) == 0)
+			{
+				for (int c = 0; c < 3; ++c)
+				{
+					const int shift = 56 - 8 * c;
+					bases[0][c] = expand(bits(packed, shift + 7, shift + 4), 4);
+					bases[1][c] = expand(bits(packed, shift + 3, shift), 4);
+				}
+			}
+			else
+			{
+				int base[3], second[3];
+				for (int c = 0; c < 3; ++c)
+				{
+					const int shift = 56 - 8 * c;
+					base[c] = bits(packed, shift + 7, shift + 3);
+					const int delta = bits(packed, shift + 2, shift);
+					second[c] = base[c] + (delta >= 4 ? delta - 8 : delta);
+				}
+
+				// an overflowing channel selects the modes added by ETC2
+				if (second[0] < 0 || second[0] > 31)
+				{
+					// T mode
+					const int color0[3] = {
+						expand((bits(packed, 60, 59) << 2) | bits(packed, 57, 56), 4),
+						expand(bits(packed, 55, 52), 4),
+						expand(bits(packed, 51, 48), 4)
+					};
+					const int color1[3] = { expand(bits(packed, 47, 44), 4), expand(bits(packed, 43, 40), 4), expand(bits(packed, 39, 36), 4) };
+					const int distance = etc_distances[(bits(packed, 35, 34) << 1) | bits(packed, 32, 32)];
+					const int paints[4][3] = {
+						{ color0[0], color0[1], color0[2] },
+						{ color1[0] + distance, color1[1] + distance, color1[2] + distance },
+						{ color1[0], color1[1], color1[2] },
+						{ color1[0] - distance, color1[1] - distance, color1[2] - distance }
+					};
+					for (int i = 0; i < block_pixels; ++i) writePixel(i, paints[getIndex(i)]);
+					return;
+				}
+				if (second[1] < 0 || second[1] > 31)
+				{
+					// H mode
+					const int red0 = bits(packed, 62, 59);
+					const int green0 = (bits(packed, 58, 56) << 1) | bits(packed, 52, 52);
+					const int blue0 = (bits(packed, 51, 51) << 3) | bits(packed, 49, 47);
+					const int red1 = bits(packed, 46, 43), green1 = bits(packed, 42, 39), blue1 = bits(packed, 38, 35);
+					const int ordering = ((red0 << 8) | (green0 << 4) | blue0) >= ((red1 << 8) | (green1 << 4) | blue1) ? 1 : 0;
+					const int distance = etc_distances[(bits(packed, 34, 34) << 2) | (bits(packed, 32, 32) << 1) | ordering];
+					const int color0[3] = { expand(red0, 4), expand(green0, 4), expand(blue0, 4) };
+					const int color1[3] = { expand(red1, 4), expand(green1, 4), expand(blue1, 4) };
+					const int paints[4][3] = {
+						{ color0[0] + distance, color0[1] + distance, color0[2] + distance },
+						{ color0[0] - distance, color0[1] - distance, color0[2] - distance },
+						{ color1[0] + distance, color1[1] + distance, color1[2] + distance },
+						{ color1[0] - distance, color1[1] - distance, color1[2] - distance }
+					};
+					for (int i = 0; i < block_pixels; ++i) writePixel(i, paints[getIndex(i)]);
+					return;
+				}
+				if (second[2] < 0 || second[2] > 31)
+				{
+					// planar mode, the colors at the origin, the right and the bottom
+					const int origin[3] = {
+						expand(bits(packed, 62, 57), 6),
+						expand((bits(packed, 56, 56) << 6) | bits(packed, 54, 49), 7),
+						expand((bits(packed, 48, 48) << 5) | (bits(packed, 44, 43) << 3) | bits(packed, 41, 39), 6)
+					};
+					const int horizontal[3] = {
+						expand((bits(packed, 38, 34) << 1) | bits(packed, 32, 32), 6),
+						expand(bits(packed, 31, 25), 7),
+						expand(bits(packed, 24, 19), 6)
+					};
+					const int vertical[3] = { expand(bits(packed, 18, 13), 6), expand(bits(packed, 12, 6), 7), expand(bits(packed, 5, 0), 6) };
+					for (int i = 0; i < block_pixels; ++i)
+					{
+						const int x = i % 4, y = i / 4;
+						int color[3];
+						for (int c = 0; c < 3; ++c)
+						{
+							color[c] = (x * (horizontal[c] - origin[c]) + y * (vertical[c] - origin[c]) + 4 * origin[c] + 2) >> 2;
+						}
+						writePixel(i, color);
+					}
+					return;
+				}
+
+				for (int c = 0; c < 3; ++c)
+				{
+					bases[0][c] = expand(base[c], 5);
+					bases[1][c] = expand(second[c], 5);
+				}
+			}
+
+			const int tables[2] = { static_cast<int>(bits(packed, 39, 37)), static_cast<int>(bits(packed, 36, 34)) };
+			for (int i = 0; i < block_pixels; ++i)
+			{
+				const int subblock = getSubblock(i, flip);
+				const int index = getIndex(i);
+				const int modifier = etc_modifiers[tables[subblock]][index & 1] * ((index & 2) ? -1 : 1);
+				const int color[3] = { bases[subblock][0] + modifier, bases[subblock][1] + modifier, bases[subblock][2] + modifier };
+				writePixel(i, color);
+			}
+		}
+
+		void encodeEACBlock(const Planes& planes, unsigned char* const block)
+		{
+			const float* const alpha = planes.channels[3];
+			const int minimum = static_cast<int>(*std::min_element(alpha, alpha + block_pixels));
+			const int maximum = static_cast<int>(*std::max_element(alpha, alpha + block_pixels));
+
+			Planes alphaPlanes;
+			std::copy(alpha, alpha + block_pixels, alphaPlanes.channels[0]);
+
+			float bestError = FLT_MAX;
+			uint64_t best = 0;
+			for (int table = 0; table < 16 && bestError > 0.0f; ++table)
+			{
+				const int* const modifiers = eac_modifiers[table];
+				const int range = modifiers[7] - modifiers[3];
+				const int multiplier = std::min(std::max((maximum - minimum + range / 2) / range, 1), 15);
+				for (int m = std::max(multiplier - 1, 1); m <= std::min(multiplier + 1, 15); ++m)
+				{
+					// centered on the range of the alphas
+					const int base = clamp255(static_cast<int>(std::lround((minimum + maximum) / 2.0f - (modifiers[7] + modifiers[3]) * m / 2.0f)));
+
+					float palette[8][4]{};
+					for (int i = 0; i < 8; ++i) palette[i][0] = static_cast<float>(clamp255(base + modifiers[i] * m));
+
+					uint8_t indices[block_pixels];
+					const float error = selectIndices(alphaPlanes, 1, palette, 8, indices);
+					if (error >= bestError) continue;
+
+					bestError = error;
+					uint64_t packed = (static_cast<uint64_t>(base) << 56) | (static_cast<uint64_t>(m) << 52) | (static_cast<uint64_t>(table) << 48);
+					for (int i = 0; i < block_pixels; ++i)
+					{
+						packed |= static_cast<uint64_t>(indices[i]) << (45 - 3 * toColumnMajor(i));
+					}
+					best = packed;
+				}
+			}
+			writeBigEndian(best, block);
+		}
+
+		void decodeEACBlock(const unsigned char* const block, unsigned char* const pixels)
+		{
+			const uint64_t packed = readBigEndian(block);
+			const int base = bits(packed, 63, 56);
+			const int multiplier = bits(packed, 55, 52);
+			const int* const modifiers = eac_modifiers[bits(packed, 51, 48)];
+			for (int i = 0; i < block_pixels; ++i)
+			{
+				const int shift = 45 - 3 * toColumnMajor(i);
+				pixels[i * 4 + 3] = static_cast<unsigned char>(clamp255(base + modifiers[bits(packed, shift + 2, shift)] * multiplier));
+			}
+		}
+
+		// RGBA8 pixels of an image of any channels
+		std::shared_ptr<unsigned char> toRGBA(const Image& image)
+		{
+			const size_t numOfPixels = static_cast<size_t>(image.width) * static_cast<size_t>(image.height);
+			std::shared_ptr<unsigned char> result(new unsigned char[numOfPixels * 4], std::default_delete<unsigned char[]>());
+			for (size_t i = 0; i < numOfPixels; ++i)
+			{
+				const unsigned char* const source = image.data.get() + i * image.channels;
+				unsigned char* const destination = result.get() + i * 4;
+				switch (image.channels)
+				{
+				case 1: destination[0] = destination[1] = destination[2] = source[0]; destination[3] = 255; break;
+				case 2: destination[0] = destination[1] = destination[2] = source[0]; destination[3] = source[1]; break;
+				case 3: std::copy(source, source + 3, destination); destination[3] = 255; break;
+				default: std::copy(source, source + 4, destination); break;
+				}
+			}
+			return result;
+		}
+
+		void encodeLevel(const unsigned char* const pixels, const int width, const int height, const Format format, unsigned char* const data)
+		{
+			const size_t blockSize = CompressedImage::getBlockSize(format);
+			unsigned char block[block_pixels * 4];
+			for (int blockY = 0; blockY < height; blockY += 4)
+			{
+				for (int blockX = 0; blockX < width; blockX += 4)
+				{
+					// the borders are repeated over the pixels out of the image
+					for (int i = 0; i < block_pixels; ++i)
+					{
+						const int x = std::min(blockX + i % 4, width - 1);
+						const int y = std::min(blockY + i / 4, height - 1);
+						std::copy_n(pixels + (static_cast<size_t>(y) * width + x) * 4, 4, block + i * 4);
+					}
+					TextureCodec::encodeBlock(format, block, data + ((blockY / 4) * ((width + 3) / 4) + blockX / 4) * blockSize);
+				}
+			}
+		}
+	}
+
+	CompressedImage TextureCodec::encode(const Image& image, const Format format, const bool mipmaps)
+	{
+		if (image.data == nullptr || image.width <= 0 || image.height <= 0) return CompressedImage();
+
+		std::vector<CompressedImage::Level> levels;
+		size_t size = 0;
+		int width = image.width, height = image.height;
+		while (true)
+		{
+			const size_t levelSize = CompressedImage::getLevelSize(format, width, height);
+			levels.push_back({ width, height, size, levelSize });
+			size += levelSize;
+
+			if (!mipmaps || (width == 1 && height == 1)) break;
+			width = std::max(width / 2, 1);
+			height = std::max(height / 2, 1);
+		}
+
+		std::shared_ptr<unsigned char> data(new unsigned char[size], std::default_delete<unsigned char[]>());
+		Image pixels(toRGBA(image), image.width, image.height, 4);
+		for (size_t i = 0; i < levels.size(); ++i)
+		{
+			const CompressedImage::Level& level = levels[i];
+			encodeLevel(pixels.data.get(), level.width, level.height, format, data.get() + level.offset);
+			if (i + 1 < levels.size())
+			{
+				pixels = pixels.createMipmap();
+			}
+		}
+		return CompressedImage(format, image.width, image.height, levels, data);
+	}
+
+	std::shared_ptr<unsigned char> TextureCodec::decode(const CompressedImage& image, const size_t level)
+	{
+		if (!image.isValid() || level >= image.levels.size()) return nullptr;
+
+		const CompressedImage::Level& info = image.levels[level];
+		const size_t blockSize = CompressedImage::getBlockSize(image.format);
+		const unsigned char* const data = image.getLevelData(level);
+
+		std::shared_ptr<unsigned char> result(new unsigned char[static_cast<size_t>(info.width) * info.height * 4], std::default_delete<unsigned char[]>());
+		unsigned char pixels[block_pixels * 4];
+		for (int blockY = 0; blockY < info.height; blockY += 4)
+		{
+			for (int blockX = 0; blockX < info.width; blockX += 4)
+			{
+				const unsigned char* const block = data + ((blockY / 4) * ((info.width + 3) / 4) + blockX / 4) * blockSize;
+				if (!decodeBlock(image.format, block, pixels))
+				{
+					for (int i = 0; i < block_pixels; ++i)
+					{
+						pixels[i * 4] = pixels[i * 4 + 2] = pixels[i * 4 + 3] = 255;
+						pixels[i * 4 + 1] = 0;
+					}
+				}
+
+				for (int y = blockY; y < std::min(blockY + 4, info.height); ++y)
+				{
+					const int numOfPixels = std::min(blockX + 4, info.width) - blockX;
+					std::copy_n(pixels + (y - blockY) * 16, numOfPixels * 4, result.get() + (static_cast<size_t>(y) * info.width + blockX) * 4);
+				}
+			}
+		}
+		return result;
+	}
+
+	void TextureCodec::encodeBlock(const Format format, const unsigned char* const pixels, unsigned char* const block)
+	{
+		const Planes planes = toPlanes(pixels);
+		switch (format)
+		{
+		case Format::BC1:
+			encodeColorBlock(planes, block);
+			break;
+		case Format::BC3:
+			encodeAlphaBlock(planes, block);
+			encodeColorBlock(planes, block + 8);
+			break;
+		case Format::BC7:
+			encodeBC7Block(planes, block);
+			break;
+		case Format::ETC2_RGB:
+			encodeETC2Block(planes, block);
+			break;
+		case Format::ETC2_RGBA:
+			encodeEACBlock(planes, block);
+			encodeETC2Block(planes, block + 8);
+			break;
+		}
+	}
+
+	bool TextureCodec::decodeBlock(const Format format, const unsigned char* const block, unsigned char* const pixels)
+	{
+		switch (format)
+		{
+		case Format::BC1:
+			decodeColorBlock(block, false, pixels);
+			return true;
+		case Format::BC3:
+			decodeColorBlock(block + 8, true, pixels);
+			decodeAlphaBlock(block, pixels);
+			return true;
+		case Format::BC7:
+			return decodeBC7Block(block, pixels);
+		case Format::ETC2_RGB:
+			decodeETC2Block(block, pixels);
+			return true;
+		case Format::ETC2_RGBA:
+			decodeETC2Block(block + 8, pixels);
+			decodeEACBlock(block, pixels);
+			return true;
+		}
+		return false;
+	}
+}
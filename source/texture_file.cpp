@@ -0,0 +1,287 @@
+#include <vdtgraphics/texture_file.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace graphics
+{
+	namespace
+	{
+		constexpr uint32_t file_magic = 0x58544456; // VDTX
+		constexpr uint32_t file_version = 1;
+		// the levels start aligned, for the copies of the driver
+		constexpr uint64_t level_alignment = 64;
+		constexpr uint32_t max_levels = 32;
+
+		constexpr uint32_t premultiplied_flag = 1 << 0;
+		constexpr uint32_t opaque_flag = 1 << 1;
+
+		struct FileHeader
+		{
+			uint32_t magic;
+			uint32_t version;
+			uint32_t width;
+			uint32_t height;
+			uint32_t channels;
+			uint32_t flags;
+			uint32_t numOfLevels;
+			uint32_t reserved;
+		};
+
+		// follows the header, one per level from the largest
+		struct FileLevel
+		{
+			uint32_t width;
+			uint32_t height;
+			uint64_t offset;
+			uint64_t size;
+		};
+
+		// copy on write, the pixels of the file are never changed
+		std::shared_ptr<unsigned char> map(const std::filesystem::path& filename, size_t& size)
+		{
+#ifdef _WIN32
+			const HANDLE file = CreateFileW(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+			if (file == INVALID_HANDLE_VALUE) return nullptr;
+
+			LARGE_INTEGER fileSize;
+			if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+			{
+				CloseHandle(file);
+				return nullptr;
+			}
+
+			// the view keeps the mapping and the file open
+			const HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+			CloseHandle(file);
+			if (mapping == nullptr) return nullptr;
+
+			void* const view = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+			CloseHandle(mapping);
+			if (view == nullptr) return nullptr;
+
+			size = static_cast<size_t>(fileSize.QuadPart);
+			return std::shared_ptr<unsigned char>(static_cast<unsigned char*>(view), [](unsigned char* const data)
+				{
+					UnmapViewOfFile(data);
+				}
+			);
+#else
+			const int file = ::open(filename.c_str(), O_RDONLY);
+			if (file < 0) return nullptr;
+
+			struct stat status;
+			if (fstat(file, &status) != 0 || status.st_size <= 0)
+			{
+				close(file);
+				return nullptr;
+			}
+
+			const size_t fileSize = static_cast<size_t>(status.st_size);
+			void* const view = mmap(nullptr, fileSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0);
+			close(file);
+			if (view == MAP_FAILED) return nullptr;
+
+			// read once from the start by the upload
+			madvise(view, fileSize, MADV_SEQUENTIAL);
+
+			size = fileSize;
+			return std::shared_ptr<unsigned char>(static_cast<unsigned char*>(view), [fileSize](unsigned char* const data)
+				{
+					munmap(data, fileSize);
+				}
+			);
+#endif
+		}
+
+		// the formats a Texture is created with, two channels would be read as RGBA
+		bool isSupported(const uint32_t channels)
+		{
+			return channels == 1 || channels == 3 || channels == 4;
+		}
+
+		void premultiply(Image& image)
+		{
+			const size_t numOfPixels = static_cast<size_t>(image.width) * static_cast<size_t>(image.height);
+			unsigned char* const pixels = image.data.get();
+			for (size_t i = 0; i < numOfPixels; ++i)
+			{
+				const unsigned int alpha = pixels[i * 4 + 3];
+				for (size_t c = 0; c < 3; ++c)
+				{
+					pixels[i * 4 + c] = static_cast<unsigned char>((pixels[i * 4 + c] * alpha + 127) / 255);
+				}
+			}
+		}
+	}
+
+	TextureFile::TextureFile()
+		: m_data()
+		, m_size(0)
+	{
+	}
+
+	TextureFile TextureFile::open(const std::filesystem::path& filename)
+	{
+		TextureFile result;
+		size_t size = 0;
+		std::shared_ptr<unsigned char> data = map(filename, size);
+		if (data == nullptr || size < sizeof(FileHeader)) return result;
+
+		const FileHeader& header = *reinterpret_cast<const FileHeader*>(data.get());
+		if (header.magic != file_magic
+			|| header.version != file_version
+			|| !isSupported(header.channels)
+			|| header.numOfLevels < 1 || header.numOfLevels > max_levels
+			|| size < sizeof(FileHeader) + header.numOfLevels * sizeof(FileLevel))
+		{
+			return result;
+		}
+
+		// a truncated file must not be read past its end, and the levels
+		// must be the chain of the size the texture is allocated with
+		const FileLevel* const levels = reinterpret_cast<const FileLevel*>(data.get() + sizeof(FileHeader));
+		uint32_t width = header.width, height = header.height;
+		for (uint32_t i = 0; i < header.numOfLevels; ++i)
+		{
+			const FileLevel& level = levels[i];
+			if (level.width != width || level.height != height || width == 0 || height == 0
+				|| level.size != static_cast<uint64_t>(level.width) * level.height * header.channels
+				|| level.offset > size || level.size > size - level.offset)
+			{
+				return result;
+			}
+			width = std::max(width >> 1, 1u);
+			height = std::max(height >> 1, 1u);
+		}
+
+		result.m_data = data;
+		result.m_size = size;
+		return result;
+	}
+
+	bool TextureFile::save(const std::filesystem::path& filename, const Image& image, const bool premultiply, const bool mipmaps)
+	{
+		if (image.data == nullptr || image.width <= 0 || image.height <= 0 || !isSupported(static_cast<uint32_t>(image.channels))) return false;
+
+		// the source is left untouched
+		const size_t size = static_cast<size_t>(image.width) * image.height * image.channels;
+		std::shared_ptr<unsigned char> pixels(new unsigned char[size], std::default_delete<unsigned char[]>());
+		std::copy_n(image.data.get(), size, pixels.get());
+
+		std::vector<Image> chain{ Image(pixels, image.width, image.height, image.channels) };
+		const bool premultiplied = premultiply && image.channels == 4;
+		if (premultiplied)
+		{
+			graphics::premultiply(chain.front());
+		}
+		while (mipmaps && (chain.back().width > 1 || chain.back().height > 1))
+		{
+			chain.push_back(chain.back().createMipmap());
+		}
+
+		FileHeader header{};
+		header.magic = file_magic;
+		header.version = file_version;
+		header.width = static_cast<uint32_t>(image.width);
+		header.height = static_cast<uint32_t>(image.height);
+		header.channels = static_cast<uint32_t>(image.channels);
+		header.flags = (premultiplied ? premultiplied_flag : 0) | (chain.front().isOpaque() ? opaque_flag : 0);
+		header.numOfLevels = static_cast<uint32_t>(chain.size());
+
+		std::vector<FileLevel> levels;
+		uint64_t offset = sizeof(FileHeader) + chain.size() * sizeof(FileLevel);
+		for (const Image& level : chain)
+		{
+			offset = (offset + level_alignment - 1) & ~(level_alignment - 1);
+			const uint64_t levelSize = static_cast<uint64_t>(level.width) * level.height * level.channels;
+			levels.push_back({ static_cast<uint32_t>(level.width), static_cast<uint32_t>(level.height), offset, levelSize });
+			offset += levelSize;
+		}
+
+		// written aside and renamed, a partial file is never mapped
+		const std::filesystem::path temporaryFilename = filename.string() + ".tmp";
+		std::ofstream output(temporaryFilename, std::ios::binary | std::ios::trunc);
+		if (!output.is_open()) return false;
+
+		output.write(reinterpret_cast<const char*>(&header), sizeof(FileHeader));
+		output.write(reinterpret_cast<const char*>(levels.data()), levels.size() * sizeof(FileLevel));
+		for (size_t i = 0; i < chain.size(); ++i)
+		{
+			const std::vector<char> padding(static_cast<size_t>(levels[i].offset - output.tellp()), 0);
+			output.write(padding.data(), padding.size());
+			output.write(reinterpret_cast<const char*>(chain[i].data.get()), levels[i].size);
+		}
+		output.close();
+
+		std::error_code error;
+		if (output)
+		{
+			std::filesystem::rename(temporaryFilename, filename, error);
+			if (!error) return true;
+		}
+		std::filesystem::remove(temporaryFilename, error);
+		return false;
+	}
+
+	int TextureFile::getWidth() const
+	{
+		return isValid() ? static_cast<int>(reinterpret_cast<const FileHeader*>(m_data.get())->width) : 0;
+	}
+
+	int TextureFile::getHeight() const
+	{
+		return isValid() ? static_cast<int>(reinterpret_cast<const FileHeader*>(m_data.get())->height) : 0;
+	}
+
+	int TextureFile::getChannels() const
+	{
+		return isValid() ? static_cast<int>(reinterpret_cast<const FileHeader*>(m_data.get())->channels) : 0;
+	}
+
+	size_t TextureFile::getNumOfLevels() const
+	{
+		return isValid() ? reinterpret_cast<const FileHeader*>(m_data.get())->numOfLevels : 0;
+	}
+
+	bool TextureFile::isPremultiplied() const
+	{
+		return isValid() && (reinterpret_cast<const FileHeader*>(m_data.get())->flags & premultiplied_flag) != 0;
+	}
+
+	bool TextureFile::isOpaque() const
+	{
+		return isValid() && (reinterpret_cast<const FileHeader*>(m_data.get())->flags & opaque_flag) != 0;
+	}
+
+	Image TextureFile::getLevel(const size_t level) const
+	{
+		if (level >= getNumOfLevels()) return Image();
+
+		const FileLevel& info = reinterpret_cast<const FileLevel*>(m_data.get() + sizeof(FileHeader))[level];
+		// shares the ownership of the mapping
+		return Image(std::shared_ptr<unsigned char>(m_data, m_data.get() + info.offset),
+			static_cast<int>(info.width), static_cast<int>(info.height), getChannels());
+	}
+
+	const unsigned char* TextureFile::getLevelData(const size_t level) const
+	{
+		if (level >= getNumOfLevels()) return nullptr;
+
+		const FileLevel& info = reinterpret_cast<const FileLevel*>(m_data.get() + sizeof(FileHeader))[level];
+		return m_data.get() + info.offset;
+	}
+}
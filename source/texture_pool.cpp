@@ -0,0 +1,160 @@
+#include <vdtgraphics/texture_pool.h>
+
+#include <algorithm>
+#include <memory>
+
+#include <glad/glad.h>
+
+namespace graphics
+{
+	TexturePool::TexturePool(const size_t budget)
+		: m_budget(budget)
+		, m_free()
+		, m_released()
+		, m_frames()
+		, m_freeBytes(0)
+		, m_stats()
+	{
+	}
+
+	TexturePool::~TexturePool()
+	{
+		for (const Frame& frame : m_frames)
+		{
+			glDeleteSync(static_cast<GLsync>(frame.fence));
+		}
+	}
+
+	TexturePtr TexturePool::acquire(const unsigned int width, const unsigned int height, const unsigned int channels, const Texture::Options& options)
+	{
+		const unsigned int format = Texture::toFormat(channels);
+		const unsigned int levels = options.levels == 0 ? 1 : std::min(options.levels, Texture::getMaxNumOfLevels(width, height));
+
+		// the most recently released first, the least likely to be evicted
+		for (size_t i = m_free.size(); i-- > 0; )
+		{
+			const TexturePtr& texture = m_free[i];
+			if (texture->getWidth() != width || texture->getHeight() != height
+				|| texture->getFormat() != format || texture->getNumOfLevels() != levels)
+			{
+				continue;
+			}
+
+			TexturePtr result = texture;
+			m_free.erase(m_free.begin() + i);
+			const size_t size = getSize(*result);
+			m_freeBytes -= size;
+			m_stats.residentBytes -= size;
+			++m_stats.hits;
+
+			// as a new texture without data
+			result->setOptions(options);
+			result->setPremultiplied(false);
+			if (options.opacity == Texture::Opacity::Auto)
+			{
+				result->setOpaque(false);
+			}
+			return result;
+		}
+
+		Texture::Options storageOptions = options;
+		storageOptions.immutable = true;
+		storageOptions.levels = levels;
+		++m_stats.misses;
+		return std::make_shared<Texture>(nullptr, width, height, channels, storageOptions);
+	}
+
+	void TexturePool::release(const TexturePtr& texture)
+	{
+		if (texture == nullptr || !texture->isValid() || texture->getArray() != nullptr || texture->isCompressed()) return;
+		// released twice, two acquires would share it
+		if (contains(texture)) return;
+
+		m_released.push_back(texture);
+		m_stats.residentBytes += getSize(*texture);
+	}
+
+	void TexturePool::update()
+	{
+		if (!m_released.empty())
+		{
+			m_frames.push_back({ glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), std::move(m_released) });
+			m_released.clear();
+		}
+
+		// frames complete in order
+		while (!m_frames.empty())
+		{
+			Frame& frame = m_frames.front();
+			const GLsync sync = static_cast<GLsync>(frame.fence);
+			const GLenum result = glClientWaitSync(sync, 0, 0);
+			if (result == GL_TIMEOUT_EXPIRED) break;
+			// the GPU may still read the textures, waited for in full
+			if (result == GL_WAIT_FAILED)
+			{
+				glFinish();
+			}
+
+			glDeleteSync(sync);
+			for (TexturePtr& texture : frame.textures)
+			{
+				const size_t size = getSize(*texture);
+				// still referenced elsewhere, it is left to its owners
+				if (texture.use_count() > 1)
+				{
+					m_stats.residentBytes -= size;
+					continue;
+				}
+				m_freeBytes += size;
+				m_free.push_back(std::move(texture));
+			}
+			m_frames.pop_front();
+		}
+
+		evict(m_budget);
+	}
+
+	void TexturePool::trim()
+	{
+		evict(0);
+	}
+
+	size_t TexturePool::getSize(const Texture& texture)
+	{
+		const size_t pixelSize = Texture::getPixelSize(texture.getFormat());
+		size_t size = 0;
+		for (unsigned int i = 0; i < texture.getNumOfLevels(); ++i)
+		{
+			size += static_cast<size_t>(std::max(texture.getWidth() >> i, 1u)) * std::max(texture.getHeight() >> i, 1u) * pixelSize;
+		}
+		return size;
+	}
+
+	bool TexturePool::contains(const TexturePtr& texture) const
+	{
+		const auto& holds = [&texture](const std::vector<TexturePtr>& textures)
+		{
+			return std::find(textures.begin(), textures.end(), texture) != textures.end();
+		};
+
+		if (holds(m_free) || holds(m_released)) return true;
+		for (const Frame& frame : m_frames)
+		{
+			if (holds(frame.textures)) return true;
+		}
+		return false;
+	}
+
+	void TexturePool::evict(const size_t budget)
+	{
+		size_t count = 0;
+		while (count < m_free.size() && m_freeBytes > budget)
+		{
+			const size_t size = getSize(*m_free[count]);
+			m_freeBytes -= size;
+			m_stats.residentBytes -= size;
+			++count;
+		}
+		m_free.erase(m_free.begin(), m_free.begin() + count);
+	}
+}
@@ -0,0 +1,156 @@
+#include <vdtgraphics/texture_uploader.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include <glad/glad.h>
+
+#include <vdtgraphics/gl_state_cache.h>
+#include <vdtgraphics/texture.h>
+
+namespace graphics
+{
+	namespace
+	{
+		// alignment of the regions staged in a buffer
+		constexpr size_t staging_alignment = 16;
+	}
+
+	TextureUploader::TextureUploader(const size_t budget)
+		: m_budget(budget)
+		, m_slots()
+		, m_nextSlot(0)
+		, m_copies()
+		, m_requests()
+		, m_lastTicket(invalid_ticket)
+		, m_stagedTicket(invalid_ticket)
+		, m_completedTicket(invalid_ticket)
+		, m_stats()
+	{
+		for (Slot& slot : m_slots)
+		{
+			glGenBuffers(1, &slot.id);
+			GLStateCache::get().bindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.id);
+			glBufferData(GL_PIXEL_UNPACK_BUFFER, m_budget, nullptr, GL_STREAM_DRAW);
+			slot.size = m_budget;
+			slot.fence = nullptr;
+			slot.ticket = invalid_ticket;
+		}
+		// client pointers given to the other uploads are not offsets
+		GLStateCache::get().bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	}
+
+	TextureUploader::~TextureUploader()
+	{
+		for (Slot& slot : m_slots)
+		{
+			if (slot.fence != nullptr)
+			{
+				glDeleteSync(static_cast<GLsync>(slot.fence));
+			}
+			GLStateCache::get().onBufferDeleted(slot.id);
+			glDeleteBuffers(1, &slot.id);
+		}
+	}
+
+	TextureUploader::Ticket TextureUploader::upload(Texture& texture, const std::shared_ptr<unsigned char>& data, const int offsetX, const int offsetY, const int width, const int height)
+	{
+		if (data == nullptr || width <= 0 || height <= 0 || texture.isCompressed()) return invalid_ticket;
+
+		m_requests.push_back({ ++m_lastTicket, &texture, data, offsetX, offsetY, width, height, 0 });
+		return m_lastTicket;
+	}
+
+	TextureUploader::Ticket TextureUploader::upload(Texture& texture, const Image& image)
+	{
+		return upload(texture, image.data, 0, 0, image.width, image.height);
+	}
+
+	void TextureUploader::update()
+	{
+		m_stats.stagedBytes = 0;
+		for (Slot& slot : m_slots)
+		{
+			poll(slot);
+		}
+
+		if (m_requests.empty()) return;
+
+		Slot& slot = m_slots[m_nextSlot];
+		if (slot.fence != nullptr)
+		{
+			// the GPU is still reading the buffer, try again the next frame
+			++m_stats.stalls;
+			return;
+		}
+
+		GLStateCache::get().bindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.id);
+
+		// a row is never split, the buffer grows to fit the largest one
+		const Request& first = m_requests.front();
+		const size_t firstRowSize = static_cast<size_t>(first.width) * Texture::getPixelSize(first.texture->getFormat());
+		const size_t capacity = std::max(m_budget, firstRowSize);
+		if (slot.size < capacity)
+		{
+			glBufferData(GL_PIXEL_UNPACK_BUFFER, capacity, nullptr, GL_STREAM_DRAW);
+			slot.size = capacity;
+		}
+
+		// the buffer was fenced, nothing reads it anymore
+		unsigned char* const mapping = static_cast<unsigned char*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, capacity,
+			GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT));
+		if (mapping == nullptr)
+		{
+			GLStateCache::get().bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+			return;
+		}
+
+		m_copies.clear();
+		size_t size = 0;
+		while (!m_requests.empty() && size < capacity)
+		{
+			Request& request = m_requests.front();
+			const size_t rowSize = static_cast<size_t>(request.width) * Texture::getPixelSize(request.texture->getFormat());
+			const int numOfRows = std::min(request.height - request.row, static_cast<int>((capacity - size) / rowSize));
+			if (numOfRows <= 0) break;
+
+			std::memcpy(mapping + size, request.data.get() + request.row * rowSize, numOfRows * rowSize);
+			m_copies.push_back({ request.texture, request.offsetX, request.offsetY + request.row, request.width, numOfRows, size });
+			size = (size + numOfRows * rowSize + staging_alignment - 1) & ~(staging_alignment - 1);
+			request.row += numOfRows;
+
+			if (request.row < request.height) break;
+
+			m_stagedTicket = request.ticket;
+			m_requests.pop_front();
+		}
+		glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+		// the data of the copies is an offset in the bound buffer
+		for (const Copy& copy : m_copies)
+		{
+			copy.texture->fillSubData(copy.offsetX, copy.offsetY, copy.width, copy.height,
+				reinterpret_cast<unsigned char*>(static_cast<uintptr_t>(copy.offset)));
+		}
+		GLStateCache::get().bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+		slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		slot.ticket = m_stagedTicket;
+		m_nextSlot = (m_nextSlot + 1) % m_slots.size();
+		m_stats.stagedBytes = size;
+	}
+
+	bool TextureUploader::poll(Slot& slot)
+	{
+		if (slot.fence == nullptr) return true;
+
+		const GLsync sync = static_cast<GLsync>(slot.fence);
+		const GLenum result = glClientWaitSync(sync, 0, 0);
+		if (result == GL_TIMEOUT_EXPIRED) return false;
+
+		glDeleteSync(sync);
+		slot.fence = nullptr;
+		m_completedTicket = std::max(m_completedTicket, slot.ticket);
+		return true;
+	}
+}
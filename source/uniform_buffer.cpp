@@ -0,0 +1,79 @@
+#include <vdtgraphics/uniform_buffer.h>
+
+#include <glad/glad.h>
+
+#include <vdtgraphics/gl_state_cache.h>
+
+namespace graphics
+{
+	UniformBuffer::UniformBuffer(const size_t size, const BufferUsageMode mode)
+		: Buffer(size, mode)
+		, m_id()
+		, m_usage()
+	{
+		switch (mode)
+		{
+		case BufferUsageMode::Static: m_usage = GL_STATIC_DRAW; break;
+		case BufferUsageMode::Ring:
+		case BufferUsageMode::Stream: m_usage = GL_STREAM_DRAW; break;
+		case BufferUsageMode::Dynamic:
+		default:
+			m_usage = GL_DYNAMIC_DRAW; break;
+		}
+
+		glGenBuffers(1, &m_id);
+		bind();
+		glBufferData(GL_UNIFORM_BUFFER, size, nullptr, m_usage);
+	}
+
+	UniformBuffer::~UniformBuffer()
+	{
+		free();
+	}
+
+	void UniformBuffer::bind()
+	{
+		GLStateCache::get().bindBuffer(GL_UNIFORM_BUFFER, m_id);
+	}
+
+	void UniformBuffer::unbind()
+	{
+		GLStateCache::get().bindBuffer(GL_UNIFORM_BUFFER, 0);
+	}
+
+	void UniformBuffer::free()
+	{
+		if (m_id == 0) return;
+
+		GLStateCache::get().onBufferDeleted(m_id);
+		glDeleteBuffers(1, &m_id);
+		m_id = 0;
+	}
+
+	void UniformBuffer::fillData(void* const data, const size_t size)
+	{
+		glBufferSubData(GL_UNIFORM_BUFFER, 0, size, data);
+	}
+
+	void UniformBuffer::fillSubData(void* const data, const size_t size, const int offset)
+	{
+		glBufferSubData(GL_UNIFORM_BUFFER, offset, size, data);
+	}
+
+	void UniformBuffer::orphan()
+	{
+		glBufferData(GL_UNIFORM_BUFFER, size(), nullptr, m_usage);
+	}
+
+	void UniformBuffer::bindRange(const unsigned int bindingPoint, const size_t offset, const size_t size)
+	{
+		GLStateCache::get().bindUniformBufferRange(bindingPoint, m_id, offset, size);
+	}
+
+	size_t UniformBuffer::getOffsetAlignment()
+	{
+		GLint alignment = 0;
+		glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+		return alignment > 0 ? static_cast<size_t>(alignment) : 256;
+	}
+}
@@ -1,18 +1,44 @@
 #include <vdtgraphics/vertex_buffer.h>
 
+#include <algorithm>
+#include <cstring>
+
 #include <glad/glad.h>
 
+#include <vdtgraphics/gl_state_cache.h>
+
 namespace graphics
 {
+	namespace
+	{
+		// alignment of the ranges written in ring mode
+		constexpr size_t ring_alignment = 16;
+
+		size_t align(const size_t offset)
+		{
+			return (offset + ring_alignment - 1) & ~(ring_alignment - 1);
+		}
+	}
+
 	VertexBuffer::VertexBuffer(const size_t size, const BufferUsageMode mode)
 		: Buffer(size, mode)
 		, layout()
 		, m_id()
+		, m_mapping(nullptr)
+		, m_head(0)
+		, m_used(0)
+		, m_pending(0)
+		, m_reserved()
+		, m_reservedPadding(0)
+		, m_fences()
+		, m_firstFence(0)
+		, m_numOfFences(0)
 	{
 		GLenum usage = 0;
 		switch (mode)
 		{
 		case BufferUsageMode::Dynamic: usage = GL_DYNAMIC_DRAW; break;
+		case BufferUsageMode::Ring:
 		case BufferUsageMode::Stream: usage = GL_STREAM_DRAW; break;
 		case BufferUsageMode::Static:
 		default:
@@ -21,6 +47,25 @@ namespace graphics
 
 		glGenBuffers(1, &m_id);
 		bind();
+
+		if (mode == BufferUsageMode::Ring && GLAD_GL_VERSION_4_4)
+		{
+			// immutable storage, mapped once for the lifetime of the buffer
+			const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+			glBufferStorage(GL_ARRAY_BUFFER, size, nullptr, flags | GL_DYNAMIC_STORAGE_BIT);
+			m_mapping = glMapBufferRange(GL_ARRAY_BUFFER, 0, size, flags);
+			if (m_mapping != nullptr)
+			{
+				return;
+			}
+
+			// storage is immutable, start again with the orphaning fallback
+			GLStateCache::get().onBufferDeleted(m_id);
+			glDeleteBuffers(1, &m_id);
+			glGenBuffers(1, &m_id);
+			bind();
+		}
+
 		glBufferData(
 			GL_ARRAY_BUFFER,
 			size,
@@ -36,17 +81,32 @@ namespace graphics
 
 	void VertexBuffer::bind()
 	{
-		glBindBuffer(GL_ARRAY_BUFFER, m_id);
+		GLStateCache::get().bindBuffer(GL_ARRAY_BUFFER, m_id);
 	}
 
 	void VertexBuffer::unbind()
 	{
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		GLStateCache::get().bindBuffer(GL_ARRAY_BUFFER, 0);
 	}
 
 	void VertexBuffer::free()
 	{
+		while (m_numOfFences > 0)
+		{
+			glDeleteSync(static_cast<GLsync>(m_fences[m_firstFence].sync));
+			m_firstFence = (m_firstFence + 1) % m_fences.size();
+			--m_numOfFences;
+		}
+
+		if (m_mapping != nullptr)
+		{
+			bind();
+			glUnmapBuffer(GL_ARRAY_BUFFER);
+			m_mapping = nullptr;
+		}
+		GLStateCache::get().onBufferDeleted(m_id);
 		glDeleteBuffers(1, &m_id);
+		m_id = 0;
 	}
 
 	void VertexBuffer::fillData(void* const data, const size_t size)
@@ -59,7 +119,138 @@ namespace graphics
 		glBufferSubData(GL_ARRAY_BUFFER, offset, size, data);
 	}
 
-	void VertexBuffer::activateLayout()
+	bool VertexBuffer::reserve(const size_t size, Range& range)
+	{
+		if (m_mapping == nullptr) return false;
+
+		// a range is never left open across reservations
+		if (m_reserved.data != nullptr)
+		{
+			commit(m_reserved.size);
+		}
+
+		size_t offset = 0;
+		size_t padding = 0;
+		while (true)
+		{
+			if (m_used == 0)
+			{
+				m_head = 0;
+			}
+
+			// ranges must be contiguous, skip the end of the ring if too short
+			offset = align(m_head);
+			if (offset + size > this->size())
+			{
+				offset = 0;
+			}
+			padding = (offset >= m_head ? offset : this->size()) - m_head;
+
+			if (this->size() - m_used >= padding + size) break;
+
+			// wait for the frames in flight still reading the memory
+			if (m_numOfFences == 0) return false;
+			waitFence();
+		}
+
+		m_reserved.data = static_cast<unsigned char*>(m_mapping) + offset;
+		m_reserved.offset = offset;
+		m_reserved.size = size;
+		m_reserved.mapped = true;
+		m_reservedPadding = padding;
+		range = m_reserved;
+		return true;
+	}
+
+	void VertexBuffer::commit(const size_t size)
+	{
+		if (m_reserved.data == nullptr) return;
+
+		const size_t used = m_reservedPadding + std::min(size, m_reserved.size);
+		m_head = m_reserved.offset + std::min(size, m_reserved.size);
+		m_used += used;
+		m_pending += used;
+		m_reserved = Range();
+		m_reservedPadding = 0;
+	}
+
+	bool VertexBuffer::stream(const void* const data, const size_t size, size_t& offset)
+	{
+		if (size > this->size()) return false;
+
+		// the storage is immutable and already mapped, the data goes through the ring.
+		// Fails if the ring is full of data not fenced yet, it must not be overwritten
+		if (m_mapping != nullptr)
+		{
+			Range range;
+			if (!reserve(size, range)) return false;
+
+			std::memcpy(range.data, data, size);
+			commit(size);
+			offset = range.offset;
+			return true;
+		}
+
+		offset = align(m_head);
+		if (offset + size > this->size())
+		{
+			// orphan the storage, the driver keeps the old one alive for the draws in flight
+			glBufferData(GL_ARRAY_BUFFER, this->size(), nullptr, GL_STREAM_DRAW);
+			offset = 0;
+		}
+
+		void* const mapping = glMapBufferRange(GL_ARRAY_BUFFER, offset, size,
+			GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+		if (mapping == nullptr)
+		{
+			glBufferSubData(GL_ARRAY_BUFFER, offset, size, data);
+		}
+		else
+		{
+			std::memcpy(mapping, data, size);
+			glUnmapBuffer(GL_ARRAY_BUFFER);
+		}
+		m_head = offset + size;
+		return true;
+	}
+
+	void VertexBuffer::fence()
+	{
+		if (m_mapping == nullptr || m_pending == 0) return;
+
+		if (m_numOfFences == m_fences.size())
+		{
+			waitFence();
+		}
+
+		Fence& fence = m_fences[(m_firstFence + m_numOfFences) % m_fences.size()];
+		fence.sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		fence.size = m_pending;
+		++m_numOfFences;
+		m_pending = 0;
+	}
+
+	void VertexBuffer::waitFence()
+	{
+		Fence& fence = m_fences[m_firstFence];
+		GLsync sync = static_cast<GLsync>(fence.sync);
+
+		GLbitfield flags = 0;
+		while (true)
+		{
+			const GLenum result = glClientWaitSync(sync, flags, 1000000);
+			if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED || result == GL_WAIT_FAILED) break;
+			// make sure the fence reaches the GPU before waiting again
+			flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+		}
+		glDeleteSync(sync);
+
+		m_used -= fence.size;
+		m_firstFence = (m_firstFence + 1) % m_fences.size();
+		--m_numOfFences;
+	}
+
+	void VertexBuffer::activateLayout(const size_t startOffset)
 	{
 		int elementIndex = layout.startingIndex;
 		size_t offset = 0;
@@ -67,29 +258,43 @@ namespace graphics
 		for (const VertexBufferElement& element : layout.getElements())
 		{
 			int type = 0;
-			size_t size = 0;
+			bool integer = false;
 			switch (element.type)
 			{
+			case VertexBufferElement::Type::Char: type = GL_BYTE; integer = true; break;
+			case VertexBufferElement::Type::HalfFloat: type = GL_HALF_FLOAT; break;
+			case VertexBufferElement::Type::Integer: type = GL_INT; integer = true; break;
+			case VertexBufferElement::Type::UnsignedByte: type = GL_UNSIGNED_BYTE; integer = true; break;
+			case VertexBufferElement::Type::UnsignedInteger: type = GL_UNSIGNED_INT; integer = true; break;
+			case VertexBufferElement::Type::UnsignedShort: type = GL_UNSIGNED_SHORT; integer = true; break;
 			default:
-			case VertexBufferElement::Type::Float:
+			case VertexBufferElement::Type::Float: type = GL_FLOAT; break;
+			}
+
+			if (integer && !element.normalized)
 			{
-				type = GL_FLOAT;
-				size = sizeof(float);
-				break;
+				glVertexAttribIPointer(
+					static_cast<GLuint>(elementIndex),
+					static_cast<GLint>(element.size),
+					type,
+					static_cast<GLsizei>(layout.getStride()),
+					(void*)(startOffset + offset)
+				);
 			}
+			else
+			{
+				glVertexAttribPointer(
+					static_cast<GLuint>(elementIndex),
+					// num of components
+					static_cast<GLint>(element.size),
+					type,
+					element.normalized,
+					// move forward stride bytes each iteration to get the next element
+					static_cast<GLsizei>(layout.getStride()),
+					// start at the beginning of the data
+					(void*)(startOffset + offset)
+				);
 			}
-
-			glVertexAttribPointer(
-				static_cast<GLuint>(elementIndex),
-				// num of components
-				static_cast<GLint>(element.size),
-				type,
-				element.normalized,
-				// move forward size * sizeof(type) each iteration to get the next position
-				static_cast<GLsizei>(layout.getStride() * size),
-				// start at the beginning of the buffer
-				(void*)(offset * size)
-			);
 			glEnableVertexAttribArray(elementIndex);
 
 			if (element.instanced)
@@ -97,19 +302,36 @@ namespace graphics
 				glVertexAttribDivisor(elementIndex, 1);
 			}
 
-			offset += element.size;
+			offset += element.size * element.getTypeSize();
 			++elementIndex;
 		}
 	}
 
+	size_t VertexBufferElement::getTypeSize() const
+	{
+		switch (type)
+		{
+		case Type::Char:
+		case Type::UnsignedByte: return 1;
+		case Type::HalfFloat:
+		case Type::UnsignedShort: return 2;
+		case Type::Integer:
+		case Type::UnsignedInteger:
+		case Type::Float:
+		default:
+			return 4;
+		}
+	}
+
 	void VertexBufferLayout::push(const VertexBufferElement& element)
 	{
 		m_elements.push_back(element);
-		m_stride += element.size;
+		m_stride += element.size * element.getTypeSize();
 	}
 
 	void VertexBufferLayout::clear()
 	{
 		m_elements.clear();
+		m_stride = 0;
 	}
 }
\ No newline at end of file
@@ -0,0 +1,173 @@
+#include <vdtgraphics/visibility_culler.h>
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VDTGRAPHICS_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace graphics
+{
+	void VisibilityCuller::setViewProjectionMatrix(const math::mat4& matrix)
+	{
+		// the matrix is stored by columns, w must not depend on the position
+		const float* const data = matrix.data;
+		m_affine = data[3] == 0.f && data[7] == 0.f && data[11] == 0.f && data[15] > 0.f;
+		if (!m_affine) return;
+
+		const float w = data[15];
+		for (size_t i = 0; i < 4; ++i)
+		{
+			m_x[i] = data[i * 4] / w;
+			m_y[i] = data[i * 4 + 1] / w;
+		}
+	}
+
+	bool VisibilityCuller::isVisible(const Bounds& bounds) const
+	{
+		if (!m_affine) return true;
+
+		const math::vec3& c = bounds.center;
+		const math::vec3& e = bounds.extent;
+		const float x = m_x[0] * c.x + m_x[1] * c.y + m_x[2] * c.z + m_x[3];
+		const float y = m_y[0] * c.x + m_y[1] * c.y + m_y[2] * c.z + m_y[3];
+		const float extentX = std::abs(m_x[0]) * e.x + std::abs(m_x[1]) * e.y + std::abs(m_x[2]) * e.z;
+		const float extentY = std::abs(m_y[0]) * e.x + std::abs(m_y[1]) * e.y + std::abs(m_y[2]) * e.z;
+		return std::abs(x) - extentX <= 1.f && std::abs(y) - extentY <= 1.f;
+	}
+
+	size_t VisibilityCuller::test(const Bounds* const bounds, const size_t count, uint8_t* const visibility) const
+	{
+		if (!m_affine)
+		{
+			std::fill(visibility, visibility + count, static_cast<uint8_t>(1));
+			return count;
+		}
+
+		size_t visible = 0;
+		size_t i = 0;
+#ifdef VDTGRAPHICS_SSE2
+		const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+		const __m128 one = _mm_set1_ps(1.f);
+		const __m128 x0 = _mm_set1_ps(m_x[0]), x1 = _mm_set1_ps(m_x[1]), x2 = _mm_set1_ps(m_x[2]), x3 = _mm_set1_ps(m_x[3]);
+		const __m128 y0 = _mm_set1_ps(m_y[0]), y1 = _mm_set1_ps(m_y[1]), y2 = _mm_set1_ps(m_y[2]), y3 = _mm_set1_ps(m_y[3]);
+		const __m128 ax0 = _mm_and_ps(x0, absMask), ax1 = _mm_and_ps(x1, absMask), ax2 = _mm_and_ps(x2, absMask);
+		const __m128 ay0 = _mm_and_ps(y0, absMask), ay1 = _mm_and_ps(y1, absMask), ay2 = _mm_and_ps(y2, absMask);
+
+		for (; i + 4 <= count; i += 4)
+		{
+			const Bounds* const b = bounds + i;
+			const __m128 cx = _mm_setr_ps(b[0].center.x, b[1].center.x, b[2].center.x, b[3].center.x);
+			const __m128 cy = _mm_setr_ps(b[0].center.y, b[1].center.y, b[2].center.y, b[3].center.y);
+			const __m128 cz = _mm_setr_ps(b[0].center.z, b[1].center.z, b[2].center.z, b[3].center.z);
+			const __m128 ex = _mm_setr_ps(b[0].extent.x, b[1].extent.x, b[2].extent.x, b[3].extent.x);
+			const __m128 ey = _mm_setr_ps(b[0].extent.y, b[1].extent.y, b[2].extent.y, b[3].extent.y);
+			const __m128 ez = _mm_setr_ps(b[0].extent.z, b[1].extent.z, b[2].extent.z, b[3].extent.z);
+
+			const __m128 x = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x0, cx), _mm_mul_ps(x1, cy)), _mm_add_ps(_mm_mul_ps(x2, cz), x3));
+			const __m128 y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(y0, cx), _mm_mul_ps(y1, cy)), _mm_add_ps(_mm_mul_ps(y2, cz), y3));
+			const __m128 extentX = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax0, ex), _mm_mul_ps(ax1, ey)), _mm_mul_ps(ax2, ez));
+			const __m128 extentY = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ay0, ex), _mm_mul_ps(ay1, ey)), _mm_mul_ps(ay2, ez));
+
+			const __m128 insideX = _mm_cmple_ps(_mm_sub_ps(_mm_and_ps(x, absMask), extentX), one);
+			const __m128 insideY = _mm_cmple_ps(_mm_sub_ps(_mm_and_ps(y, absMask), extentY), one);
+			const int mask = _mm_movemask_ps(_mm_and_ps(insideX, insideY));
+			for (size_t j = 0; j < 4; ++j)
+			{
+				visibility[i + j] = static_cast<uint8_t>((mask >> j) & 1);
+				visible += visibility[i + j];
+			}
+		}
+#endif
+		for (; i < count; ++i)
+		{
+			visibility[i] = isVisible(bounds[i]) ? 1 : 0;
+			visible += visibility[i];
+		}
+		return visible;
+	}
+
+	bool VisibilityCuller::getVisibleArea(math::vec2& min, math::vec2& max) const
+	{
+		if (!m_affine) return false;
+
+		const float determinant = m_x[0] * m_y[1] - m_x[1] * m_y[0];
+		if (determinant == 0.f) return false;
+
+		// map the corners of the clip square back to the world
+		bool first = true;
+		for (const float clipX : { -1.f, 1.f })
+		{
+			for (const float clipY : { -1.f, 1.f })
+			{
+				const float x = clipX - m_x[3];
+				const float y = clipY - m_y[3];
+				const float worldX = (m_y[1] * x - m_x[1] * y) / determinant;
+				const float worldY = (m_x[0] * y - m_y[0] * x) / determinant;
+				if (first)
+				{
+					min = max = math::vec2(worldX, worldY);
+					first = false;
+					continue;
+				}
+				min.x = std::min(min.x, worldX);
+				min.y = std::min(min.y, worldY);
+				max.x = std::max(max.x, worldX);
+				max.y = std::max(max.y, worldY);
+			}
+		}
+		return true;
+	}
+
+	VisibilityCuller::Bounds VisibilityCuller::getBounds(const Vertex* const vertices, const size_t numOfVertices)
+	{
+		if (vertices == nullptr || numOfVertices == 0) return {};
+
+		math::vec3 min = vertices[0].position;
+		math::vec3 max = vertices[0].position;
+		for (size_t i = 1; i < numOfVertices; ++i)
+		{
+			const math::vec3& position = vertices[i].position;
+			min.x = std::min(min.x, position.x);
+			min.y = std::min(min.y, position.y);
+			min.z = std::min(min.z, position.z);
+			max.x = std::max(max.x, position.x);
+			max.y = std::max(max.y, position.y);
+			max.z = std::max(max.z, position.z);
+		}
+		return {
+			math::vec3((min.x + max.x) * 0.5f, (min.y + max.y) * 0.5f, (min.z + max.z) * 0.5f),
+			math::vec3((max.x - min.x) * 0.5f, (max.y - min.y) * 0.5f, (max.z - min.z) * 0.5f)
+		};
+	}
+
+	VisibilityCuller::Bounds VisibilityCuller::getBounds(const ShapeInstance& shape)
+	{
+		const float width = std::abs(shape.extent.x) * 0.5f;
+		const float height = std::abs(shape.extent.y) * 0.5f;
+		if (shape.rotation == 0.f)
+		{
+			return { shape.position, math::vec3(width, height, 0.f) };
+		}
+
+		const float c = std::abs(std::cos(shape.rotation));
+		const float s = std::abs(std::sin(shape.rotation));
+		return { shape.position, math::vec3(c * width + s * height, s * width + c * height, 0.f) };
+	}
+
+	VisibilityCuller::Bounds VisibilityCuller::getBounds(const SpriteVertex& vertex)
+	{
+		// the matrix is stored by columns, the quad goes from -0.5 to 0.5
+		const float* const m = vertex.transform.data;
+		return {
+			math::vec3(m[12], m[13], m[14]),
+			math::vec3(
+				(std::abs(m[0]) + std::abs(m[4])) * 0.5f,
+				(std::abs(m[1]) + std::abs(m[5])) * 0.5f,
+				(std::abs(m[2]) + std::abs(m[6])) * 0.5f
+			)
+		};
+	}
+}
@@ -0,0 +1,174 @@
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+#include <vdtgraphics/compressed_image.h>
+#include <vdtgraphics/image.h>
+#include <vdtgraphics/texture_codec.h>
+#include <vdtgraphics/texture_file.h>
+
+using namespace std;
+using namespace graphics;
+
+namespace
+{
+	struct FormatName
+	{
+		const char* name;
+		CompressedImage::Format format;
+	};
+
+	constexpr FormatName format_names[] = {
+		{ "bc1", CompressedImage::Format::BC1 },
+		{ "bc3", CompressedImage::Format::BC3 },
+		{ "bc7", CompressedImage::Format::BC7 },
+		{ "etc2", CompressedImage::Format::ETC2_RGB },
+		{ "etc2a", CompressedImage::Format::ETC2_RGBA }
+	};
+
+	void printUsage()
+	{
+		std::cout << "usage: texture_encoder <input image> <output.ktx|output.vdttex> [bc1|bc3|bc7|etc2|etc2a] [--premultiply] [--no-mipmaps] [--flip]" << std::endl;
+		std::cout << "    ktx files are compressed, bc7 by default. vdttex files keep the decoded pixels, premultiplied if asked" << std::endl;
+		std::cout << "    the mip chain is generated unless told otherwise" << std::endl;
+	}
+
+	// of the first level against the source, over the channels of the format
+	double computePSNR(const Image& image, const CompressedImage& compressed)
+	{
+		const std::shared_ptr<unsigned char> pixels = TextureCodec::decode(compressed, 0);
+		const int numOfChannels = CompressedImage::hasAlpha(compressed.format) ? 4 : 3;
+		const size_t numOfPixels = static_cast<size_t>(image.width) * image.height;
+
+		double error = 0.0;
+		for (size_t i = 0; i < numOfPixels; ++i)
+		{
+			for (int c = 0; c < numOfChannels; ++c)
+			{
+				const double difference = static_cast<double>(pixels.get()[i * 4 + c]) - image.data.get()[i * 4 + c];
+				error += difference * difference;
+			}
+		}
+		error /= static_cast<double>(numOfPixels * numOfChannels);
+		return error > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / error) : INFINITY;
+	}
+
+	bool isFullyOpaque(const unsigned char* const pixels, const size_t numOfPixels)
+	{
+		for (size_t i = 0; i < numOfPixels; ++i)
+		{
+			if (pixels[i * 4 + 3] != 255) return false;
+		}
+		return true;
+	}
+
+	// a fully opaque source decodes fully opaque at every level, or it would be blended
+	bool keepsOpacity(const Image& image, const CompressedImage& compressed)
+	{
+		if (!isFullyOpaque(image.data.get(), static_cast<size_t>(image.width) * image.height)) return true;
+
+		for (size_t i = 0; i < compressed.levels.size(); ++i)
+		{
+			const CompressedImage::Level& level = compressed.levels[i];
+			const std::shared_ptr<unsigned char> pixels = TextureCodec::decode(compressed, i);
+			if (!isFullyOpaque(pixels.get(), static_cast<size_t>(level.width) * level.height)) return false;
+		}
+		return true;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 3)
+	{
+		printUsage();
+		return 1;
+	}
+
+	const std::string input = argv[1];
+	const std::string output = argv[2];
+	CompressedImage::Format format = CompressedImage::Format::BC7;
+	bool mipmaps = true;
+	bool flip = false;
+	bool premultiply = false;
+	for (int i = 3; i < argc; ++i)
+	{
+		bool found = false;
+		for (const FormatName& entry : format_names)
+		{
+			if (std::strcmp(argv[i], entry.name) == 0)
+			{
+				format = entry.format;
+				found = true;
+			}
+		}
+
+		if (std::strcmp(argv[i], "--no-mipmaps") == 0)
+			mipmaps = false;
+		else if (std::strcmp(argv[i], "--flip") == 0)
+			flip = true;
+		else if (std::strcmp(argv[i], "--premultiply") == 0)
+			premultiply = true;
+		else if (!found)
+		{
+			printUsage();
+			return 1;
+		}
+	}
+
+	const Image image = Image::load(input, flip);
+	if (image.data == nullptr)
+	{
+		std::cout << "unable to read " << input << std::endl;
+		return 1;
+	}
+
+	if (std::filesystem::path(output).extension() == TextureFile::extension)
+	{
+		const auto start = std::chrono::high_resolution_clock::now();
+		if (!TextureFile::save(output, image, premultiply, mipmaps))
+		{
+			std::cout << "unable to write " << output << std::endl;
+			return 1;
+		}
+		const auto time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start).count();
+
+		const TextureFile file = TextureFile::open(output);
+		std::cout << input << " size[" << image.width << "x" << image.height << "] levels[" << file.getNumOfLevels() << "]"
+			<< " bytes[" << file.getSize() << "]" << (file.isPremultiplied() ? " premultiplied" : "")
+			<< (file.isOpaque() ? " opaque" : "") << " time[" << time << "ms]" << std::endl;
+		return 0;
+	}
+
+	const auto start = std::chrono::high_resolution_clock::now();
+	const CompressedImage compressed = TextureCodec::encode(image, format, mipmaps);
+	const auto time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start).count();
+
+	if (!keepsOpacity(image, compressed))
+	{
+		std::cout << "the opaque pixels of " << input << " lost their opacity" << std::endl;
+		return 1;
+	}
+
+	if (!compressed.save(output))
+	{
+		std::cout << "unable to write " << output << std::endl;
+		return 1;
+	}
+
+	const CompressedImage::Level& last = compressed.levels.back();
+	const size_t size = last.offset + last.size;
+	size_t uncompressedSize = 0;
+	for (const CompressedImage::Level& level : compressed.levels)
+	{
+		uncompressedSize += static_cast<size_t>(level.width) * level.height * 4;
+	}
+
+	std::cout << input << " size[" << image.width << "x" << image.height << "] levels[" << compressed.levels.size() << "]"
+		<< " bytes[" << size << "] ratio[" << static_cast<double>(uncompressedSize) / size << "x]"
+		<< " psnr[" << computePSNR(image, compressed) << "dB] time[" << time << "ms]" << std::endl;
+	return 0;
+}